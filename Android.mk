@@ -22,6 +22,12 @@ LOCAL_SRC_FILES := \
 service.cpp \
 device.cpp \
 prepare_model.cpp \
+compilation_cache.cpp \
+execution_worker_pool.cpp \
+memory_planner.cpp \
+host_copy.cpp \
+conv_cost_model.cpp \
+pool_mapping_cache.cpp \
 executor_manager.cpp \
 base_executor.cpp \
 gpu_executor.cpp \
@@ -31,6 +37,7 @@ vulkan/vk_pool_info.cpp \
 vulkan/vk_memory_info.cpp \
 vulkan/vk_operand.cpp \
 vulkan/vk_buffer.cpp \
+vulkan/vk_block_allocator.cpp \
 vulkan/vk_cs_executor_elewise.cpp \
 vulkan/vk_cs_executor_conv.cpp \
 vulkan/vk_cs_executor_depth_conv.cpp \
@@ -41,6 +48,9 @@ vulkan/vk_cs_executor_pool.cpp \
 vulkan/vk_cs_executor_lrn.cpp \
 vulkan/vk_cs_executor_reshape.cpp \
 vulkan/vk_op_base.cpp \
+vulkan/vk_command_recorder.cpp \
+vulkan/vk_pipeline_cache.cpp \
+vulkan/vk_tuning_db.cpp \
 vulkan/vk_wrapper.cpp \
 vulkan/shader/elewise_spv.cpp \
 vulkan/shader/conv_spv.cpp \
@@ -51,7 +61,16 @@ vulkan/shader/softmax_spv.cpp \
 vulkan/shader/avg_pool_spv.cpp \
 vulkan/shader/conv_chn3to4_spv.cpp \
 vulkan/shader/conv_gemmShader4_8_spv.cpp \
+vulkan/shader/conv_gemmShader4_8_packed_spv.cpp \
 vulkan/shader/conv_gemm1_spv.cpp \
+vulkan/shader/conv_gemmShader4_4_spv.cpp \
+vulkan/shader/conv_gemmShader4_4_no_img2col_spv.cpp \
+vulkan/shader/conv_gemmShader4_4_chn3_spv.cpp \
+vulkan/shader/conv_winograd_input_spv.cpp \
+vulkan/shader/conv_winograd_gemm_spv.cpp \
+vulkan/shader/conv_winograd_output_spv.cpp \
+vulkan/shader/conv_gemm_split_k_spv.cpp \
+vulkan/shader/conv_gemm_implicit_spv.cpp \
 vulkan/shader/max_pool_spv.cpp \
 vulkan/shader/lrn_spv.cpp \
 gles/gles_cs_executor.cpp \
@@ -81,7 +100,8 @@ gles/gles_cs_program_softmax.cpp \
 gles/gles_memory_info.cpp \
 gles/gles_memory_manager.cpp \
 gles/gles_operand.cpp \
-gles/gles_pool_info.cpp
+gles/gles_pool_info.cpp \
+gles/gles_tuning_store.cpp
 
 LOCAL_CFLAGS += \
 -DLOG_TAG=\"NN_GPU_HAL\" \
@@ -113,6 +133,7 @@ LOCAL_SHARED_LIBRARIES := \
 libbase \
 libdl \
 libcutils \
+libfmq \
 libhardware \
 libhidlbase \
 libhidlmemory \
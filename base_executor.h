@@ -57,7 +57,31 @@ public:
     virtual bool initPerExecThread() { NOT_REACH_HERE; return true; }
     virtual void deinitPerExecThread() { NOT_REACH_HERE; }
 
-    virtual bool run(const Request& request) { UNUSED(request); NOT_REACH_HERE; return true; }
+    // with MeasureTiming::YES timeOnDevice is the GPU time of the request in
+    // microseconds, it stays UINT64_MAX when the executor cannot measure it
+    virtual bool run(const Request& request, MeasureTiming measure, uint64_t& timeOnDevice)
+    {
+        UNUSED(request); UNUSED(measure); UNUSED(timeOnDevice); NOT_REACH_HERE; return true;
+    }
+
+    // called by the worker of the executor while no request is queued, does one
+    // small piece of background work and returns true if more is left
+    virtual bool runIdle() { return false; }
+
+    // the client freed a request pool (a burst slot), drops what is cached for
+    // it, called on the thread of the burst, not the one of the executor
+    virtual void invalidatePool(const hidl_memory& pool) { UNUSED(pool); }
+
+    // compilation caching: the plan (tuned shader configs etc.) and the preprocessed
+    // constants of the model, loadCache is called before initPerModel
+    virtual bool saveCache(std::vector<uint8_t>& plan, std::vector<uint8_t>& data)
+    {
+        UNUSED(plan); UNUSED(data); return false;
+    }
+    virtual bool loadCache(const std::vector<uint8_t>& plan, const std::vector<uint8_t>& data)
+    {
+        UNUSED(plan); UNUSED(data); return false;
+    }
     virtual std::string getOpName(const Operation& op);
 protected:
     const Model& model;
@@ -0,0 +1,473 @@
+#include <errno.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <cutils/native_handle.h>
+
+#include "compilation_cache.h"
+#include "base_executor.h"
+
+NAME_SPACE_BEGIN
+
+#define MODEL_CACHE_MAGIC 0x43474e4e    // "NNGC"
+#define MODEL_CACHE_VERSION 2
+
+struct ModelCacheHeader
+{
+    uint32_t magic;
+    uint32_t version;
+    uint8_t  token[32];
+    uint64_t modelSize;        // serialized model and pool table
+    uint64_t planSize;         // executor plan, follows the model
+    uint64_t dataSize;         // size of the data cache file
+    uint64_t modelChecksum;    // of model and plan
+};
+
+// a pool or the executor data in the data cache, listed in the model cache
+struct DataRegion
+{
+    uint64_t offset;
+    uint64_t size;
+    uint64_t hash;             // see digest
+};
+
+// bytes at each end of a region of the data cache its digest covers. hashing
+// all of it would read every weight of the model on each load, what the cache
+// is there to avoid, so a region rewritten in the middle is not detected
+static const size_t kDigestSpan = 4096;
+
+// FNV-1a, enough to detect truncated or corrupted cache files
+static uint64_t checksum(const uint8_t* data, size_t size, uint64_t hash = 0xcbf29ce484222325ULL)
+{
+    for (size_t i = 0; i < size; ++i)
+    {
+        hash ^= data[i];
+        hash *= 0x100000001b3ULL;
+    }
+    return hash;
+}
+
+// of a DataRegion
+static uint64_t digest(const uint8_t* data, uint64_t size)
+{
+    if (size <= 2 * kDigestSpan)
+    {
+        return checksum(data, size);
+    }
+    return checksum(data + size - kDigestSpan, kDigestSpan, checksum(data, kDigestSpan));
+}
+
+static size_t pageAlign(size_t size)
+{
+    static const size_t pageSize = sysconf(_SC_PAGESIZE);
+    return ALIGN(size, pageSize);
+}
+
+static int getFd(const hidl_handle& handle)
+{
+    const native_handle_t* nativeHandle = handle.getNativeHandle();
+    if (nativeHandle == nullptr || nativeHandle->numFds != 1)
+    {
+        return -1;
+    }
+    return nativeHandle->data[0];
+}
+
+static bool writeFile(int fd, const std::vector<uint8_t>& data)
+{
+    if (ftruncate(fd, 0) != 0 || lseek(fd, 0, SEEK_SET) != 0)
+    {
+        return false;
+    }
+
+    size_t done = 0;
+    while (done < data.size())
+    {
+        ssize_t n = write(fd, data.data() + done, data.size() - done);
+        if (n < 0 && errno == EINTR)
+        {
+            continue;
+        }
+        if (n <= 0)
+        {
+            return false;
+        }
+        done += n;
+    }
+    return true;
+}
+
+static bool readFile(int fd, std::vector<uint8_t>& data)
+{
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size <= 0)
+    {
+        return false;
+    }
+
+    data.resize(st.st_size);
+    size_t done = 0;
+    while (done < data.size())
+    {
+        ssize_t n = pread(fd, data.data() + done, data.size() - done, done);
+        if (n < 0 && errno == EINTR)
+        {
+            continue;
+        }
+        if (n <= 0)
+        {
+            return false;
+        }
+        done += n;
+    }
+    return true;
+}
+
+static bool copyPool(const hidl_memory& pool, uint8_t* to)
+{
+    if (pool.name() == "ashmem")
+    {
+        sp<IMemory> memory = mapMemory(pool);
+        if (memory == nullptr)
+        {
+            return false;
+        }
+        memory->read();
+        memcpy(to, static_cast<void*>(memory->getPointer()), pool.size());
+        memory->commit();
+        return true;
+    }
+    else if (pool.name() == "mmap_fd")
+    {
+        const native_handle_t* handle = pool.handle();
+        size_t offset = getSizeFromInts(handle->data[2], handle->data[3]);
+        void* userptr = mmap(nullptr, pool.size(), PROT_READ, MAP_SHARED, handle->data[0], offset);
+        if (userptr == MAP_FAILED)
+        {
+            return false;
+        }
+        memcpy(to, userptr, pool.size());
+        munmap(userptr, pool.size());
+        return true;
+    }
+
+    LOGW("pool %s cannot be cached", pool.name().c_str());
+    return false;
+}
+
+// the pool is a window of the data cache file, mapped as "mmap_fd" by the executors
+static bool createPool(int fd, uint64_t offset, uint64_t size, hidl_memory& pool)
+{
+    native_handle_t* handle = native_handle_create(1, 3);
+    if (handle == nullptr)
+    {
+        return false;
+    }
+
+    handle->data[0] = dup(fd);
+    handle->data[1] = PROT_READ;
+    handle->data[2] = (int)(uint32_t)(offset & 0xffffffff);
+    handle->data[3] = (int)(uint32_t)(offset >> 32);
+    if (handle->data[0] < 0)
+    {
+        native_handle_delete(handle);
+        return false;
+    }
+
+    // copying hidl_memory clones the handle, so the original one is closed here
+    hidl_memory memory("mmap_fd", handle, size);
+    pool = memory;
+    native_handle_close(handle);
+    native_handle_delete(handle);
+    return true;
+}
+
+static bool writeModel(CacheWriter& writer, const Model& model)
+{
+    if (model.extensionNameToPrefix.size() > 0)
+    {
+        LOGW("model with extensions cannot be cached");
+        return false;
+    }
+
+    writer.write<uint32_t>(model.operands.size());
+    for (const auto& operand : model.operands)
+    {
+        if (operand.extraParams.getDiscriminator() != Operand::ExtraParams::hidl_discriminator::none)
+        {
+            LOGW("operand with extra params cannot be cached");
+            return false;
+        }
+        writer.write<int32_t>(static_cast<int32_t>(operand.type));
+        writer.writeArray(operand.dimensions);
+        writer.write(operand.numberOfConsumers);
+        writer.write(operand.scale);
+        writer.write(operand.zeroPoint);
+        writer.write<int32_t>(static_cast<int32_t>(operand.lifetime));
+        writer.write(operand.location.poolIndex);
+        writer.write(operand.location.offset);
+        writer.write(operand.location.length);
+    }
+
+    writer.write<uint32_t>(model.operations.size());
+    for (const auto& operation : model.operations)
+    {
+        writer.write<int32_t>(static_cast<int32_t>(operation.type));
+        writer.writeArray(operation.inputs);
+        writer.writeArray(operation.outputs);
+    }
+
+    writer.writeArray(model.inputIndexes);
+    writer.writeArray(model.outputIndexes);
+    writer.writeArray(model.operandValues);
+    writer.write<uint8_t>(model.relaxComputationFloat32toFloat16 ? 1 : 0);
+    return true;
+}
+
+static bool readModel(CacheReader& reader, Model& model)
+{
+    uint32_t count = 0;
+    if (!reader.read(count))
+    {
+        return false;
+    }
+    model.operands.resize(count);
+    for (auto& operand : model.operands)
+    {
+        int32_t type, lifetime;
+        if (!reader.read(type) ||
+            !reader.readArray(operand.dimensions) ||
+            !reader.read(operand.numberOfConsumers) ||
+            !reader.read(operand.scale) ||
+            !reader.read(operand.zeroPoint) ||
+            !reader.read(lifetime) ||
+            !reader.read(operand.location.poolIndex) ||
+            !reader.read(operand.location.offset) ||
+            !reader.read(operand.location.length))
+        {
+            return false;
+        }
+        operand.type = static_cast<OperandType>(type);
+        operand.lifetime = static_cast<OperandLifeTime>(lifetime);
+    }
+
+    if (!reader.read(count))
+    {
+        return false;
+    }
+    model.operations.resize(count);
+    for (auto& operation : model.operations)
+    {
+        int32_t type;
+        if (!reader.read(type) ||
+            !reader.readArray(operation.inputs) ||
+            !reader.readArray(operation.outputs))
+        {
+            return false;
+        }
+        operation.type = static_cast<OperationType>(type);
+    }
+
+    uint8_t relax = 0;
+    if (!reader.readArray(model.inputIndexes) ||
+        !reader.readArray(model.outputIndexes) ||
+        !reader.readArray(model.operandValues) ||
+        !reader.read(relax))
+    {
+        return false;
+    }
+    model.relaxComputationFloat32toFloat16 = (relax != 0);
+    return true;
+}
+
+bool CompilationCache::isValidHandles(const hidl_vec<hidl_handle>& modelCache,
+                                      const hidl_vec<hidl_handle>& dataCache)
+{
+    return modelCache.size() == kNumModelCache && dataCache.size() == kNumDataCache &&
+           getFd(modelCache[0]) >= 0 && getFd(dataCache[0]) >= 0;
+}
+
+bool CompilationCache::save(const Model& model, BaseExecutor* exec,
+                            const hidl_vec<hidl_handle>& modelCache,
+                            const hidl_vec<hidl_handle>& dataCache,
+                            const HidlToken& token)
+{
+    NN_GPU_CALL();
+
+    if (!isValidHandles(modelCache, dataCache))
+    {
+        return false;
+    }
+
+    std::vector<uint8_t> plan;
+    std::vector<uint8_t> execData;
+    if (!exec->saveCache(plan, execData))
+    {
+        NN_GPU_DEBUG("executor does not provide a compilation cache");
+        return false;
+    }
+
+    std::vector<uint8_t> modelBlob(sizeof(ModelCacheHeader));
+    std::vector<uint8_t> data;
+    CacheWriter writer(modelBlob);
+    if (!writeModel(writer, model))
+    {
+        return false;
+    }
+
+    writer.write<uint32_t>(model.pools.size());
+    for (const auto& pool : model.pools)
+    {
+        uint64_t offset = data.size();
+        uint64_t size = pool.size();
+        data.resize(pageAlign(offset + size));
+        if (size > 0 && !copyPool(pool, data.data() + offset))
+        {
+            return false;
+        }
+        writer.write(offset);
+        writer.write(size);
+        writer.write(digest(data.data() + offset, size));
+    }
+
+    uint64_t execOffset = data.size();
+    uint64_t execSize = execData.size();
+    data.insert(data.end(), execData.begin(), execData.end());
+    writer.write(execOffset);
+    writer.write(execSize);
+    writer.write(digest(data.data() + execOffset, execSize));
+
+    ModelCacheHeader header;
+    memset(&header, 0, sizeof(header));
+    header.magic = MODEL_CACHE_MAGIC;
+    header.version = MODEL_CACHE_VERSION;
+    memcpy(header.token, token.data(), sizeof(header.token));
+    header.modelSize = modelBlob.size() - sizeof(ModelCacheHeader);
+    header.planSize = plan.size();
+    header.dataSize = data.size();
+    writer.writeBytes(plan.data(), plan.size());
+    header.modelChecksum = checksum(modelBlob.data() + sizeof(ModelCacheHeader),
+                                    modelBlob.size() - sizeof(ModelCacheHeader));
+    memcpy(modelBlob.data(), &header, sizeof(header));
+
+    // the model cache carries the digests of the data cache, write it last
+    if (!writeFile(getFd(dataCache[0]), data) || !writeFile(getFd(modelCache[0]), modelBlob))
+    {
+        LOGE("failed to write compilation cache, errno = %d", errno);
+        return false;
+    }
+
+    NN_GPU_DEBUG("compilation cache saved, model %zu bytes, data %zu bytes", modelBlob.size(), data.size());
+    return true;
+}
+
+bool CompilationCache::load(const hidl_vec<hidl_handle>& modelCache,
+                            const hidl_vec<hidl_handle>& dataCache,
+                            const HidlToken& token,
+                            Model& model, std::vector<uint8_t>& plan, std::vector<uint8_t>& data)
+{
+    NN_GPU_CALL();
+
+    if (!isValidHandles(modelCache, dataCache))
+    {
+        return false;
+    }
+
+    std::vector<uint8_t> modelBlob;
+    if (!readFile(getFd(modelCache[0]), modelBlob) || modelBlob.size() < sizeof(ModelCacheHeader))
+    {
+        LOGW("failed to read model cache");
+        return false;
+    }
+
+    ModelCacheHeader header;
+    memcpy(&header, modelBlob.data(), sizeof(header));
+    const uint8_t* body = modelBlob.data() + sizeof(ModelCacheHeader);
+    const size_t bodySize = modelBlob.size() - sizeof(ModelCacheHeader);
+    if (header.magic != MODEL_CACHE_MAGIC ||
+        header.version != MODEL_CACHE_VERSION ||
+        memcmp(header.token, token.data(), sizeof(header.token)) != 0 ||
+        header.modelSize > bodySize ||
+        header.planSize != bodySize - header.modelSize ||
+        header.modelChecksum != checksum(body, bodySize))
+    {
+        LOGW("model cache is invalid or belongs to another model");
+        return false;
+    }
+
+    int dataFd = getFd(dataCache[0]);
+    struct stat st;
+    if (fstat(dataFd, &st) != 0 || (uint64_t)st.st_size != header.dataSize)
+    {
+        LOGW("data cache does not match the model cache");
+        return false;
+    }
+
+    CacheReader reader(body, header.modelSize);
+    uint32_t poolCount = 0;
+    if (!readModel(reader, model) || !reader.read(poolCount) || poolCount > header.modelSize)
+    {
+        LOGW("model cache is corrupted");
+        return false;
+    }
+
+    // the pools, then the executor data
+    std::vector<DataRegion> regions(poolCount + 1);
+    bool ok = true;
+    for (uint32_t i = 0; i <= poolCount; ++i)
+    {
+        DataRegion& r = regions[i];
+        ok = ok && reader.read(r.offset) && reader.read(r.size) && reader.read(r.hash) &&
+             (i == poolCount || r.offset == pageAlign(r.offset)) &&
+             r.offset <= header.dataSize && r.size <= header.dataSize - r.offset;
+    }
+    ok = ok && reader.empty();
+    if (!ok)
+    {
+        LOGW("model cache is corrupted");
+        return false;
+    }
+
+    if (header.dataSize > 0)
+    {
+        void* userptr = mmap(nullptr, header.dataSize, PROT_READ, MAP_SHARED, dataFd, 0);
+        if (userptr == MAP_FAILED)
+        {
+            LOGE("failed to map data cache");
+            return false;
+        }
+        const uint8_t* p = static_cast<const uint8_t*>(userptr);
+        for (const DataRegion& r : regions)
+        {
+            ok = ok && digest(p + r.offset, r.size) == r.hash;
+        }
+        if (ok)
+        {
+            const DataRegion& exec = regions[poolCount];
+            data.assign(p + exec.offset, p + exec.offset + exec.size);
+        }
+        munmap(userptr, header.dataSize);
+        if (!ok)
+        {
+            LOGW("data cache is corrupted");
+            return false;
+        }
+    }
+
+    model.pools.resize(poolCount);
+    for (uint32_t i = 0; i < poolCount; ++i)
+    {
+        if (!createPool(dataFd, regions[i].offset, regions[i].size, model.pools[i]))
+        {
+            LOGE("failed to create pool from data cache");
+            return false;
+        }
+    }
+
+    plan.assign(body + header.modelSize, body + bodySize);
+
+    NN_GPU_DEBUG("compilation cache loaded, %zu operations, %u pools", model.operations.size(), poolCount);
+    return true;
+}
+
+NAME_SPACE_STOP
@@ -0,0 +1,118 @@
+#ifndef ANDROID_HARDWARE_NEURALNETWORKS_V1_2_COMPILATION_CACHE_H
+#define ANDROID_HARDWARE_NEURALNETWORKS_V1_2_COMPILATION_CACHE_H
+
+#include <string.h>
+#include <vector>
+#include "hal_types.h"
+
+NAME_SPACE_BEGIN
+
+// ANEURALNETWORKS_BYTE_SIZE_OF_CACHE_TOKEN = 32
+using HidlToken = hidl_array<uint8_t, 32>;
+
+class BaseExecutor;
+
+// appends plain values and arrays of plain values to a byte blob
+class CacheWriter
+{
+public:
+    CacheWriter(std::vector<uint8_t>& b) : blob(b) {}
+
+    void writeBytes(const void* data, size_t size)
+    {
+        const uint8_t* p = static_cast<const uint8_t*>(data);
+        blob.insert(blob.end(), p, p + size);
+    }
+
+    template <typename T>
+    void write(const T& v)
+    {
+        writeBytes(&v, sizeof(T));
+    }
+
+    // the element count followed by the elements, for hidl_vec and std::vector
+    template <typename V>
+    void writeArray(const V& v)
+    {
+        write<uint32_t>(v.size());
+        writeBytes(v.data(), v.size() * sizeof(v[0]));
+    }
+
+private:
+    std::vector<uint8_t>& blob;
+};
+
+// reads back what CacheWriter wrote, every read fails once the blob is exhausted
+class CacheReader
+{
+public:
+    CacheReader(const uint8_t* data, size_t size) : ptr(data), left(size) {}
+    CacheReader(const std::vector<uint8_t>& blob) : ptr(blob.data()), left(blob.size()) {}
+
+    bool readBytes(void* data, size_t size)
+    {
+        if (size > left)
+        {
+            left = 0;
+            return false;
+        }
+        memcpy(data, ptr, size);
+        ptr += size;
+        left -= size;
+        return true;
+    }
+
+    template <typename T>
+    bool read(T& v)
+    {
+        return readBytes(&v, sizeof(T));
+    }
+
+    template <typename V>
+    bool readArray(V& v)
+    {
+        uint32_t count = 0;
+        if (!read(count) || count > left / sizeof(v[0]))
+        {
+            left = 0;
+            return false;
+        }
+        v.resize(count);
+        return readBytes(v.data(), count * sizeof(v[0]));
+    }
+
+    bool empty() const { return left == 0; }
+
+private:
+    const uint8_t* ptr;
+    size_t left;
+};
+
+// NNAPI compilation caching, one model cache file and one data cache file.
+//
+// The model cache holds a header (token, sizes and checksum), the model without
+// its constant pools, the offsets and digests of the regions of the data cache
+// and the executor plan (tuned shader configs, memory plan etc.).
+// The data cache holds the model pools, each page aligned so they can be mapped
+// back as "mmap_fd" memory, and the preprocessed constants of the executor.
+class CompilationCache
+{
+public:
+    static const uint32_t kNumModelCache = 1;
+    static const uint32_t kNumDataCache = 1;
+
+    static bool save(const Model& model, BaseExecutor* exec,
+                     const hidl_vec<hidl_handle>& modelCache,
+                     const hidl_vec<hidl_handle>& dataCache,
+                     const HidlToken& token);
+    static bool load(const hidl_vec<hidl_handle>& modelCache,
+                     const hidl_vec<hidl_handle>& dataCache,
+                     const HidlToken& token,
+                     Model& model, std::vector<uint8_t>& plan, std::vector<uint8_t>& data);
+    static bool isValidHandles(const hidl_vec<hidl_handle>& modelCache,
+                               const hidl_vec<hidl_handle>& dataCache);
+};
+
+NAME_SPACE_STOP
+
+#endif
@@ -0,0 +1,77 @@
+#include <stdlib.h>
+#include <algorithm>
+#include <limits>
+#include <map>
+#include <numeric>
+#include <cutils/properties.h>
+#include "conv_cost_model.h"
+
+NAME_SPACE_BEGIN
+
+// lanes of one hardware thread, a work group is issued in threads of this width
+static const int kSimdWidth = 16;
+// work groups of maxComputeWorkGroupInvocations the device runs at once
+static const int kComputeUnits = 8;
+// FLOPs the ALUs do in the time one byte is loaded
+static const double kFlopsPerByte = 4.0;
+// dispatching and setting up one work group, in FLOPs
+static const double kGroupOverhead = 2048.0;
+// used if the backend did not get the limit from the driver
+static const int kDefaultMaxInvocations = 256;
+
+double ConvCostModel::estimate(const ConvWorkload& workload, int maxInvocations)
+{
+    if (workload.groups <= 0 || workload.invocations <= 0)
+    {
+        return std::numeric_limits<double>::max();
+    }
+    if (maxInvocations <= 0)
+    {
+        maxInvocations = kDefaultMaxInvocations;
+    }
+
+    const double invocations = workload.invocations;
+    const double lanes = invocations / ALIGN(workload.invocations, kSimdWidth);
+    const double fill = std::min(1.0, invocations * workload.groups / ((double)kComputeUnits * maxInvocations));
+    const double resident = (workload.invocations * 2 > maxInvocations) ? 0.5 : 1.0;
+
+    const double busy = std::max(workload.flops, workload.bytes * kFlopsPerByte);
+    return busy / (lanes * fill * resident) + workload.groups * kGroupOverhead;
+}
+
+size_t ConvCostModel::getTopK()
+{
+    char prop[PROPERTY_VALUE_MAX];
+    property_get("nn.gpgpu.tune_top_k", prop, "3");
+    int k = atoi(prop);
+    return k > 0 ? k : 0;
+}
+
+void ConvCostModel::prune(const std::vector<double>& costs, const std::vector<int>& kinds,
+                          std::vector<size_t>& kept, std::vector<size_t>& rest)
+{
+    ASSERT(costs.size() == kinds.size());
+
+    std::vector<size_t> order(costs.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(),
+                     [&costs](size_t a, size_t b) { return costs[a] < costs[b]; });
+
+    const size_t topK = getTopK();
+    std::map<int, size_t> taken;
+    kept.clear();
+    rest.clear();
+    for (size_t index : order)
+    {
+        if (topK == 0 || taken[kinds[index]]++ < topK)
+        {
+            kept.push_back(index);
+        }
+        else
+        {
+            rest.push_back(index);
+        }
+    }
+}
+
+NAME_SPACE_STOP
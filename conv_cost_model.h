@@ -0,0 +1,47 @@
+#ifndef ANDROID_HARDWARE_NEURALNETWORKS_V1_2_CONV_COST_MODEL_H
+#define ANDROID_HARDWARE_NEURALNETWORKS_V1_2_CONV_COST_MODEL_H
+
+#include <vector>
+#include "base_executor.h"
+
+NAME_SPACE_BEGIN
+
+// what one conv shader config dispatches, filled in by the backend from its
+// group count, local size and block shape
+struct ConvWorkload
+{
+    double flops;       // 2 * K per output of every invocation, the ones past the tails included
+    double bytes;       // read and written by all work groups
+    long groups;
+    int invocations;    // of one work group
+};
+
+// Analytic estimate of the run time of a conv shader config, so tuning times
+// only the most promising candidates of a new shape instead of all of them.
+//
+// A config is bound by its FLOPs or by the bytes it moves, whichever takes
+// longer. The FLOPs include the work wasted on the tails (tail_m and the
+// outputs past N in the last work group). Lanes left idle in the last SIMD
+// thread of a work group, a device left unfilled by too few invocations, and
+// work groups too large to keep two resident (from maxComputeWorkGroupInvocations)
+// scale it up. The estimates are only comparable between the candidates of one
+// conv.
+class ConvCostModel
+{
+public:
+    static double estimate(const ConvWorkload& workload, int maxInvocations);
+
+    // nn.gpgpu.tune_top_k, the candidates timed of each shader type (default 3),
+    // 0 times all of them to check the ranking of the model against the times
+    static size_t getTopK();
+
+    // the indexes of the top k candidates of each kind (shader type) cheapest
+    // first, and the indexes of the others, which are only timed when none of
+    // the top k passes verification
+    static void prune(const std::vector<double>& costs, const std::vector<int>& kinds,
+                      std::vector<size_t>& kept, std::vector<size_t>& rest);
+};
+
+NAME_SPACE_STOP
+
+#endif
@@ -139,10 +139,6 @@ Return<ErrorStatus> Device::prepareModel_1_2(const V1_2::Model& model,
                                              const HidlToken& token,
                                              const sp<V1_2::IPreparedModelCallback>& callback)
 {
-    UNUSED(modelCache);
-    UNUSED(dataCache);
-    UNUSED(token);
-
     NN_GPU_ENTRY();
 
     if (callback.get() == nullptr)
@@ -162,6 +158,13 @@ Return<ErrorStatus> Device::prepareModel_1_2(const V1_2::Model& model,
        callback->notify_1_2(ErrorStatus::INVALID_ARGUMENT, nullptr);
        return ErrorStatus::INVALID_ARGUMENT;
     }
+
+    // caching is optional, the prepared model is good even if it cannot be saved
+    if (CompilationCache::isValidHandles(modelCache, dataCache) &&
+        !preparedModel->saveToCache(modelCache, dataCache, token))
+    {
+        LOGW("failed to save compilation cache");
+    }
     callback->notify_1_2(ErrorStatus::NONE, preparedModel);
 
     NN_GPU_EXIT();
@@ -199,18 +202,50 @@ Return<void> Device::getSupportedExtensions(getSupportedExtensions_cb cb)
 Return<void> Device::getNumberOfCacheFilesNeeded(getNumberOfCacheFilesNeeded_cb cb)
 {
     NN_GPU_CALL();
-    cb(ErrorStatus::NONE, /*numModelCache=*/0, /*numDataCache=*/0);
+    cb(ErrorStatus::NONE, CompilationCache::kNumModelCache, CompilationCache::kNumDataCache);
     return Void();
 }
 
-Return<ErrorStatus> Device::prepareModelFromCache(const hidl_vec<hidl_handle>&,
-                                                  const hidl_vec<hidl_handle>&,
-                                                  const HidlToken&,
+Return<ErrorStatus> Device::prepareModelFromCache(const hidl_vec<hidl_handle>& modelCache,
+                                                  const hidl_vec<hidl_handle>& dataCache,
+                                                  const HidlToken& token,
                                                   const sp<V1_2::IPreparedModelCallback>& callback)
 {
-    NN_GPU_CALL();
-    callback->notify_1_2(ErrorStatus::GENERAL_FAILURE, nullptr);
-    return ErrorStatus::GENERAL_FAILURE;
+    NN_GPU_ENTRY();
+
+    if (callback.get() == nullptr)
+    {
+        LOGE("invalid callback passed to prepareModelFromCache");
+        return ErrorStatus::INVALID_ARGUMENT;
+    }
+    if (!CompilationCache::isValidHandles(modelCache, dataCache))
+    {
+        callback->notify_1_2(ErrorStatus::INVALID_ARGUMENT, nullptr);
+        return ErrorStatus::INVALID_ARGUMENT;
+    }
+
+    // the runtime falls back to prepareModel_1_2 on failure, so a stale
+    // or corrupted cache is reported as GENERAL_FAILURE
+    Model model;
+    std::vector<uint8_t> plan;
+    std::vector<uint8_t> data;
+    if (!CompilationCache::load(modelCache, dataCache, token, model, plan, data) ||
+        !validateModel(model))
+    {
+        callback->notify_1_2(ErrorStatus::GENERAL_FAILURE, nullptr);
+        return ErrorStatus::GENERAL_FAILURE;
+    }
+
+    sp<PreparedModel> preparedModel = new PreparedModel(model);
+    if (!preparedModel->initializeFromCache(plan, data))
+    {
+        callback->notify_1_2(ErrorStatus::GENERAL_FAILURE, nullptr);
+        return ErrorStatus::GENERAL_FAILURE;
+    }
+    callback->notify_1_2(ErrorStatus::NONE, preparedModel);
+
+    NN_GPU_EXIT();
+    return ErrorStatus::NONE;
 }
 
 int Device::run()
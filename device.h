@@ -2,12 +2,11 @@
 #define ANDROID_HARDWARE_NEURALNETWORKS_V1_2_DEVICE_H
 
 #include "hal_types.h"
+#include "compilation_cache.h"
 
 NAME_SPACE_BEGIN
 
 using ::android::hardware::MQDescriptorSync;
-// ANEURALNETWORKS_BYTE_SIZE_OF_CACHE_TOKEN = 32
-using HidlToken = hidl_array<uint8_t, 32>;
 
 class Device : public IDevice {
 public:
@@ -36,9 +35,9 @@ public:
     virtual Return<void> getType(getType_cb cb) override;
     virtual Return<void> getSupportedExtensions(getSupportedExtensions_cb cb) override;
     virtual Return<void> getNumberOfCacheFilesNeeded(getNumberOfCacheFilesNeeded_cb cb) override;
-    virtual Return<ErrorStatus> prepareModelFromCache(const hidl_vec<hidl_handle>&,
-                                                      const hidl_vec<hidl_handle>&,
-                                                      const HidlToken&,
+    virtual Return<ErrorStatus> prepareModelFromCache(const hidl_vec<hidl_handle>& modelCache,
+                                                      const hidl_vec<hidl_handle>& dataCache,
+                                                      const HidlToken& token,
                                                       const sp<V1_2::IPreparedModelCallback>& callback) override;
 
     // Starts and runs the driver service.  Typically called from main().
@@ -0,0 +1,104 @@
+#include "execution_worker_pool.h"
+
+NAME_SPACE_BEGIN
+
+ExecutionWorkerPool::ExecutionWorkerPool(const std::vector<sp<BaseExecutor>>& executors)
+      : execs(executors), tasks(kQueueCapacity), sleepers(0), stopping(false)
+{
+    ASSERT(!execs.empty());
+}
+
+ExecutionWorkerPool::~ExecutionWorkerPool()
+{
+    stop();
+}
+
+void ExecutionWorkerPool::start()
+{
+    NN_GPU_CALL();
+    for (auto& exec : execs)
+    {
+        BaseExecutor* e = exec.get();
+        workers.push_back(std::thread([this, e]{ workerLoop(*e); }));
+    }
+}
+
+void ExecutionWorkerPool::submit(Task&& task)
+{
+    std::call_once(started, [this]{ start(); });
+
+    // the queue is only full with kQueueCapacity executions in flight, just wait for a slot
+    while (!tasks.push(std::move(task)))
+    {
+        std::this_thread::yield();
+    }
+
+    // pairs with the fence in workerLoop, either the worker sees the task
+    // when it checks the queue again or we see it sleeping
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (sleepers.load(std::memory_order_relaxed) > 0)
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        cv.notify_one();
+    }
+}
+
+void ExecutionWorkerPool::workerLoop(BaseExecutor& exec)
+{
+    NN_GPU_CALL();
+
+    bool ready = exec.initPerExecThread();
+    Task task;
+    for (;;)
+    {
+        if (!tasks.pop(task))
+        {
+            // a request queued meanwhile waits for one piece of background work at most,
+            // a stopping pool does not wait for the rest of it
+            if (ready && !stopping.load() && exec.runIdle())
+            {
+                continue;
+            }
+
+            std::unique_lock<std::mutex> lock(mtx);
+            sleepers.fetch_add(1, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            while (!tasks.pop(task))
+            {
+                if (stopping.load())
+                {
+                    sleepers.fetch_sub(1, std::memory_order_relaxed);
+                    lock.unlock();
+                    exec.deinitPerExecThread();
+                    return;
+                }
+                cv.wait(lock);
+            }
+            sleepers.fetch_sub(1, std::memory_order_relaxed);
+        }
+
+        if (!ready)
+        {
+            ready = exec.initPerExecThread();
+        }
+        task(exec, ready);
+        task = nullptr;
+    }
+}
+
+void ExecutionWorkerPool::stop()
+{
+    NN_GPU_CALL();
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        stopping.store(true);
+        cv.notify_all();
+    }
+    for (auto& th : workers)
+    {
+        th.join();
+    }
+    workers.clear();
+}
+
+NAME_SPACE_STOP
@@ -0,0 +1,145 @@
+#ifndef ANDROID_HARDWARE_NEURALNETWORKS_V1_2_EXECUTION_WORKER_POOL_H
+#define ANDROID_HARDWARE_NEURALNETWORKS_V1_2_EXECUTION_WORKER_POOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "base_executor.h"
+
+NAME_SPACE_BEGIN
+
+// bounded multi producer multi consumer queue (Dmitry Vyukov's algorithm),
+// push and pop never take a lock, capacity must be a power of two
+template <typename T>
+class LockFreeQueue
+{
+public:
+    LockFreeQueue(size_t capacity) : cells(capacity), mask(capacity - 1), head(0), tail(0)
+    {
+        ASSERT(capacity >= 2 && (capacity & (capacity - 1)) == 0);
+        for (size_t i = 0; i < capacity; ++i)
+        {
+            cells[i].seq.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    bool push(T&& data)
+    {
+        size_t pos = tail.load(std::memory_order_relaxed);
+        Cell* cell;
+        for (;;)
+        {
+            cell = &cells[pos & mask];
+            size_t seq = cell->seq.load(std::memory_order_acquire);
+            intptr_t diff = (intptr_t)seq - (intptr_t)pos;
+            if (diff == 0)
+            {
+                if (tail.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+                {
+                    break;
+                }
+            }
+            else if (diff < 0)
+            {
+                // full
+                return false;
+            }
+            else
+            {
+                pos = tail.load(std::memory_order_relaxed);
+            }
+        }
+        cell->data = std::move(data);
+        cell->seq.store(pos + 1, std::memory_order_release);
+        return true;
+    }
+
+    bool pop(T& data)
+    {
+        size_t pos = head.load(std::memory_order_relaxed);
+        Cell* cell;
+        for (;;)
+        {
+            cell = &cells[pos & mask];
+            size_t seq = cell->seq.load(std::memory_order_acquire);
+            intptr_t diff = (intptr_t)seq - (intptr_t)(pos + 1);
+            if (diff == 0)
+            {
+                if (head.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+                {
+                    break;
+                }
+            }
+            else if (diff < 0)
+            {
+                // empty
+                return false;
+            }
+            else
+            {
+                pos = head.load(std::memory_order_relaxed);
+            }
+        }
+        data = std::move(cell->data);
+        cell->seq.store(pos + mask + 1, std::memory_order_release);
+        return true;
+    }
+
+private:
+    struct Cell
+    {
+        std::atomic<size_t> seq;
+        T data;
+    };
+
+    std::vector<Cell> cells;
+    const size_t mask;
+    alignas(64) std::atomic<size_t> head;
+    alignas(64) std::atomic<size_t> tail;
+};
+
+// Long lived worker threads which run the executions of one prepared model.
+// Each worker owns one executor (execution context) of the model, so as many
+// requests as executors are in flight at once and a task runs on whichever
+// worker takes it. A worker calls initPerExecThread once when it starts and
+// deinitPerExecThread when the pool stops, so e.g. the EGL context stays current
+// between requests. An idle worker lets its executor do background work
+// (runIdle) before it sleeps. The workers are started with the first submitted task,
+// after the model is prepared.
+class ExecutionWorkerPool
+{
+public:
+    // exec is the executor of the worker, ready is false if its initPerExecThread failed
+    using Task = std::function<void(BaseExecutor& exec, bool ready)>;
+
+    ExecutionWorkerPool(const std::vector<sp<BaseExecutor>>& executors);
+    ~ExecutionWorkerPool();
+
+    void submit(Task&& task);
+    // runs the queued tasks, then joins the workers
+    void stop();
+
+private:
+    void start();
+    void workerLoop(BaseExecutor& exec);
+
+    static const size_t kQueueCapacity = 64;
+
+    const std::vector<sp<BaseExecutor>> execs;
+    std::vector<std::thread> workers;
+    std::once_flag started;
+    LockFreeQueue<Task> tasks;
+
+    // only used to park idle workers, submit takes the lock just when one is sleeping
+    std::mutex mtx;
+    std::condition_variable cv;
+    std::atomic<uint32_t> sleepers;
+    std::atomic<bool> stopping;
+};
+
+NAME_SPACE_STOP
+
+#endif
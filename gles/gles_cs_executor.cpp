@@ -1,5 +1,7 @@
 #include "gles_cs_executor.h"
 #include "gles_memory_manager.h"
+#include "compilation_cache.h"
+#include "gles_tuning_store.h"
 
 NAME_SPACE_BEGIN
 
@@ -12,6 +14,8 @@ GLint GlesCsExecutor::max_wg_size_x = 0;
 GLint GlesCsExecutor::max_wg_size_y = 0;
 GLint GlesCsExecutor::max_wg_size_z = 0;
 GLint GlesCsExecutor::max_wg_invocations = 0;
+std::string GlesCsExecutor::gl_version;
+PFNGLGETQUERYOBJECTUI64VEXTPROC GlesCsExecutor::getQueryObjectui64v = nullptr;
 
 bool GlesCsExecutor::initPerProcess()
 {
@@ -64,6 +68,16 @@ bool GlesCsExecutor::initPerProcess()
     glGetIntegeri_v(GL_MAX_COMPUTE_WORK_GROUP_SIZE, 1, &max_wg_size_y);
     glGetIntegeri_v(GL_MAX_COMPUTE_WORK_GROUP_SIZE, 2, &max_wg_size_z);
     glGetIntegerv(GL_MAX_COMPUTE_WORK_GROUP_INVOCATIONS, &max_wg_invocations);
+    gl_version = std::string(reinterpret_cast<const char*>(glGetString(GL_RENDERER))) + " " +
+                 std::string(reinterpret_cast<const char*>(glGetString(GL_VERSION)));
+    const char* extensions = reinterpret_cast<const char*>(glGetString(GL_EXTENSIONS));
+    if (extensions != nullptr && strstr(extensions, "GL_EXT_disjoint_timer_query") != nullptr)
+    {
+        getQueryObjectui64v = reinterpret_cast<PFNGLGETQUERYOBJECTUI64VEXTPROC>(
+                eglGetProcAddress("glGetQueryObjectui64vEXT"));
+    }
+    NN_GPU_DEBUG("%s: GPU timer query %s", __func__, getQueryObjectui64v ? "supported" : "not supported");
+    GlesTuningStore::init(gl_version);
     NN_GPU_DEBUG("%s: max_wg_count(%d,%d,%d), max_wg_size(%d,%d,%d), max_wg_invocation %d\n",
             __func__,
             max_wg_count_x, max_wg_count_y, max_wg_count_z,
@@ -91,6 +105,7 @@ bool GlesCsExecutor::initPerProcess()
 
 void GlesCsExecutor::deinitPerProcess()
 {
+    GlesTuningStore::deinit();
     if (eglTerminate(dpy) != EGL_TRUE)
     {
         LOGE("eglTerminate failed");
@@ -99,7 +114,9 @@ void GlesCsExecutor::deinitPerProcess()
 
 GlesCsExecutor::GlesCsExecutor(const Model& model) :
                         GpuExecutor(model),
-                        _ctx(EGL_NO_CONTEXT)
+                        _ctx(EGL_NO_CONTEXT),
+                        timeQuery(0),
+                        prepareOnly(false)
 {
 
 }
@@ -127,19 +144,162 @@ bool GlesCsExecutor::initPerModel()
         return false;
     }
 
+    if (eglMakeCurrent(dpy, EGL_NO_SURFACE, EGL_NO_SURFACE, _ctx) != EGL_TRUE)
+    {
+        LOGE("eglMakeCurrent failed to set within initPerModel");
+        showEglError();
+        return false;
+    }
+
     memMgr.initFromModel(model);
     initOperands();
     initOperationTimers();
     initOperationResources();
 
+    prepareOperations();
+
+    if (eglMakeCurrent(dpy, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT) != EGL_TRUE)
+    {
+        LOGE("eglMakeCurrent failed to clear within initPerModel");
+        showEglError();
+    }
+
     return true;
 }
 
 void GlesCsExecutor::initOperationResources()
 {
+    // filled by loadCache when the model comes from the compilation cache
     operationResources.resize(model.operations.size());
 }
 
+void GlesCsExecutor::prepareOperations()
+{
+    // CONV_2D is the only operation with work to do before the first request:
+    // the chn3 to chn4 filter conversion and the shader config tuning
+    prepareOnly = true;
+    for (size_t i = 0; i < model.operations.size(); ++i)
+    {
+        const Operation& operation = model.operations[i];
+        if (operation.type != OperationType::CONV_2D || !canPrepare(operation) ||
+            model.operands[operation.inputs[0]].type != OperandType::TENSOR_FLOAT32)
+        {
+            continue;
+        }
+        if (!doCONV_2D(operation, operationResources[i]))
+        {
+            NN_GPU_DEBUG("failed to prepare operation %zu, retry on its first run", i);
+        }
+    }
+    glFinish();
+
+    for (auto& res : operationResources)
+    {
+        std::vector<uint8_t>().swap(res.filter);
+    }
+    prepareOnly = false;
+}
+
+#define GLES_PLAN_MAGIC 0x4e4c5047    // "GPLN"
+#define GLES_PLAN_VERSION 3
+
+bool GlesCsExecutor::saveCache(std::vector<uint8_t>& plan, std::vector<uint8_t>& data)
+{
+    if (eglMakeCurrent(dpy, EGL_NO_SURFACE, EGL_NO_SURFACE, _ctx) != EGL_TRUE)
+    {
+        LOGE("eglMakeCurrent failed to set within saveCache");
+        showEglError();
+        return false;
+    }
+
+    CacheWriter writer(plan);
+    writer.write<uint32_t>(GLES_PLAN_MAGIC);
+    writer.write<uint32_t>(GLES_PLAN_VERSION);
+    writer.writeArray(gl_version);
+    writer.write<uint32_t>(operationResources.size());
+
+    bool ret = true;
+    for (auto& res : operationResources)
+    {
+        uint64_t filter_offset = data.size();
+        uint64_t filter_size = 0;
+
+        // the packed filter of a GEMM 4x8 CONV_2D, the transformed filter of a
+        // Winograd one, or else the chn4 filter of a 3 channel CONV_2D, see doCONV_2D
+        GLuint filter = res.packedFilter != 0 ? res.packedFilter : (res.tmpBo.size() == 2 ? res.tmpBo[1] : 0);
+        if (filter != 0)
+        {
+            GLint size = 0;
+            glBindBuffer(GL_SHADER_STORAGE_BUFFER, filter);
+            glGetBufferParameteriv(GL_SHADER_STORAGE_BUFFER, GL_BUFFER_SIZE, &size);
+            const void* p = glMapBufferRange(GL_SHADER_STORAGE_BUFFER, 0, size, GL_MAP_READ_BIT);
+            if (p == nullptr)
+            {
+                ret = false;
+                break;
+            }
+            filter_size = size;
+            data.resize(filter_offset + filter_size);
+            memcpy(data.data() + filter_offset, p, filter_size);
+            glUnmapBuffer(GL_SHADER_STORAGE_BUFFER);
+        }
+
+        writer.write<uint8_t>(res.hasConfig ? 1 : 0);
+        writer.write<uint8_t>(res.chn3Direct ? 1 : 0);
+        writer.write(res.config);
+        writer.write(filter_offset);
+        writer.write(filter_size);
+    }
+    memMgr.savePlan(writer);
+
+    if (eglMakeCurrent(dpy, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT) != EGL_TRUE)
+    {
+        LOGE("eglMakeCurrent failed to clear within saveCache");
+        showEglError();
+    }
+
+    return ret;
+}
+
+bool GlesCsExecutor::loadCache(const std::vector<uint8_t>& plan, const std::vector<uint8_t>& data)
+{
+    CacheReader reader(plan);
+    uint32_t magic = 0, version = 0, count = 0;
+    std::string version_string;
+    if (!reader.read(magic) || !reader.read(version) ||
+        !reader.readArray(version_string) || !reader.read(count) ||
+        magic != GLES_PLAN_MAGIC || version != GLES_PLAN_VERSION ||
+        version_string != gl_version || count != model.operations.size())
+    {
+        NN_GPU_DEBUG("gles plan is from another driver or version");
+        return false;
+    }
+
+    operationResources.resize(count);
+    for (auto& res : operationResources)
+    {
+        uint8_t has_config = 0, chn3_direct = 0;
+        uint64_t filter_offset = 0, filter_size = 0;
+        if (!reader.read(has_config) || !reader.read(chn3_direct) || !reader.read(res.config) ||
+            !reader.read(filter_offset) || !reader.read(filter_size) ||
+            filter_offset > data.size() || filter_size > data.size() - filter_offset)
+        {
+            operationResources.clear();
+            return false;
+        }
+        res.hasConfig = (has_config != 0);
+        res.chn3Direct = (chn3_direct != 0);
+        res.filter.assign(data.begin() + filter_offset, data.begin() + filter_offset + filter_size);
+    }
+
+    if (!memMgr.loadPlan(reader, model) || !reader.empty())
+    {
+        operationResources.clear();
+        return false;
+    }
+    return true;
+}
+
 void GlesCsExecutor::deinitOperationResources()
 {
     for (size_t i = 0; i < operationResources.size(); ++i)
@@ -149,6 +309,10 @@ void GlesCsExecutor::deinitOperationResources()
         {
             glDeleteBuffers(1, &res.tmpBo[j]);
         }
+        if (res.packedFilter != 0)
+        {
+            glDeleteBuffers(1, &res.packedFilter);
+        }
     }
 }
 
@@ -201,6 +365,11 @@ void GlesCsExecutor::deinitPerModel()
 
     memMgr.clean();
     progMgr.clean();
+    if (timeQuery != 0)
+    {
+        glDeleteQueries(1, &timeQuery);
+        timeQuery = 0;
+    }
     CHECKGLERROR();
 
     if (eglMakeCurrent(dpy, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT) != EGL_TRUE)
@@ -342,21 +511,72 @@ bool GlesCsExecutor::run(const Operation& operation, OperationCpuTimer* timer, G
     return ret;
 }
 
-bool GlesCsExecutor::run(const Request& request)
+bool GlesCsExecutor::beginTimeQuery()
+{
+    if (getQueryObjectui64v == nullptr)
+    {
+        return false;
+    }
+    if (timeQuery == 0)
+    {
+        glGenQueries(1, &timeQuery);
+    }
+
+    // reading the flag clears it, so a disjoint seen later belongs to this query
+    GLint disjoint = 0;
+    glGetIntegerv(GL_GPU_DISJOINT_EXT, &disjoint);
+    glBeginQuery(GL_TIME_ELAPSED_EXT, timeQuery);
+    return true;
+}
+
+uint64_t GlesCsExecutor::getQueryResultNs(GLuint query)
+{
+    GLuint64 elapsed = 0;
+    getQueryObjectui64v(query, GL_QUERY_RESULT_EXT, &elapsed);
+
+    // the counter is not reliable over e.g. a GPU frequency change
+    GLint disjoint = 0;
+    glGetIntegerv(GL_GPU_DISJOINT_EXT, &disjoint);
+    return disjoint ? UINT64_MAX : elapsed;
+}
+
+uint64_t GlesCsExecutor::getTimeQueryResult()
+{
+    // waits for the dispatches, they are finished by memMgr.sync anyway
+    uint64_t elapsed = getQueryResultNs(timeQuery);
+    return elapsed == UINT64_MAX ? UINT64_MAX : elapsed / 1000;
+}
+
+bool GlesCsExecutor::run(const Request& request, MeasureTiming measure, uint64_t& timeOnDevice)
 {
     restoreOperands();
     memMgr.resetFromRequest(request);
     setArgOperands(request);
+
+    timeOnDevice = UINT64_MAX;
+    const bool timing = (measure == MeasureTiming::YES) && beginTimeQuery();
     for (size_t i = 0; i < model.operations.size(); ++i)
     {
         const Operation& operation = model.operations[i];
         OperationCpuTimer* timer = &operationTimers[i];
         if (!run(operation, timer, operationResources[i]))
         {
+            if (timing)
+            {
+                glEndQuery(GL_TIME_ELAPSED_EXT);
+            }
             return false;
         }
     }
+    if (timing)
+    {
+        glEndQuery(GL_TIME_ELAPSED_EXT);
+    }
     memMgr.sync();
+    if (timing)
+    {
+        timeOnDevice = getTimeQueryResult();
+    }
     CHECKGLERROR();
     return true;
 }
@@ -406,7 +626,7 @@ void GlesCsExecutor::setTotal(GLuint prog, uint32_t totalX, uint32_t totalY, uin
 void GlesCsExecutor::bindOperand(GlesOperand& operand, GLuint boindex)
 {
     GLuint bo = operand.getSSbo();
-    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, boindex, bo);
+    glBindBufferRange(GL_SHADER_STORAGE_BUFFER, boindex, bo, operand.getSSboOffset(), operand.size());
 }
 
 void GlesCsExecutor::getCapabilities(V1_0::Capabilities &cap)
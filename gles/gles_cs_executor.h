@@ -24,6 +24,7 @@
 #include <EGL/eglext.h>
 #include <GLES3/gl3.h>
 #include <GLES3/gl32.h>
+#include <GLES2/gl2ext.h>
 
 #include "gpu_executor.h"
 #include "gles_operand.h"
@@ -33,10 +34,47 @@
 
 NAME_SPACE_BEGIN
 
+// vulkan has its own ShaderConfig, both headers are included by the executor manager
+struct GlesShaderConfig
+{
+    GlesShaderConfig(int type, int lx, int ly, int lz, int bx, int by, int bz)
+    {
+        shaderType = type;
+        localSizeX  = lx;
+        localSizeY  = ly;
+        localSizeZ  = lz;
+        blockWidth  = bx;
+        blockHeight = by;
+        blockDepth  = bz;
+    };
+
+    GlesShaderConfig(): localSizeX(0), localSizeY(0), localSizeZ(0),
+        blockWidth(0), blockHeight(0), blockDepth(0), shaderType(0)
+    {};
+
+    int localSizeX;
+    int localSizeY;
+    int localSizeZ;
+    int blockWidth;
+    int blockHeight;
+    int blockDepth;
+    int shaderType;
+};
+
 struct GlesOperationResource
 {
-    GlesOperationResource(){}
+    GlesOperationResource() : hasConfig(false), chn3Direct(false), packedFilter(0) {}
     std::vector<GLuint> tmpBo;
+    // CONV_2D shader config, selected when the model is prepared or from the compilation cache
+    bool hasConfig;
+    GlesShaderConfig config;
+    // a 3 channel CONV_2D runs on its input as is, without the conversion to 4 channels
+    bool chn3Direct;
+    // the filter in the layout of the packed GEMM 4x8 shader, or transformed for
+    // Winograd, 0 for the others
+    GLuint packedFilter;
+    // chn4 filter from the compilation cache, only kept until it is uploaded
+    std::vector<uint8_t> filter;
 };
 
 class GlesCsExecutor : public GpuExecutor
@@ -53,9 +91,12 @@ public:
 
     bool initPerModel() override;
     bool initPerExecThread() override;
-    bool run(const Request& request) override;
+    bool run(const Request& request, MeasureTiming measure, uint64_t& timeOnDevice) override;
+    void invalidatePool(const hidl_memory& pool) override { memMgr.invalidatePool(pool); }
     void deinitPerExecThread() override;
     void deinitPerModel() override;
+    bool saveCache(std::vector<uint8_t>& plan, std::vector<uint8_t>& data) override;
+    bool loadCache(const std::vector<uint8_t>& plan, const std::vector<uint8_t>& data) override;
     std::string getOpName(const Operation& operation);
     static GLint max_wg_count_x;
     static GLint max_wg_count_y;
@@ -64,11 +105,23 @@ public:
     static GLint max_wg_size_y;
     static GLint max_wg_size_z;
     static GLint max_wg_invocations;
+    // GL_EXT_disjoint_timer_query, the conv tuner times candidates on the GPU with it
+    static bool hasTimerQuery() { return getQueryObjectui64v != nullptr; }
+    // nanoseconds of a finished GL_TIME_ELAPSED_EXT query, UINT64_MAX when the counter was disjoint
+    static uint64_t getQueryResultNs(GLuint query);
 
 private:
     static EGLDisplay dpy;
     static EGLConfig cfg;
+    // renderer and version of the driver, a cached plan is only good for the same one
+    static std::string gl_version;
+    // GL_EXT_disjoint_timer_query, null when the driver does not have it
+    static PFNGLGETQUERYOBJECTUI64VEXTPROC getQueryObjectui64v;
     EGLContext _ctx;
+    // GL_TIME_ELAPSED_EXT query around the dispatches of a request
+    GLuint timeQuery;
+    // set while initPerModel prepares the operations, nothing is dispatched then
+    bool prepareOnly;
     //cannot be a global memMgr per process since the gl objects belong to one context (_ctx)
     GlesMemoryManager memMgr;
     GlesCsProgramManager progMgr;
@@ -86,10 +139,14 @@ private:
     void restoreOperands();
     void setArgOperands(const Request& request);
 
+    bool beginTimeQuery();
+    uint64_t getTimeQueryResult();
+
     void initOperationTimers();
     void showOperationTimers();
     void initOperationResources();
     void deinitOperationResources();
+    void prepareOperations();
 
     void bindOperand(GlesOperand& operand, GLuint boindex);
     void setTotal(GLuint prog, uint32_t totalX);
@@ -99,6 +156,14 @@ private:
     void setUniform1f(GLuint prog, const char* name, GLfloat f);
 
     bool run(const Operation& operation, OperationCpuTimer* timer, GlesOperationResource& resource);
+    void prepareConfig(ConvParam& convParam, GlesOperationResource& resource,
+                       GLuint inSSbo, GLuint filterSSbo, GLuint biasSSbo);
+    void prepareChn3Config(ConvParam& convParam, GlesOperationResource& resource,
+                           GLuint filterSSbo, GLuint filterChn4SSbo, GLuint biasSSbo);
+    void preparePackedFilter(ConvParam& convParam, GlesOperationResource& resource,
+                             GLuint filterSSbo, GLintptr filterOffset);
+    void prepareWinograd(ConvParam& convParam, GlesOperationResource& resource,
+                         GLuint filterSSbo, GLintptr filterOffset, GLuint biasSSbo, bool tune);
 
 #define SETUP_OP(op) bool do##op(const Operation& operation, GlesOperationResource& resource);
 #include "gles_setup_op.hxx"
@@ -1,6 +1,11 @@
 #include <math.h>
+#include <algorithm>
+#include <functional>
+#include <memory>
 #include <cutils/properties.h>
 #include "gles_cs_executor.h"
+#include "conv_cost_model.h"
+#include "gles_tuning_store.h"
 
 NAME_SPACE_BEGIN
 
@@ -26,11 +31,24 @@ NAME_SPACE_BEGIN
 
 
 typedef std::map<std::string, std::string> ShaderConfigMap;
-typedef std::map<long, int> TimedConfig;
+// a tuning candidate, the median of its runs and its work groups
+struct TimedConfig
+{
+    long elapsedUS;
+    long groups;
+    size_t index;
+};
+
+// runs of each candidate
+#define TUNE_RUNS 5
+// candidates within this percentage of the fastest are ranked by their work groups
+#define TUNE_NOISE_PERCENT 3
+// mtx guards the map, the signature locks and inited, a signature lock is
+// held while its conv is tuned so the convs of other signatures go on
 static ShaderConfigMap shaderConfigMap;
+static std::map<std::string, std::shared_ptr<std::mutex>> signatureLocks;
 static bool inited = false;
 static std::mutex mtx;
-const char *prop_prefix = "persist.nn.gpgpu.shader.config.";
 static GLint max_wg_count_x;
 static GLint max_wg_count_y;
 static GLint max_wg_count_z;
@@ -44,31 +62,7 @@ bool computeGroupParam(uint32_t totalThreadX,
                        uint32_t& groupCountX);
 
 
-struct ShaderConfig
-{
-    ShaderConfig(int type, int lx, int ly, int lz, int bx, int by, int bz)
-    {
-        shaderType = type;
-        localSizeX  = lx;
-        localSizeY  = ly;
-        localSizeZ  = lz;
-        blockWidth  = bx;
-        blockHeight = by;
-        blockDepth  = bz;
-    };
-
-    ShaderConfig(): localSizeX(0), localSizeY(0), localSizeZ(0),
-        blockWidth(0), blockHeight(0), blockDepth(0), shaderType(0)
-    {};
-
-    int localSizeX;
-    int localSizeY;
-    int localSizeZ;
-    int blockWidth;
-    int blockHeight;
-    int blockDepth;
-    int shaderType;
-};
+using ShaderConfig = GlesShaderConfig;
 
 // in(inH, inW, inC) out(outH, outW, outC)
 // lsz(localSizeX, localSizeY, localSizeZ)
@@ -301,11 +295,16 @@ static const char* defaultConfig[] =
 #endif
 };
 
-void string2Config(const char* confString, ShaderConfig &conf)
+bool string2Config(const char* confString, ShaderConfig &conf)
 {
-    sscanf(confString, "type%d_lsz%d_%d_%d_block%d_%d_%d",
-           &conf.shaderType, &conf.localSizeX,  &conf.localSizeY, &conf.localSizeZ,
-           &conf.blockWidth, &conf.blockHeight, &conf.blockDepth);
+    if (sscanf(confString, "type%d_lsz%d_%d_%d_block%d_%d_%d",
+               &conf.shaderType, &conf.localSizeX,  &conf.localSizeY, &conf.localSizeZ,
+               &conf.blockWidth, &conf.blockHeight, &conf.blockDepth) != 7)
+    {
+        LOGW("CONV_2D: string2Config: invalid config %s", confString);
+        return false;
+    }
+    return true;
 }
 
 std::string genShaderConfigString(ShaderConfig &conf)
@@ -332,6 +331,12 @@ std::string genConvSignature(ConvParam &convParam)
     return sig.str();
 }
 
+// the 4x4 output tiles of Winograd F(4x4, 3x3), of all the batches
+static int winogradTiles(const ConvParam& convParam)
+{
+    return convParam.batch * ((convParam.outH + 3) / 4) * ((convParam.outW + 3) / 4);
+}
+
 bool computeGroupCount(ConvParam &convParam, ShaderConfig &conf, int &group_x, int &group_y, int &group_z)
 {
     int M = convParam.outW * convParam.outH;
@@ -364,7 +369,8 @@ bool computeGroupCount(ConvParam &convParam, ShaderConfig &conf, int &group_x, i
         group_y = ALIGN(ALIGN(M, 4) / 4, conf.localSizeY) / conf.localSizeY;
         group_z = convParam.batch;
     }
-    else if (conf.shaderType == CONV_SHADER_TYPE_GEMM_4_8_GENERIC)
+    else if (conf.shaderType == CONV_SHADER_TYPE_GEMM_4_8_GENERIC ||
+             conf.shaderType == CONV_SHADER_TYPE_GEMM_4_8_PACKED)
     {
         ASSERT(conf.blockWidth == 8 && conf.blockHeight == 4 && conf.blockDepth == 1 && conf.localSizeZ == 1);
         group_x = ALIGN(N / conf.blockWidth, conf.localSizeX) / conf.localSizeX;
@@ -378,6 +384,39 @@ bool computeGroupCount(ConvParam &convParam, ShaderConfig &conf, int &group_x, i
         group_y = ALIGN(M / 4, conf.localSizeY) / conf.localSizeY;
         group_z = convParam.batch;
     }
+    else if (conf.shaderType == CONV_SHADER_TYPE_GEMM_IMPLICIT)
+    {
+        ASSERT(conf.blockWidth == 4 && conf.blockHeight == 4 && conf.blockDepth == 1 && conf.localSizeZ == 1);
+        group_x = ALIGN(N / 4, conf.localSizeX) / conf.localSizeX;
+        group_y = ALIGN(ALIGN(M, 4) / 4, conf.localSizeY) / conf.localSizeY;
+        group_z = convParam.batch;
+    }
+    else if (conf.shaderType == CONV_SHADER_TYPE_GEMM_SPLIT_K)
+    {
+        ASSERT(conf.localSizeY == 1 && conf.localSizeZ == 1);
+        group_x = N;
+        group_y = M;
+        group_z = convParam.batch;
+    }
+    else if (conf.shaderType == CONV_SHADER_TYPE_WINOGRAD)
+    {
+        // 4 tiles by 4 output channels an invocation, for each of the 36 GEMMs
+        group_x = ALIGN(N / 4, conf.localSizeX) / conf.localSizeX;
+        group_y = ALIGN(ALIGN(winogradTiles(convParam), 4) / 4, conf.localSizeY) / conf.localSizeY;
+        group_z = 36;
+    }
+    else if (conf.shaderType == CONV_SHADER_TYPE_WINOGRAD_INPUT)
+    {
+        group_x = ALIGN(convParam.inC, conf.localSizeX) / conf.localSizeX;
+        group_y = ALIGN(winogradTiles(convParam), conf.localSizeY) / conf.localSizeY;
+        group_z = 1;
+    }
+    else if (conf.shaderType == CONV_SHADER_TYPE_WINOGRAD_OUTPUT)
+    {
+        group_x = ALIGN(N / 4, conf.localSizeX) / conf.localSizeX;
+        group_y = ALIGN(winogradTiles(convParam), conf.localSizeY) / conf.localSizeY;
+        group_z = 1;
+    }
     else
     {
         NOT_REACH_HERE;
@@ -415,6 +454,10 @@ std::vector<ShaderConfig> genShaderConfigBasic(ConvParam &convParam)
     return candidates;
 }
 
+// the output rows below which, and the K from which, split-K is tuned
+static const int kSplitKMaxM = 64;
+static const int kSplitKMinK = 512;
+
 inline bool needImg2Col(ConvParam &convParam)
 {
     return !(convParam.padH    == 0 && convParam.padW == 0 &&
@@ -477,6 +520,37 @@ std::vector<ShaderConfig> genShaderConfigCandidates(ConvParam &convParam, ConvSh
             }
         }
     }
+    else if (type == CONV_SHADER_TYPE_GEMM_IMPLICIT)
+    {
+        // a work group loads 4 * ly im2col rows and 4 * lx filter rows into
+        // shared memory, smaller ones share too little to pay for the barriers
+        if (convParam.inC % 4 == 0 && N % 4 == 0)
+        {
+            for (int lx = 4; lx <= 16; lx *= 2)
+            {
+                for (int ly = 4; ly <= 16; ly *= 2)
+                {
+                    ShaderConfig conf(CONV_SHADER_TYPE_GEMM_IMPLICIT, lx, ly, 1, 4, 4, 1);
+                    if (computeGroupCount(convParam, conf, group_x, group_y, group_z))
+                        candidates.push_back(conf);
+                }
+            }
+        }
+    }
+    else if (type == CONV_SHADER_TYPE_GEMM_SPLIT_K)
+    {
+        // only worth it when there are too few output rows to keep the GPU busy
+        // and a long K to split, e.g. a 1x1 classifier over 2048 channels
+        if (convParam.inC % 4 == 0 && M <= kSplitKMaxM && K >= kSplitKMinK)
+        {
+            for (int lx = 32; lx <= 256; lx *= 2)
+            {
+                ShaderConfig conf(CONV_SHADER_TYPE_GEMM_SPLIT_K, lx, 1, 1, 1, 1, 1);
+                if (lx <= K / 4 && computeGroupCount(convParam, conf, group_x, group_y, group_z))
+                    candidates.push_back(conf);
+            }
+        }
+    }
     else if (type == CONV_SHADER_TYPE_GEMM_4_4_CHN3)
     {
         if (convParam.inC % 4 != 0 && M % 4 == 0 && N % 4 == 0)
@@ -574,6 +648,38 @@ std::vector<ShaderConfig> genShaderConfigCandidates(ConvParam &convParam, ConvSh
     return candidates;
 }
 
+// what a candidate dispatches, for the cost model. A work group reads the K long
+// rows of its block of output rows and filter columns, the invocations sharing
+// one hit the cache (or shared memory for GEMM_IMPLICIT)
+static ConvWorkload describeWorkload(ConvParam& convParam, ShaderConfig& conf)
+{
+    ConvWorkload workload = {};
+    int group_x, group_y, group_z;
+    if (!computeGroupCount(convParam, conf, group_x, group_y, group_z))
+    {
+        return workload;
+    }
+
+    const double K = convParam.filterH * convParam.filterW * convParam.inC;
+    workload.groups      = (long)group_x * group_y * group_z;
+    workload.invocations = conf.localSizeX * conf.localSizeY * conf.localSizeZ;
+
+    if (conf.shaderType == CONV_SHADER_TYPE_GEMM_SPLIT_K)
+    {
+        // one output a work group, its invocations take vec4 steps of K in turn
+        workload.flops = 2.0 * ALIGN((int)K, 4 * conf.localSizeX) * workload.groups;
+        workload.bytes = sizeof(float) * workload.groups * (2 * K + 1);
+        return workload;
+    }
+
+    const double outputs = conf.blockWidth * conf.blockHeight * conf.blockDepth;
+    const double rows    = conf.localSizeY * conf.blockHeight * conf.localSizeZ * conf.blockDepth;
+    const double cols    = conf.localSizeX * conf.blockWidth;
+    workload.flops = 2.0 * K * outputs * workload.invocations * workload.groups;
+    workload.bytes = sizeof(float) * workload.groups * (K * (rows + cols) + outputs * workload.invocations);
+    return workload;
+}
+
 void createSSBufferObject(GLuint& ssbo, GLuint count)
 {
     glGenBuffers(1, &ssbo);
@@ -593,7 +699,8 @@ bool chn3ToChn4(ConvParam& convParam,
                 GlesCsProgramManager& progMgr,
                 GLuint inBo,
                 GLuint outBo,
-                GLuint numItems)
+                GLuint numItems,
+                GLintptr inOffset = 0)
 {
     GLuint prog;
     uint32_t localSizeX = 16;
@@ -602,7 +709,8 @@ bool chn3ToChn4(ConvParam& convParam,
     uint32_t totalThreadX = ALIGN(numItems, ITEMS_PER_WI) / ITEMS_PER_WI;
     computeGroupParam(totalThreadX, localSizeX, localSizeX, groupCountX);
 
-    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, inBo);
+    // the input may be a temporary in the arena
+    glBindBufferRange(GL_SHADER_STORAGE_BUFFER, 0, inBo, inOffset, numItems * sizeof(float));
     glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 1, outBo);
 
     GlesCsProgramKeyConv key;
@@ -640,9 +748,9 @@ bool chn3ToChn4(ConvParam& convParam,
 }
 
 
-bool convolve(ConvParam& convParam,
-              ShaderConfig& shaderConfig,
-              GlesCsProgramManager& progMgr)
+static bool dispatchConv(ConvParam& convParam,
+                         ShaderConfig& shaderConfig,
+                         GlesCsProgramManager& progMgr)
 {
     int group_x, group_y, group_z;
     GLuint prog;
@@ -671,42 +779,105 @@ bool convolve(ConvParam& convParam,
     CHECK_GL_STATE_RET();
 }
 
-bool convolveTimed(ConvParam& convParam,
-                   ShaderConfig& shaderConfig,
-                   GlesCsProgramManager& progMgr,
-                   int iter,
-                   long& elapsedTime,
-                   bool syncPerIter)
+bool convolve(ConvParam& convParam,
+              ShaderConfig& shaderConfig,
+              GlesCsProgramManager& progMgr)
+{
+    if (shaderConfig.shaderType != CONV_SHADER_TYPE_WINOGRAD)
+    {
+        return dispatchConv(convParam, shaderConfig, progMgr);
+    }
+
+    // the transformed filter is bound at 2, the transformed input tiles at 4
+    // and the products of the 36 GEMMs at 5, see prepareWinograd
+    ShaderConfig inputConf(CONV_SHADER_TYPE_WINOGRAD_INPUT, 16, 4, 1, 1, 1, 1);
+    ShaderConfig outputConf(CONV_SHADER_TYPE_WINOGRAD_OUTPUT, 16, 4, 1, 1, 1, 1);
+    if (!dispatchConv(convParam, inputConf, progMgr))
+        return false;
+    glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
+    if (!dispatchConv(convParam, shaderConfig, progMgr))
+        return false;
+    glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
+    return dispatchConv(convParam, outputConf, progMgr);
+}
+
+static long median(std::vector<long>& samples)
+{
+    std::nth_element(samples.begin(), samples.begin() + samples.size() / 2, samples.end());
+    return samples[samples.size() / 2];
+}
+
+// the median GPU time of iter calls of run when the driver has a timer query,
+// else the wall time of the calls including their submission and the wait for them
+static bool runTimed(const std::function<bool()>& run,
+                     int iter,
+                     long& elapsedTime,
+                     bool syncPerIter)
 {
     bool res = false;
-    long t = 0.0;
-    
+    std::vector<long> samples;
+
     // warm up run
-    if (!convolve(convParam, shaderConfig, progMgr))
+    if (!run())
         return false;
     glFinish();
 
-    TIMER_START(convTime);
-    for (int i = 0; i < iter; i++)
+    if (GlesCsExecutor::hasTimerQuery())
     {
-        res = convolve(convParam, shaderConfig, progMgr);
-        if (!res)
-            break;
-        if (syncPerIter)
+        GLuint query;
+        glGenQueries(1, &query);
+        for (int i = 0; i < iter; i++)
+        {
+            // reading the flag clears it, so a disjoint seen later belongs to this run
+            GLint disjoint = 0;
+            glGetIntegerv(GL_GPU_DISJOINT_EXT, &disjoint);
+            glBeginQuery(GL_TIME_ELAPSED_EXT, query);
+            res = run();
+            glEndQuery(GL_TIME_ELAPSED_EXT);
+            if (!res)
+                break;
+            uint64_t ns = GlesCsExecutor::getQueryResultNs(query);
+            if (ns != UINT64_MAX)
+                samples.push_back(ns / 1000);
+        }
+        glDeleteQueries(1, &query);
+    }
+
+    if (samples.empty())
+    {
+        TIMER_START(convTime);
+        for (int i = 0; i < iter; i++)
+        {
+            res = run();
+            if (!res)
+                break;
+            if (syncPerIter)
+                glFinish();
+        }
+        if (!syncPerIter)
             glFinish();
+        samples.push_back(TIMER_STOP(convTime) / iter);
     }
-    if (!syncPerIter)
-        glFinish();
-    t = TIMER_STOP(convTime) / iter;
 
     if (res)
-        elapsedTime = t;
+        elapsedTime = median(samples);
     else
         elapsedTime = std::numeric_limits<long>::max();
 
     return res;
 }
 
+bool convolveTimed(ConvParam& convParam,
+                   ShaderConfig& shaderConfig,
+                   GlesCsProgramManager& progMgr,
+                   int iter,
+                   long& elapsedTime,
+                   bool syncPerIter)
+{
+    return runTimed([&]() { return convolve(convParam, shaderConfig, progMgr); },
+                    iter, elapsedTime, syncPerIter);
+}
+
 void convOneBHWC(
      float* image_data,  int image_offset,
      float* kernel_data, int kernel_offset,
@@ -883,7 +1054,8 @@ void resetOutput(ConvParam &convParam, GLuint output)
     glUnmapBuffer(GL_SHADER_STORAGE_BUFFER);
 }
 
-bool verifyResult(ConvParam &convParam, float* in_buffer, float* filter_buffer, float* bias_buffer, float* result_buffer)
+bool verifyResult(ConvParam &convParam, float* in_buffer, float* filter_buffer, float* bias_buffer, float* result_buffer,
+                  float tolerance = 0.1f)
 {
     int batch = convParam.batch;
     int input_chn = convParam.inC;
@@ -926,7 +1098,7 @@ bool verifyResult(ConvParam &convParam, float* in_buffer, float* filter_buffer,
                 {
                     int offset = b * (output_chn * output_height * output_width) + h * (output_width * output_chn) + w * output_chn + c;
 
-                    if (fabs(pOut[offset] - benchmark[offset]) > 0.1 * fabs(benchmark[offset]) ||
+                    if (fabs(pOut[offset] - benchmark[offset]) > tolerance * fabs(benchmark[offset]) &&
                         !(fabs(benchmark[offset]) < 1.e-3 && fabs(pOut[offset] - benchmark[offset]) < 1.e-4))
                     {
                         LOGE("CONV_2D: convolution verification failed at (%d, %d, %d, %d), actual: %f, expected: %f\n",
@@ -943,7 +1115,7 @@ bool verifyResult(ConvParam &convParam, float* in_buffer, float* filter_buffer,
 }
 
 bool verifyShader(ConvParam &convParam, ShaderConfig &shaderConfig, GlesCsProgramManager& progMgr,
-                  GLuint input, GLuint filter, GLuint bias, GLuint output)
+                  GLuint input, GLuint filter, GLuint bias, GLuint output, float tolerance = 0.1f)
 {
     bool succeed;
     if (!convolve(convParam, shaderConfig, progMgr))
@@ -980,7 +1152,7 @@ bool verifyShader(ConvParam &convParam, ShaderConfig &shaderConfig, GlesCsProgra
     memcpy(bias_buffer, p, bias_size * sizeof(float));
     glUnmapBuffer(GL_SHADER_STORAGE_BUFFER);
 
-    succeed = verifyResult(convParam, in_buffer, filter_buffer, bias_buffer, out_buffer);
+    succeed = verifyResult(convParam, in_buffer, filter_buffer, bias_buffer, out_buffer, tolerance);
 
     delete[] in_buffer;
     delete[] filter_buffer;
@@ -989,8 +1161,27 @@ bool verifyShader(ConvParam &convParam, ShaderConfig &shaderConfig, GlesCsProgra
     return succeed;
 }
 
+// fastest first, but the candidates within the noise of the fastest are taken
+// in the order of their work groups, fewer first, the one ranked first on one
+// run is not reliably faster than them
+static void rankTimedConfigs(std::vector<TimedConfig>& timedConfigs)
+{
+    std::stable_sort(timedConfigs.begin(), timedConfigs.end(),
+                     [](const TimedConfig& a, const TimedConfig& b) { return a.elapsedUS < b.elapsedUS; });
+    if (timedConfigs.empty())
+    {
+        return;
+    }
+    const long limit = timedConfigs[0].elapsedUS + timedConfigs[0].elapsedUS * TUNE_NOISE_PERCENT / 100;
+    auto noisy = std::find_if(timedConfigs.begin(), timedConfigs.end(),
+                              [limit](const TimedConfig& c) { return c.elapsedUS > limit; });
+    std::stable_sort(timedConfigs.begin(), noisy,
+                     [](const TimedConfig& a, const TimedConfig& b) { return a.groups < b.groups; });
+}
+
 bool tryShaderConfig(ConvParam& convParam,
                      ShaderConfig& best,
+                     long& bestUS,
                      GlesCsProgramManager& progMgr,
                      GLuint input,
                      GLuint filter,
@@ -998,17 +1189,17 @@ bool tryShaderConfig(ConvParam& convParam,
                      GLuint output,
                      std::vector<ShaderConfig>& configs)
 {
-    TimedConfig timedConfig;
+    std::vector<TimedConfig> timedConfigs;
     std::string name;
     GlesCsProgramKeyConv key;
     bool ret = false;
-    
+
     key.activation  = convParam.activation;
     key.convParam   = convParam;
     for (size_t i = 0; i < configs.size(); i ++)
     {
         long elapsedUS;
-        bool ret = convolveTimed(convParam, configs[i], progMgr, 1, elapsedUS, true);
+        bool timed = convolveTimed(convParam, configs[i], progMgr, TUNE_RUNS, elapsedUS, true);
         // delete temporary program in time to save run time memory.
         key.localSizeX  = configs[i].localSizeX;
         key.localSizeY  = configs[i].localSizeY;
@@ -1019,17 +1210,20 @@ bool tryShaderConfig(ConvParam& convParam,
         key.shaderType  = configs[i].shaderType;
         progMgr.getProgName(&key, name);
         progMgr.deleteProgram(name);
-        if (ret)
+        if (timed)
         {
             NN_GPU_PERF("CONV_2D: %s: tune: %8.3f ms, %s\n", __func__, 1.0 * elapsedUS / 1000, name.c_str());
-            std::pair<long, int> entry(elapsedUS, i);
-            timedConfig.insert(entry);
+            int group_x, group_y, group_z;
+            computeGroupCount(convParam, configs[i], group_x, group_y, group_z);
+            TimedConfig entry = { elapsedUS, (long)group_x * group_y * group_z, i };
+            timedConfigs.push_back(entry);
         }
     }
+    rankTimedConfigs(timedConfigs);
 
-    for(TimedConfig::iterator it = timedConfig.begin(); it != timedConfig.end(); ++it)
+    for (auto it = timedConfigs.begin(); it != timedConfigs.end(); ++it)
     {
-        ShaderConfig cand = configs[it->second];
+        ShaderConfig cand = configs[it->index];
         key.localSizeX  = cand.localSizeX;
         key.localSizeY  = cand.localSizeY;
         key.localSizeZ  = cand.localSizeZ;
@@ -1043,9 +1237,10 @@ bool tryShaderConfig(ConvParam& convParam,
         if (verifyShader(convParam, cand, progMgr, input, filter, bias, output))
         {
             best = cand;
+            bestUS = it->elapsedUS;
             ret = true;
             NN_GPU_PERF("CONV_2D: %s: tune: Best shader config: %.2f ms, %s\n",
-                    __func__, 1.0 * it->first / 1000, name.c_str());
+                    __func__, 1.0 * it->elapsedUS / 1000, name.c_str());
             break;
         }
         else
@@ -1056,9 +1251,105 @@ bool tryShaderConfig(ConvParam& convParam,
     return ret;
 }
 
+// times the candidates the cost model ranks first, the top k of each shader type,
+// and the others only if none of them verifies
+static bool tryRankedShaderConfig(ConvParam& convParam,
+                                  ShaderConfig& best,
+                                  long& bestUS,
+                                  GlesCsProgramManager& progMgr,
+                                  GLuint input,
+                                  GLuint filter,
+                                  GLuint bias,
+                                  GLuint output,
+                                  std::vector<ShaderConfig>& configs)
+{
+    std::vector<double> costs;
+    std::vector<int> kinds;
+    for (auto& c : configs)
+    {
+        costs.push_back(ConvCostModel::estimate(describeWorkload(convParam, c), max_wg_invocations));
+        kinds.push_back(c.shaderType);
+    }
+
+    std::vector<size_t> kept, rest;
+    ConvCostModel::prune(costs, kinds, kept, rest);
+
+    std::vector<ShaderConfig> ranked;
+    for (size_t i : kept)
+    {
+        ranked.push_back(configs[i]);
+    }
+    if (tryShaderConfig(convParam, best, bestUS, progMgr, input, filter, bias, output, ranked))
+    {
+        // with nn.gpgpu.tune_top_k=0 all are timed, this is how well the model ranks them
+        const std::string bestString = genShaderConfigString(best);
+        for (size_t i = 0; i < ranked.size(); ++i)
+        {
+            if (genShaderConfigString(ranked[i]) == bestString)
+            {
+                NN_GPU_PERF("CONV_2D: %s: cost model ranked the tuned config %zu of %zu timed, %zu skipped\n",
+                            __func__, i + 1, ranked.size(), rest.size());
+                break;
+            }
+        }
+        return true;
+    }
+
+    if (rest.empty())
+    {
+        return false;
+    }
+    NN_GPU_PERF("CONV_2D: %s: no top ranked config verified, time the others\n", __func__);
+    ranked.clear();
+    for (size_t i : rest)
+    {
+        ranked.push_back(configs[i]);
+    }
+    return tryShaderConfig(convParam, best, bestUS, progMgr, input, filter, bias, output, ranked);
+}
+
+// the shader types tune tries, the ones of a pass are timed against each other
+// and a pass is only tried when none of the earlier ones verified
+static const std::vector<std::vector<ConvShaderType>> tunePasses =
+{
+    {CONV_SHADER_TYPE_GEMM_4_8_GENERIC, CONV_SHADER_TYPE_GEMM_4_4_CHN3,
+     CONV_SHADER_TYPE_GEMM_IMPLICIT, CONV_SHADER_TYPE_GEMM_SPLIT_K},
+    {CONV_SHADER_TYPE_GEMM_4_4_GENERIC, CONV_SHADER_TYPE_GEMM_4_4_NO_IMG2COL},
+    {CONV_SHADER_TYPE_GEMM1},
+    {CONV_SHADER_TYPE_BASIC},
+};
+
+// the config of a conv none of the candidates verified for: of the candidates of
+// the first pass of tune that has any, the one the cost model ranks first
+static bool heuristicConfig(ConvParam& convParam, ShaderConfig& conf)
+{
+    for (const std::vector<ConvShaderType>& pass : tunePasses)
+    {
+        double best = std::numeric_limits<double>::max();
+        for (ConvShaderType type : pass)
+        {
+            for (auto& c : genShaderConfigCandidates(convParam, type))
+            {
+                double cost = ConvCostModel::estimate(describeWorkload(convParam, c), max_wg_invocations);
+                if (cost < best)
+                {
+                    best = cost;
+                    conf = c;
+                }
+            }
+        }
+        if (best < std::numeric_limits<double>::max())
+        {
+            return true;
+        }
+    }
+    return false;
+}
 
-void tune(ConvParam& convParam,
+// false when no candidate verified, conf is a heuristic one then
+bool tune(ConvParam& convParam,
           ShaderConfig& conf,
+          long& elapsedUS,
           GlesCsProgramManager& progMgr,
           GLuint input,
           GLuint filter,
@@ -1066,70 +1357,104 @@ void tune(ConvParam& convParam,
           GLuint output)
 {
     bool succeed = false;
-    std::vector<ShaderConfig> configs;
-    std::vector<ShaderConfig> more;
-
-    configs = genShaderConfigCandidates(convParam, CONV_SHADER_TYPE_GEMM_4_8_GENERIC);
-    more = genShaderConfigCandidates(convParam, CONV_SHADER_TYPE_GEMM_4_4_CHN3);
-    configs.insert(configs.end(), more.begin(), more.end());
-    succeed = tryShaderConfig(convParam, conf, progMgr, input, filter, bias, output, configs);
 
-    if (!succeed)
+    for (const std::vector<ConvShaderType>& pass : tunePasses)
     {
-        configs = genShaderConfigCandidates(convParam, CONV_SHADER_TYPE_GEMM_4_4_GENERIC);
-        more = genShaderConfigCandidates(convParam, CONV_SHADER_TYPE_GEMM_4_4_NO_IMG2COL);
-        configs.insert(configs.end(), more.begin(), more.end());
-        succeed = tryShaderConfig(convParam, conf, progMgr, input, filter, bias, output, configs);
-    }
+        std::vector<ShaderConfig> configs;
+        for (ConvShaderType type : pass)
+        {
+            std::vector<ShaderConfig> more = genShaderConfigCandidates(convParam, type);
+            configs.insert(configs.end(), more.begin(), more.end());
+        }
+        if (configs.empty())
+        {
+            continue;
+        }
 
-    if (!succeed)
-    {
-        configs = genShaderConfigCandidates(convParam, CONV_SHADER_TYPE_GEMM1);
-        succeed = tryShaderConfig(convParam, conf, progMgr, input, filter, bias, output, configs);
+        if (pass[0] == CONV_SHADER_TYPE_BASIC)
+        {
+            std::string sig = genConvSignature(convParam);
+            NN_GPU_PERF("CONV_2D: %s: %s fallback to basic shader, THIS MAY HAVE POOR PERFORMANCE !\n", __func__, sig.c_str());
+        }
+        succeed = tryRankedShaderConfig(convParam, conf, elapsedUS, progMgr, input, filter, bias, output, configs);
+        if (succeed)
+        {
+            break;
+        }
     }
 
     if (!succeed)
     {
+        // a driver bug or a shape none of the shaders handles, do not take the service down
         std::string sig = genConvSignature(convParam);
-        NN_GPU_PERF("CONV_2D: %s: %s fallback to basic shader, THIS MAY HAVE POOR PERFORMANCE !\n", __func__, sig.c_str());
-        configs = genShaderConfigCandidates(convParam, CONV_SHADER_TYPE_BASIC);
-        succeed = tryShaderConfig(convParam, conf, progMgr, input, filter, bias, output, configs);
+        LOGE("CONV_2D: %s: no config of %s verified, use the heuristic one", __func__, sig.c_str());
+        if (!heuristicConfig(convParam, conf))
+        {
+            conf = ShaderConfig(CONV_SHADER_TYPE_BASIC, 1, 1, 1, 1, 1, 1);
+        }
+        elapsedUS = std::numeric_limits<long>::max();
     }
+    return succeed;
+}
 
-    ASSERT(succeed);
-    return;
+bool storeConfig(std::string& signature, ShaderConfig& conf, long elapsedUS)
+{
+    return GlesTuningStore::update(signature, genShaderConfigString(conf), elapsedUS);
 }
 
-bool storeConfig(std::string& signature, ShaderConfig& conf)
+// a config read from the tuning store must be one tuning would pick for the signature
+// on this GPU, the file may be truncated, imported from elsewhere or of another version
+static bool isValidTunedConfig(ConvParam& convParam, const ShaderConfig& conf)
 {
-    bool ret;
-    std::stringstream ss;
+    switch (conf.shaderType)
+    {
+    case CONV_SHADER_TYPE_BASIC:
+    case CONV_SHADER_TYPE_GEMM1:
+    case CONV_SHADER_TYPE_GEMM_4_4_NO_IMG2COL:
+    case CONV_SHADER_TYPE_GEMM_4_4_GENERIC:
+    case CONV_SHADER_TYPE_GEMM_4_4_CHN3:
+    case CONV_SHADER_TYPE_GEMM_4_8_GENERIC:
+    case CONV_SHADER_TYPE_GEMM_IMPLICIT:
+    case CONV_SHADER_TYPE_GEMM_SPLIT_K:
+        break;
+    default:
+        return false;
+    }
 
-    ss << prop_prefix << signature;
-    std::string confString = genShaderConfigString(conf);
-    ret = property_set(ss.str().c_str(), confString.c_str()) == 0 ? true : false;
-    NN_GPU_PERF("CONV_2D: %s: store shader config %s: %s, %s\n",
-          __func__,
-          ret ? "succeed" : "failed",
-          ss.str().c_str(), confString.c_str());
-    return ret;
+    if (conf.localSizeX <= 0 || conf.localSizeY <= 0 || conf.localSizeZ <= 0 ||
+        conf.localSizeX > max_wg_size_x || conf.localSizeY > max_wg_size_y || conf.localSizeZ > max_wg_size_z ||
+        conf.localSizeX * conf.localSizeY * conf.localSizeZ > max_wg_invocations)
+    {
+        return false;
+    }
+
+    for (auto& c : genShaderConfigCandidates(convParam, (ConvShaderType)conf.shaderType))
+    {
+        if (c.localSizeX == conf.localSizeX && c.localSizeY == conf.localSizeY &&
+            c.localSizeZ == conf.localSizeZ && c.blockWidth == conf.blockWidth &&
+            c.blockHeight == conf.blockHeight && c.blockDepth == conf.blockDepth)
+        {
+            return true;
+        }
+    }
+    return false;
 }
 
-bool loadConfig(std::string signature, ShaderConfig& conf)
+// an invalid entry is removed from the store, so the signature is tuned again
+bool loadConfig(std::string signature, ConvParam& convParam, ShaderConfig& conf)
 {
-    bool found = false;
-    char prop[PROPERTY_VALUE_MAX];
-    std::stringstream ss;
-
-    ss << prop_prefix << signature;
-    int ret = property_get(ss.str().c_str(), prop, "0");
-    if (ret > 1)
+    std::string confString;
+    if (!GlesTuningStore::find(signature, confString))
+    {
+        return false;
+    }
+    if (!string2Config(confString.c_str(), conf) || !isValidTunedConfig(convParam, conf))
     {
-        found = true;
-        string2Config(prop, conf);
-        NN_GPU_PERF("CONV_2D: %s: %s, %s\n", __func__, ss.str().c_str(), prop);
+        LOGW("CONV_2D: %s: drop invalid tuned config %s, %s", __func__, signature.c_str(), confString.c_str());
+        GlesTuningStore::remove(signature);
+        return false;
     }
-    return found;
+    return true;
 }
 
 void prepareShaderConfig(ConvParam& convParam,
@@ -1142,60 +1467,496 @@ void prepareShaderConfig(ConvParam& convParam,
 {
     std::string sig = genConvSignature(convParam);
 
-    bool tuned = false;
-    bool found = false;
-    mtx.lock();
-    // load default configs and get gl info
-    if (!inited)
-    {
-        int configNum = 0;
-        if (sizeof(defaultConfig) > 0)
-            configNum = sizeof(defaultConfig) / sizeof(defaultConfig[0]) / 2;
-        for (int i = 0; i < configNum; i++)
+    long elapsedUS = std::numeric_limits<long>::max();
+    std::shared_ptr<std::mutex> sigLock;
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        // load default configs and get gl info
+        if (!inited)
         {
-            std::pair<std::string, std::string> entry(defaultConfig[2 * i], defaultConfig[2 * i + 1]);
-            shaderConfigMap.insert(entry);
-            NN_GPU_PERF("CONV_2D: %s: load pre-tuned config: %s, %s\n", __func__, defaultConfig[2 * i], defaultConfig[2 * i + 1]);
+            int configNum = 0;
+            if (sizeof(defaultConfig) > 0)
+                configNum = sizeof(defaultConfig) / sizeof(defaultConfig[0]) / 2;
+            for (int i = 0; i < configNum; i++)
+            {
+                std::pair<std::string, std::string> entry(defaultConfig[2 * i], defaultConfig[2 * i + 1]);
+                shaderConfigMap.insert(entry);
+                NN_GPU_PERF("CONV_2D: %s: load pre-tuned config: %s, %s\n", __func__, defaultConfig[2 * i], defaultConfig[2 * i + 1]);
+            }
+            glGetIntegeri_v(GL_MAX_COMPUTE_WORK_GROUP_COUNT, 0, &max_wg_count_x);
+            glGetIntegeri_v(GL_MAX_COMPUTE_WORK_GROUP_COUNT, 1, &max_wg_count_y);
+            glGetIntegeri_v(GL_MAX_COMPUTE_WORK_GROUP_COUNT, 2, &max_wg_count_z);
+            glGetIntegeri_v(GL_MAX_COMPUTE_WORK_GROUP_SIZE, 0, &max_wg_size_x);
+            glGetIntegeri_v(GL_MAX_COMPUTE_WORK_GROUP_SIZE, 1, &max_wg_size_y);
+            glGetIntegeri_v(GL_MAX_COMPUTE_WORK_GROUP_SIZE, 2, &max_wg_size_z);
+            glGetIntegerv(GL_MAX_COMPUTE_WORK_GROUP_INVOCATIONS, &max_wg_invocations);
+            inited = true;
+        }
+
+        // search in-memory cache
+        ShaderConfigMap::iterator it = shaderConfigMap.find(sig);
+        if (it != shaderConfigMap.end())
+        {
+            NN_GPU_PERF("CONV_2D: %s: found config %s, %s\n", __func__, sig.c_str(), it->second.c_str());
+            if (string2Config(it->second.c_str(), conf))
+            {
+                return;
+            }
+        }
+
+        std::shared_ptr<std::mutex>& l = signatureLocks[sig];
+        if (!l)
+        {
+            l = std::make_shared<std::mutex>();
+        }
+        sigLock = l;
+    }
+
+    // tuned once, a context waiting for it takes the config from the map
+    std::lock_guard<std::mutex> tuneLock(*sigLock);
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        ShaderConfigMap::iterator it = shaderConfigMap.find(sig);
+        if (it != shaderConfigMap.end() && string2Config(it->second.c_str(), conf))
+        {
+            return;
         }
-        glGetIntegeri_v(GL_MAX_COMPUTE_WORK_GROUP_COUNT, 0, &max_wg_count_x);
-        glGetIntegeri_v(GL_MAX_COMPUTE_WORK_GROUP_COUNT, 1, &max_wg_count_y);
-        glGetIntegeri_v(GL_MAX_COMPUTE_WORK_GROUP_COUNT, 2, &max_wg_count_z);
-        glGetIntegeri_v(GL_MAX_COMPUTE_WORK_GROUP_SIZE, 0, &max_wg_size_x);
-        glGetIntegeri_v(GL_MAX_COMPUTE_WORK_GROUP_SIZE, 1, &max_wg_size_y);
-        glGetIntegeri_v(GL_MAX_COMPUTE_WORK_GROUP_SIZE, 2, &max_wg_size_z);
-        glGetIntegerv(GL_MAX_COMPUTE_WORK_GROUP_INVOCATIONS, &max_wg_invocations);
-        inited = true;
-    }
-
-    // search in-memory cache
-    ShaderConfigMap::iterator it = shaderConfigMap.find(sig);
-    if (it != shaderConfigMap.end())
-    {
-        NN_GPU_PERF("CONV_2D: %s: found config %s, %s\n", __func__, sig.c_str(), it->second.c_str());
-        string2Config(it->second.c_str(), conf);
-        mtx.unlock();
-        return;
     }
 
     // load from persistent storage
-    found = loadConfig(sig, conf);
-    if (!found)
+    bool tuned = false;
+    if (!loadConfig(sig, convParam, conf))
     {
-        tune(convParam, conf, progMgr, input, filter, bias, output);
-        tuned = true;
+        tuned = tune(convParam, conf, elapsedUS, progMgr, input, filter, bias, output);
     }
 
-    std::pair<std::string, std::string> entry(sig, genShaderConfigString(conf));
-    shaderConfigMap.insert(entry);
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        std::pair<std::string, std::string> entry(sig, genShaderConfigString(conf));
+        shaderConfigMap.insert(entry);
+    }
     NN_GPU_PERF("CONV_2D: %s: cache config in memory: %s, %s\n", __func__, sig.c_str(), genShaderConfigString(conf).c_str());
 
+    // an unverified fallback is not kept for later runs
     if (tuned)
     {
-        storeConfig(sig, conf);
+        storeConfig(sig, conf, elapsedUS);
+    }
+}
+
+// select the shader config when the model is prepared, the model inputs and
+// outputs have no storage yet, so tuning runs on scratch buffers
+void GlesCsExecutor::prepareConfig(ConvParam& convParam, GlesOperationResource& resource,
+                                   GLuint inSSbo, GLuint filterSSbo, GLuint biasSSbo)
+{
+    if (resource.hasConfig)
+    {
+        // from the compilation cache
+        return;
+    }
+
+    GLuint scratchIn = 0, scratchOut = 0;
+    if (inSSbo == 0)
+    {
+        createSSBufferObject(scratchIn, INPUT_SIZE(convParam));
+        inSSbo = scratchIn;
+    }
+    createSSBufferObject(scratchOut, OUTPUT_SIZE(convParam));
+
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, inSSbo);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 1, biasSSbo);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 2, filterSSbo);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 3, scratchOut);
+
+    prepareShaderConfig(convParam, resource.config, progMgr, inSSbo, filterSSbo, biasSSbo, scratchOut);
+    resource.hasConfig = true;
+
+    glFinish();
+    if (scratchIn != 0)
+    {
+        glDeleteBuffers(1, &scratchIn);
     }
-    mtx.unlock();
+    glDeleteBuffers(1, &scratchOut);
+}
 
-    return;
+// the time of a CONV_2D over 3 channel input, with the conversion of the input
+// to 4 channels in front of it when chn4In is set
+static long timeChn3Conv(ConvParam& convParam, ShaderConfig& conf, GlesCsProgramManager& progMgr,
+                         GLuint in, GLuint chn4In, GLuint filter, GLuint bias, GLuint out)
+{
+    ConvParam param = convParam;
+    if (chn4In != 0)
+    {
+        param.inC = 4;
+    }
+
+    auto run = [&]() -> bool {
+        if (chn4In != 0)
+        {
+            if (!chn3ToChn4(convParam, progMgr, in, chn4In, INPUT_SIZE(convParam)))
+                return false;
+            glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
+        }
+        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, chn4In != 0 ? chn4In : in);
+        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 1, bias);
+        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 2, filter);
+        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 3, out);
+        bool ret = convolve(param, conf, progMgr);
+        glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
+        return ret;
+    };
+
+    long elapsedUS = std::numeric_limits<long>::max();
+    runTimed(run, TUNE_RUNS, elapsedUS, false);
+    return elapsedUS;
+}
+
+// a 3 channel CONV_2D either converts its input to 4 channels on every run and
+// uses the 4 channel shaders, or runs the 3 channel shader on the input as is,
+// tune both when the model is prepared and keep the faster one
+void GlesCsExecutor::prepareChn3Config(ConvParam& convParam, GlesOperationResource& resource,
+                                       GLuint filterSSbo, GLuint filterChn4SSbo, GLuint biasSSbo)
+{
+    if (resource.hasConfig)
+    {
+        // from the compilation cache
+        return;
+    }
+
+    ConvParam chn4Param = convParam;
+    chn4Param.inC = 4;
+
+    GLuint scratchIn = 0, scratchInChn4 = 0, scratchOut = 0;
+    createSSBufferObject(scratchIn, INPUT_SIZE(convParam));
+    createSSBufferObject(scratchInChn4, INPUT_SIZE(chn4Param));
+    createSSBufferObject(scratchOut, OUTPUT_SIZE(convParam));
+
+    ShaderConfig directConf, chn4Conf;
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, scratchIn);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 1, biasSSbo);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 2, filterSSbo);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 3, scratchOut);
+    prepareShaderConfig(convParam, directConf, progMgr, scratchIn, filterSSbo, biasSSbo, scratchOut);
+
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, scratchInChn4);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 1, biasSSbo);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 2, filterChn4SSbo);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 3, scratchOut);
+    prepareShaderConfig(chn4Param, chn4Conf, progMgr, scratchInChn4, filterChn4SSbo, biasSSbo, scratchOut);
+
+    long directUS = timeChn3Conv(convParam, directConf, progMgr, scratchIn, 0, filterSSbo, biasSSbo, scratchOut);
+    long chn4US = timeChn3Conv(convParam, chn4Conf, progMgr, scratchIn, scratchInChn4, filterChn4SSbo,
+                               biasSSbo, scratchOut);
+    NN_GPU_PERF("CONV_2D: %s: 3 channel input %ld us, converted to 4 channels %ld us\n",
+                __func__, directUS, chn4US);
+
+    resource.chn3Direct = (directUS <= chn4US);
+    resource.config = resource.chn3Direct ? directConf : chn4Conf;
+    resource.hasConfig = true;
+
+    glDeleteBuffers(1, &scratchIn);
+    glDeleteBuffers(1, &scratchInChn4);
+    glDeleteBuffers(1, &scratchOut);
+
+    if (resource.chn3Direct)
+    {
+        // nor are the 4 channel input and filter
+        for (size_t i = 0; i < resource.tmpBo.size(); ++i)
+        {
+            glDeleteBuffers(1, &resource.tmpBo[i]);
+        }
+        resource.tmpBo.clear();
+    }
+}
+
+static bool isFilterPackingEnabled()
+{
+    char prop[PROPERTY_VALUE_MAX] = "1";
+    property_get("nn.gpgpu.pack_filter", prop, "1");
+    return prop[0] != '0';
+}
+
+static GLuint createDataBuffer(const void* data, GLsizeiptr size)
+{
+    GLuint ssbo;
+    glGenBuffers(1, &ssbo);
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, ssbo);
+    glBufferData(GL_SHADER_STORAGE_BUFFER, size, data, GL_STATIC_DRAW);
+    return ssbo;
+}
+
+static bool readFilter(GLuint filterSSbo, GLintptr filterOffset, size_t count, std::vector<float>& filter)
+{
+    // the filter may have been written by a shader, e.g. converted to 4 channels
+    glMemoryBarrier(GL_BUFFER_UPDATE_BARRIER_BIT);
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, filterSSbo);
+    const float* src = (const float*)glMapBufferRange(GL_SHADER_STORAGE_BUFFER, filterOffset,
+                                                      count * sizeof(float), GL_MAP_READ_BIT);
+    if (src == nullptr)
+    {
+        LOGW("CONV_2D: failed to map the filter");
+        return false;
+    }
+    filter.assign(src, src + count);
+    glUnmapBuffer(GL_SHADER_STORAGE_BUFFER);
+    return true;
+}
+
+// the OHWI filter is a matrix of N rows by K / 4 vec4, the packed GEMM 4x8
+// shader reads its transpose, vec4 i of output channel n at i * N + n, so the
+// 8 rows of a block and the blocks of neighbouring invocations are contiguous
+static GLuint packFilter4_8(ConvParam& convParam, GLuint filterSSbo, GLintptr filterOffset)
+{
+    const int N = convParam.outC;
+    const int width0 = convParam.filterH * convParam.filterW * convParam.inC / 4;
+
+    std::vector<float> src;
+    if (!readFilter(filterSSbo, filterOffset, FILTER_SIZE(convParam), src))
+    {
+        return 0;
+    }
+
+    std::vector<float> packed(FILTER_SIZE(convParam));
+    for (int n = 0; n < N; ++n)
+    {
+        for (int i = 0; i < width0; ++i)
+        {
+            memcpy(&packed[(i * N + n) * 4], &src[(n * width0 + i) * 4], 4 * sizeof(float));
+        }
+    }
+
+    return createDataBuffer(packed.data(), packed.size() * sizeof(float));
+}
+
+// the GEMM 4x8 config runs on a packed copy of the constant filter, packed once
+// when the model is prepared or taken from the compilation cache
+void GlesCsExecutor::preparePackedFilter(ConvParam& convParam, GlesOperationResource& resource,
+                                         GLuint filterSSbo, GLintptr filterOffset)
+{
+    ShaderConfig& conf = resource.config;
+    if (!resource.hasConfig || resource.packedFilter != 0 ||
+        (conf.shaderType != CONV_SHADER_TYPE_GEMM_4_8_GENERIC &&
+         conf.shaderType != CONV_SHADER_TYPE_GEMM_4_8_PACKED))
+    {
+        return;
+    }
+
+    const GLsizeiptr size = FILTER_SIZE(convParam) * sizeof(float);
+    if (!isFilterPackingEnabled())
+    {
+        // nn.gpgpu.pack_filter=0 keeps the filter as is
+    }
+    else if (conf.shaderType == CONV_SHADER_TYPE_GEMM_4_8_PACKED && resource.filter.size() == (size_t)size)
+    {
+        // packed when the model was compiled, from the compilation cache
+        resource.packedFilter = createDataBuffer(resource.filter.data(), size);
+    }
+    else
+    {
+        resource.packedFilter = packFilter4_8(convParam, filterSSbo, filterOffset);
+    }
+    conf.shaderType = resource.packedFilter != 0 ? CONV_SHADER_TYPE_GEMM_4_8_PACKED
+                                                 : CONV_SHADER_TYPE_GEMM_4_8_GENERIC;
+}
+
+static bool isWinogradEnabled()
+{
+    char prop[PROPERTY_VALUE_MAX] = "1";
+    property_get("nn.gpgpu.winograd", prop, "1");
+    return prop[0] != '0';
+}
+
+static bool canUseWinograd(const ConvParam& convParam)
+{
+    return convParam.filterH == 3 && convParam.filterW == 3 &&
+           convParam.strideH == 1 && convParam.strideW == 1 &&
+           convParam.outC % 4 == 0;
+}
+
+// U = G g G^T of the 3x3 filter g of each input and output channel, in the
+// layout of the Winograd GEMM shader, U[xi][c][n]
+static void transformFilterWinograd(const ConvParam& convParam, const std::vector<float>& filter,
+                                    std::vector<float>& u)
+{
+    static const float G[6][3] =
+    {
+        {  1.0f / 4,   0.0f,       0.0f     },
+        { -1.0f / 6,  -1.0f / 6,  -1.0f / 6 },
+        { -1.0f / 6,   1.0f / 6,  -1.0f / 6 },
+        {  1.0f / 24,  1.0f / 12,  1.0f / 6 },
+        {  1.0f / 24, -1.0f / 12,  1.0f / 6 },
+        {  0.0f,       0.0f,       1.0f     },
+    };
+    const int C = convParam.inC;
+    const int N = convParam.outC;
+
+    u.resize(36 * C * N);
+    for (int n = 0; n < N; ++n)
+    {
+        for (int c = 0; c < C; ++c)
+        {
+            // OHWI
+            float g[3][3];
+            for (int ky = 0; ky < 3; ++ky)
+            {
+                for (int kx = 0; kx < 3; ++kx)
+                {
+                    g[ky][kx] = filter[((n * 3 + ky) * 3 + kx) * C + c];
+                }
+            }
+            float gg[6][3];
+            for (int i = 0; i < 6; ++i)
+            {
+                for (int kx = 0; kx < 3; ++kx)
+                {
+                    gg[i][kx] = G[i][0] * g[0][kx] + G[i][1] * g[1][kx] + G[i][2] * g[2][kx];
+                }
+            }
+            for (int i = 0; i < 6; ++i)
+            {
+                for (int j = 0; j < 6; ++j)
+                {
+                    u[((i * 6 + j) * C + c) * N + n] = gg[i][0] * G[j][0] + gg[i][1] * G[j][1] + gg[i][2] * G[j][2];
+                }
+            }
+        }
+    }
+}
+
+// time the Winograd GEMM configs against the tuned config on scratch input and
+// output, the best Winograd config replaces conf only if it is faster and its
+// result is right
+static bool tuneWinograd(ConvParam& convParam, ShaderConfig& conf, GlesCsProgramManager& progMgr,
+                         const std::vector<float>& filter, GLuint u, GLuint biasSSbo,
+                         GLuint tilesBo, GLuint productsBo)
+{
+    const int iter = 5;
+
+    std::vector<float> in(INPUT_SIZE(convParam));
+    for (size_t i = 0; i < in.size(); ++i)
+    {
+        in[i] = (float)((i * 7919) % 256) / 128.0f - 1.0f;
+    }
+    GLuint scratchIn = createDataBuffer(in.data(), in.size() * sizeof(float));
+    GLuint scratchFilter = createDataBuffer(filter.data(), filter.size() * sizeof(float));
+    GLuint scratchOut = 0;
+    createSSBufferObject(scratchOut, OUTPUT_SIZE(convParam));
+
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, scratchIn);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 1, biasSSbo);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 2, scratchFilter);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 3, scratchOut);
+
+    long bestUS = std::numeric_limits<long>::max();
+    convolveTimed(convParam, conf, progMgr, iter, bestUS, false);
+    NN_GPU_PERF("CONV_2D: %s: tuned config %s: %8.3f ms\n",
+                __func__, genShaderConfigString(conf).c_str(), 1.0 * bestUS / 1000);
+
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 2, u);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 4, tilesBo);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 5, productsBo);
+
+    static const int localSizes[][2] = { {4, 1}, {4, 4}, {16, 1}, {16, 4}, {64, 1} };
+    bool found = false;
+    ShaderConfig best;
+    for (auto& lsz : localSizes)
+    {
+        ShaderConfig cand(CONV_SHADER_TYPE_WINOGRAD, lsz[0], lsz[1], 1, 4, 4, 1);
+        long elapsedUS;
+        if (convolveTimed(convParam, cand, progMgr, iter, elapsedUS, false))
+        {
+            NN_GPU_PERF("CONV_2D: %s: winograd config %s: %8.3f ms\n",
+                        __func__, genShaderConfigString(cand).c_str(), 1.0 * elapsedUS / 1000);
+            if (elapsedUS < bestUS)
+            {
+                bestUS = elapsedUS;
+                best = cand;
+                found = true;
+            }
+        }
+    }
+
+    // the transforms round more than the direct sum, so check with a looser tolerance
+    if (found)
+    {
+        resetOutput(convParam, scratchOut);
+        if (verifyShader(convParam, best, progMgr, scratchIn, scratchFilter, biasSSbo, scratchOut, 0.2f))
+        {
+            conf = best;
+        }
+        else
+        {
+            found = false;
+        }
+    }
+
+    glDeleteBuffers(1, &scratchIn);
+    glDeleteBuffers(1, &scratchFilter);
+    glDeleteBuffers(1, &scratchOut);
+    return found;
+}
+
+// a 3x3 stride 1 CONV_2D may run as Winograd F(4x4, 3x3): the filter is
+// transformed once when the model is prepared, or taken transformed from the
+// compilation cache, and the scratch buffers of the transformed input tiles
+// and of the GEMM products are kept in tmpBo
+void GlesCsExecutor::prepareWinograd(ConvParam& convParam, GlesOperationResource& resource,
+                                     GLuint filterSSbo, GLintptr filterOffset, GLuint biasSSbo, bool tune)
+{
+    ShaderConfig& conf = resource.config;
+    if (!resource.hasConfig || resource.packedFilter != 0 || !canUseWinograd(convParam))
+    {
+        return;
+    }
+    const bool cached = (conf.shaderType == CONV_SHADER_TYPE_WINOGRAD);
+    if (!cached && (!tune || !isWinogradEnabled()))
+    {
+        return;
+    }
+
+    const int C = convParam.inC;
+    const int N = convParam.outC;
+    const int tiles = winogradTiles(convParam);
+    const GLsizeiptr size = 36 * C * N * sizeof(float);
+
+    GLuint u = 0;
+    std::vector<float> filter;
+    if (cached && resource.filter.size() == (size_t)size)
+    {
+        // transformed when the model was compiled, from the compilation cache
+        u = createDataBuffer(resource.filter.data(), size);
+    }
+    else if (readFilter(filterSSbo, filterOffset, FILTER_SIZE(convParam), filter))
+    {
+        std::vector<float> transformed;
+        transformFilterWinograd(convParam, filter, transformed);
+        u = createDataBuffer(transformed.data(), size);
+    }
+    else
+    {
+        if (cached)
+        {
+            // tuned again on the next run
+            resource.hasConfig = false;
+        }
+        return;
+    }
+
+    GLuint tilesBo = 0, productsBo = 0;
+    createSSBufferObject(tilesBo, 36 * tiles * C);
+    createSSBufferObject(productsBo, 36 * tiles * N);
+
+    if (!cached && !tuneWinograd(convParam, conf, progMgr, filter, u, biasSSbo, tilesBo, productsBo))
+    {
+        glDeleteBuffers(1, &u);
+        glDeleteBuffers(1, &tilesBo);
+        glDeleteBuffers(1, &productsBo);
+        return;
+    }
+
+    resource.packedFilter = u;
+    resource.tmpBo.push_back(tilesBo);
+    resource.tmpBo.push_back(productsBo);
 }
 
 // FIXME:
@@ -1261,11 +2022,10 @@ bool GlesCsExecutor::doCONV_2D(const Operation& operation, GlesOperationResource
 
     if (input.getType() == OperandType::TENSOR_FLOAT32)
     {
-        ShaderConfig shaderConf;
-        GLuint inSSbo, filterSSbo, biasSSbo, outSSbo;
-        bool needSync = false;
+        GLuint inSSbo, filterSSbo, biasSSbo;
+        bool converted = false;
 
-        if (convParam.inC == 3)
+        if (convParam.inC == 3 && !resource.chn3Direct)
         {
             GLuint imageBoChn4, filterBoChn4;
             GLuint imageBoSize, filterBoSize;
@@ -1278,7 +2038,17 @@ bool GlesCsExecutor::doCONV_2D(const Operation& operation, GlesOperationResource
                 createSSBufferObject(filterBoChn4, filterBoSize);
                 resource.tmpBo.push_back(imageBoChn4);
                 resource.tmpBo.push_back(filterBoChn4);
-                chn3ToChn4(convParam, progMgr, filter.getSSbo(), filterBoChn4, FILTER_SIZE(convParam));
+                if (resource.config.shaderType != CONV_SHADER_TYPE_GEMM_4_8_PACKED &&
+                    resource.filter.size() == filterBoSize * sizeof(float))
+                {
+                    // converted when the model was compiled, from the compilation cache
+                    glBindBuffer(GL_SHADER_STORAGE_BUFFER, filterBoChn4);
+                    glBufferSubData(GL_SHADER_STORAGE_BUFFER, 0, resource.filter.size(), resource.filter.data());
+                }
+                else
+                {
+                    chn3ToChn4(convParam, progMgr, filter.getSSbo(), filterBoChn4, FILTER_SIZE(convParam));
+                }
 
 #if 0
                 glBindBuffer(GL_SHADER_STORAGE_BUFFER, filterBoChn4);
@@ -1319,8 +2089,20 @@ bool GlesCsExecutor::doCONV_2D(const Operation& operation, GlesOperationResource
 
             imageBoChn4 = resource.tmpBo[0];
             filterBoChn4 = resource.tmpBo[1];
-            chn3ToChn4(convParam, progMgr, input.getSSbo(), imageBoChn4, INPUT_SIZE(convParam));
-            glFinish();
+            if (prepareOnly)
+            {
+                prepareChn3Config(convParam, resource, filter.getSSbo(), filterBoChn4, bias.getSSbo());
+                if (!resource.chn3Direct)
+                {
+                    ConvParam chn4Param = convParam;
+                    chn4Param.inC = 4;
+                    preparePackedFilter(chn4Param, resource, filterBoChn4, 0);
+                }
+                return true;
+            }
+            chn3ToChn4(convParam, progMgr, input.getSSbo(), imageBoChn4, INPUT_SIZE(convParam),
+                       input.getSSboOffset());
+            glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
 
 #if 0
             glBindBuffer(GL_SHADER_STORAGE_BUFFER, imageBoChn4);
@@ -1360,7 +2142,15 @@ bool GlesCsExecutor::doCONV_2D(const Operation& operation, GlesOperationResource
             inSSbo = imageBoChn4;
             filterSSbo = filterBoChn4;
             convParam.inC = 4;
-            needSync = true;
+            converted = true;
+        }
+        else if (prepareOnly)
+        {
+            const bool cached = resource.hasConfig;
+            prepareConfig(convParam, resource, 0, filter.getSSbo(), bias.getSSbo());
+            prepareWinograd(convParam, resource, filter.getSSbo(), filter.getSSboOffset(), bias.getSSbo(), !cached);
+            preparePackedFilter(convParam, resource, filter.getSSbo(), filter.getSSboOffset());
+            return true;
         }
         else
         {
@@ -1372,9 +2162,40 @@ bool GlesCsExecutor::doCONV_2D(const Operation& operation, GlesOperationResource
         bindOperand(bias,   1);
         bindOperand(output, 3);
         biasSSbo = bias.getSSbo();
-        outSSbo = output.getSSbo();
 
-        prepareShaderConfig(convParam, shaderConf, progMgr, inSSbo, filterSSbo, biasSSbo, outSSbo);
+        if (!resource.hasConfig)
+        {
+            // tuning overwrites the whole output buffer, which may be the arena of the
+            // temporaries, so tune on scratch buffers and bind the operands again
+            prepareConfig(convParam, resource, converted ? inSSbo : 0, filterSSbo, biasSSbo);
+            if (!converted)
+            {
+                prepareWinograd(convParam, resource, filterSSbo, filter.getSSboOffset(), biasSSbo, true);
+            }
+            preparePackedFilter(convParam, resource, filterSSbo, converted ? 0 : filter.getSSboOffset());
+            if (converted)
+            {
+                glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, inSSbo);
+                glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 2, filterSSbo);
+            }
+            else
+            {
+                bindOperand(input,  0);
+                bindOperand(filter, 2);
+            }
+            bindOperand(bias,   1);
+            bindOperand(output, 3);
+        }
+        if (resource.packedFilter != 0)
+        {
+            glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 2, resource.packedFilter);
+        }
+        if (resource.config.shaderType == CONV_SHADER_TYPE_WINOGRAD)
+        {
+            glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 4, resource.tmpBo[0]);
+            glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 5, resource.tmpBo[1]);
+        }
+        ShaderConfig& shaderConf = resource.config;
 
         NN_GPU_DEBUG("convParam batch %d, input_height %d, input_width %d, input_chn %d, output_height %d, output_width %d, "
                 "output_chn %d, filter_height %d, filter_width %d, stride_height %d, stride_width %d, padding_height %d, "
@@ -1384,8 +2205,6 @@ bool GlesCsExecutor::doCONV_2D(const Operation& operation, GlesOperationResource
                 convParam.padH, convParam.padW, convParam.activation, convParam.hasBias);
 
         convolve(convParam, shaderConf, progMgr);
-        if (needSync)
-            glFinish();
 
         // output.dumpToFile("out", convParam.outC);
         output.dump();
@@ -223,6 +223,16 @@ static const char gemmShader4_8_generic[] =
 "#define VEC_SIZE 4\n"
 "#define BLOCK_H 4\n"
 "#define BLOCK_W 8\n"
+"#ifdef PACKED_FILTER\n"
+"// vec4 i of the filter of output channel n at i * N + n\n"
+"#define FILTER_OFFSET(x) (x)\n"
+"#define FILTER_ROW_STRIDE 1\n"
+"#define FILTER_NEXT_K (N - BLOCK_W)\n"
+"#else\n"
+"#define FILTER_OFFSET(x) ((x) * width0)\n"
+"#define FILTER_ROW_STRIDE width0\n"
+"#define FILTER_NEXT_K (1 - BLOCK_W * width0)\n"
+"#endif\n"
 "void main()\n"
 "{\n"
 "    int gx = int(gl_GlobalInvocationID.x);\n"
@@ -237,7 +247,7 @@ static const char gemmShader4_8_generic[] =
 "        int width0 = K / VEC_SIZE;\n"
 "        int width1 = N / VEC_SIZE;\n"
 "        int src0_depth = CHANNELS / VEC_SIZE;\n"
-"        int src1_read0_offset = out_x * width0;\n"
+"        int src1_read0_offset = FILTER_OFFSET(out_x);\n"
 "        vec4 dot0 = vec4(0.f);\n"
 "        vec4 dot1 = vec4(0.f);\n"
 "        vec4 dot2 = vec4(0.f);\n"
@@ -253,15 +263,15 @@ static const char gemmShader4_8_generic[] =
 "            vec4 a1 = vec4(0.f);\n"
 "            vec4 a2 = vec4(0.f);\n"
 "            vec4 a3 = vec4(0.f);\n"
-"            vec4 brow0  = src1.data[src1_read0_offset]; src1_read0_offset += width0;\n"
-"            vec4 brow1  = src1.data[src1_read0_offset]; src1_read0_offset += width0;\n"
-"            vec4 brow2  = src1.data[src1_read0_offset]; src1_read0_offset += width0;\n"
-"            vec4 brow3  = src1.data[src1_read0_offset]; src1_read0_offset += width0;\n"
-"            vec4 brow01 = src1.data[src1_read0_offset]; src1_read0_offset += width0;\n"
-"            vec4 brow11 = src1.data[src1_read0_offset]; src1_read0_offset += width0;\n"
-"            vec4 brow21 = src1.data[src1_read0_offset]; src1_read0_offset += width0;\n"
-"            vec4 brow31 = src1.data[src1_read0_offset]; src1_read0_offset += width0;\n"
-"            src1_read0_offset += 1 - BLOCK_W * width0;\n"
+"            vec4 brow0  = src1.data[src1_read0_offset]; src1_read0_offset += FILTER_ROW_STRIDE;\n"
+"            vec4 brow1  = src1.data[src1_read0_offset]; src1_read0_offset += FILTER_ROW_STRIDE;\n"
+"            vec4 brow2  = src1.data[src1_read0_offset]; src1_read0_offset += FILTER_ROW_STRIDE;\n"
+"            vec4 brow3  = src1.data[src1_read0_offset]; src1_read0_offset += FILTER_ROW_STRIDE;\n"
+"            vec4 brow01 = src1.data[src1_read0_offset]; src1_read0_offset += FILTER_ROW_STRIDE;\n"
+"            vec4 brow11 = src1.data[src1_read0_offset]; src1_read0_offset += FILTER_ROW_STRIDE;\n"
+"            vec4 brow21 = src1.data[src1_read0_offset]; src1_read0_offset += FILTER_ROW_STRIDE;\n"
+"            vec4 brow31 = src1.data[src1_read0_offset]; src1_read0_offset += FILTER_ROW_STRIDE;\n"
+"            src1_read0_offset += FILTER_NEXT_K;\n"
 "            int dst_x = out_y % OUT_W;\n"
 "            int dst_y = out_y / OUT_W;\n"
 "            int org_y = dst_y * STRIDE_H - PAD_H;\n"
@@ -363,7 +373,7 @@ static const char gemmShader4_8_generic[] =
 "        int width0 = K / VEC_SIZE;\n"
 "        int width1 = N / VEC_SIZE;\n"
 "        int src0_depth = CHANNELS / VEC_SIZE;\n"
-"        int src1_read0_offset = out_x * width0;\n"
+"        int src1_read0_offset = FILTER_OFFSET(out_x);\n"
 "        vec4 dot0 = vec4(0.f);\n"
 "        vec4 dot01 = vec4(0.f);\n"
 "#if TAIL_M > 1\n"
@@ -384,15 +394,15 @@ static const char gemmShader4_8_generic[] =
 "#if TAIL_M > 2\n"
 "            vec4 a2 = vec4(0.f);\n"
 "#endif\n"
-"            vec4 brow0  = src1.data[src1_read0_offset]; src1_read0_offset += width0;\n"
-"            vec4 brow1  = src1.data[src1_read0_offset]; src1_read0_offset += width0;\n"
-"            vec4 brow2  = src1.data[src1_read0_offset]; src1_read0_offset += width0;\n"
-"            vec4 brow3  = src1.data[src1_read0_offset]; src1_read0_offset += width0;\n"
-"            vec4 brow01 = src1.data[src1_read0_offset]; src1_read0_offset += width0;\n"
-"            vec4 brow11 = src1.data[src1_read0_offset]; src1_read0_offset += width0;\n"
-"            vec4 brow21 = src1.data[src1_read0_offset]; src1_read0_offset += width0;\n"
-"            vec4 brow31 = src1.data[src1_read0_offset]; src1_read0_offset += width0;\n"
-"            src1_read0_offset += 1 - BLOCK_W * width0;\n"
+"            vec4 brow0  = src1.data[src1_read0_offset]; src1_read0_offset += FILTER_ROW_STRIDE;\n"
+"            vec4 brow1  = src1.data[src1_read0_offset]; src1_read0_offset += FILTER_ROW_STRIDE;\n"
+"            vec4 brow2  = src1.data[src1_read0_offset]; src1_read0_offset += FILTER_ROW_STRIDE;\n"
+"            vec4 brow3  = src1.data[src1_read0_offset]; src1_read0_offset += FILTER_ROW_STRIDE;\n"
+"            vec4 brow01 = src1.data[src1_read0_offset]; src1_read0_offset += FILTER_ROW_STRIDE;\n"
+"            vec4 brow11 = src1.data[src1_read0_offset]; src1_read0_offset += FILTER_ROW_STRIDE;\n"
+"            vec4 brow21 = src1.data[src1_read0_offset]; src1_read0_offset += FILTER_ROW_STRIDE;\n"
+"            vec4 brow31 = src1.data[src1_read0_offset]; src1_read0_offset += FILTER_ROW_STRIDE;\n"
+"            src1_read0_offset += FILTER_NEXT_K;\n"
 "            int dst_x = out_y % OUT_W;\n"
 "            int dst_y = out_y / OUT_W;\n"
 "            int org_y = dst_y * STRIDE_H - PAD_H;\n"
@@ -850,6 +860,189 @@ static const char gemmShader4_4_no_img2col[] =
 "}\n"
 ;
 
+static const char gemmShaderImplicit[] =
+"#if defined(ACTIVATION_RELU)\n"
+"#define ACTIVATION_FUNCTION(x)  clamp(x, vec4(0.0), vec4(999999999.0))\n"
+"#elif defined(ACTIVATION_RELU1)\n"
+"#define ACTIVATION_FUNCTION(x)  clamp(x, vec4(-1.0), vec4(1.0))\n"
+"#elif defined(ACTIVATION_RELU6)\n"
+"#define ACTIVATION_FUNCTION(x)  clamp(x, vec4(0.0), vec4(6.0))\n"
+"#else\n"
+"#define ACTIVATION_FUNCTION(x)  (x)\n"
+"#endif\n"
+"layout(binding = 0) readonly buffer Input0{\n"
+"    vec4 data[];\n"
+"} src0;\n"
+"layout(binding = 1) readonly buffer Input1 {\n"
+"    vec4 data[];\n"
+"} bias;\n"
+"layout(binding = 2) readonly buffer Input3{\n"
+"    vec4 data[];\n"
+"} src1;\n"
+"layout(binding = 3) writeonly buffer Output{\n"
+"    vec4 data[];\n"
+"} out0;\n"
+"layout(local_size_x = LOCAL_SZ_X, local_size_y = LOCAL_SZ_Y, local_size_z = 1) in;\n"
+"#define VEC_SIZE 4\n"
+"#define TILE_K 4\n"
+"#define TILE_M (4 * LOCAL_SZ_Y)\n"
+"#define TILE_N (4 * LOCAL_SZ_X)\n"
+"#define THREADS (LOCAL_SZ_X * LOCAL_SZ_Y)\n"
+"// the im2col rows of the work group and the filter rows of its output channels,\n"
+"// TILE_K vec4 of K at a time, each loaded once for the whole work group\n"
+"shared vec4 tile_a[TILE_M * TILE_K];\n"
+"shared vec4 tile_b[TILE_N * TILE_K];\n"
+"void main()\n"
+"{\n"
+"    int lx = int(gl_LocalInvocationID.x);\n"
+"    int ly = int(gl_LocalInvocationID.y);\n"
+"    int lid = ly * LOCAL_SZ_X + lx;\n"
+"    int gx = int(gl_GlobalInvocationID.x);\n"
+"    int gz = int(gl_GlobalInvocationID.z);\n"
+"    int tile_m0 = int(gl_WorkGroupID.y) * TILE_M;\n"
+"    int tile_n0 = int(gl_WorkGroupID.x) * TILE_N;\n"
+"    int width0 = K / VEC_SIZE;\n"
+"    int width1 = N / VEC_SIZE;\n"
+"    int src0_depth = CHANNELS / VEC_SIZE;\n"
+"    int input_batch_offset  = gz * IN_H * IN_W * src0_depth;\n"
+"    int output_batch_offset = gz * M * width1;\n"
+"    vec4 dot0 = vec4(0.f);\n"
+"    vec4 dot1 = vec4(0.f);\n"
+"    vec4 dot2 = vec4(0.f);\n"
+"    vec4 dot3 = vec4(0.f);\n"
+"    for (int k0 = 0; k0 < width0; k0 += TILE_K)\n"
+"    {\n"
+"        for (int e = lid; e < TILE_M * TILE_K; e += THREADS)\n"
+"        {\n"
+"            int row = tile_m0 + e / TILE_K;\n"
+"            int i = k0 + e % TILE_K;\n"
+"            vec4 a = vec4(0.f);\n"
+"            if (row < M && i < width0)\n"
+"            {\n"
+"                int org_y = (row / OUT_W) * STRIDE_H - PAD_H;\n"
+"                int org_x = (row % OUT_W) * STRIDE_W - PAD_W;\n"
+"                int src0_x = org_x + (i / src0_depth) % FILTER_W;\n"
+"                int src0_y = org_y + (i / src0_depth) / FILTER_W;\n"
+"                if (src0_y >= 0 && src0_y < IN_H && src0_x >= 0 && src0_x < IN_W)\n"
+"                {\n"
+"                    a = src0.data[input_batch_offset + src0_y * (IN_W * src0_depth) + src0_x * src0_depth + i % src0_depth];\n"
+"                }\n"
+"            }\n"
+"            tile_a[e] = a;\n"
+"        }\n"
+"        for (int e = lid; e < TILE_N * TILE_K; e += THREADS)\n"
+"        {\n"
+"            int n = tile_n0 + e / TILE_K;\n"
+"            int i = k0 + e % TILE_K;\n"
+"            vec4 b = vec4(0.f);\n"
+"            if (n < N && i < width0)\n"
+"            {\n"
+"                b = src1.data[n * width0 + i];\n"
+"            }\n"
+"            tile_b[e] = b;\n"
+"        }\n"
+"        barrier();\n"
+"        int a_offset = ly * 4 * TILE_K;\n"
+"        int b_offset = lx * 4 * TILE_K;\n"
+"        for (int k = 0; k < TILE_K; k++)\n"
+"        {\n"
+"            vec4 brow0 = tile_b[b_offset + k];\n"
+"            vec4 brow1 = tile_b[b_offset + TILE_K + k];\n"
+"            vec4 brow2 = tile_b[b_offset + 2 * TILE_K + k];\n"
+"            vec4 brow3 = tile_b[b_offset + 3 * TILE_K + k];\n"
+"            vec4 a0 = tile_a[a_offset + k];\n"
+"            vec4 a1 = tile_a[a_offset + TILE_K + k];\n"
+"            vec4 a2 = tile_a[a_offset + 2 * TILE_K + k];\n"
+"            vec4 a3 = tile_a[a_offset + 3 * TILE_K + k];\n"
+"            dot0 += vec4(dot(brow0, a0), dot(brow1, a0), dot(brow2, a0), dot(brow3, a0));\n"
+"            dot1 += vec4(dot(brow0, a1), dot(brow1, a1), dot(brow2, a1), dot(brow3, a1));\n"
+"            dot2 += vec4(dot(brow0, a2), dot(brow1, a2), dot(brow2, a2), dot(brow3, a2));\n"
+"            dot3 += vec4(dot(brow0, a3), dot(brow1, a3), dot(brow2, a3), dot(brow3, a3));\n"
+"        }\n"
+"        barrier();\n"
+"    }\n"
+"    int out_y = tile_m0 + ly * 4;\n"
+"    if (gx < width1)\n"
+"    {\n"
+"        vec4 bias_val = bias.data[gx];\n"
+"        if (out_y < M)\n"
+"            out0.data[output_batch_offset + (out_y + 0) * width1 + gx] = ACTIVATION_FUNCTION(dot0 + bias_val);\n"
+"        if (out_y + 1 < M)\n"
+"            out0.data[output_batch_offset + (out_y + 1) * width1 + gx] = ACTIVATION_FUNCTION(dot1 + bias_val);\n"
+"        if (out_y + 2 < M)\n"
+"            out0.data[output_batch_offset + (out_y + 2) * width1 + gx] = ACTIVATION_FUNCTION(dot2 + bias_val);\n"
+"        if (out_y + 3 < M)\n"
+"            out0.data[output_batch_offset + (out_y + 3) * width1 + gx] = ACTIVATION_FUNCTION(dot3 + bias_val);\n"
+"    }\n"
+"}\n"
+;
+
+static const char gemmShaderSplitK[] =
+"#ifdef ACTIVATION_RELU\n"
+"#define ACTIVATION_FUNCTION(x)  ((x) < 0.f ? 0.f : (x))\n"
+"#elif defined (ACTIVATION_RELU1)\n"
+"#define ACTIVATION_FUNCTION(x)  ((x) > 1.f ? 1.f : (x) < -1.f ? -1.f : (x))\n"
+"#elif defined (ACTIVATION_RELU6)\n"
+"#define ACTIVATION_FUNCTION(x)  ((x) > 6.f ? 6.f : (x) < 0.f ? 0.f : (x))\n"
+"#else\n"
+"#define ACTIVATION_FUNCTION(x)  (x)\n"
+"#endif\n"
+"layout(binding = 0) readonly buffer Input0{\n"
+"    vec4 data[];\n"
+"} src0;\n"
+"layout(binding = 1) readonly buffer Input1 {\n"
+"    float data[];\n"
+"} bias;\n"
+"layout(binding = 2) readonly buffer Input3{\n"
+"    vec4 data[];\n"
+"} src1;\n"
+"layout(binding = 3) writeonly buffer Output{\n"
+"    float data[];\n"
+"} out0;\n"
+"layout(local_size_x = LOCAL_SZ_X, local_size_y = 1, local_size_z = 1) in;\n"
+"#define VEC_SIZE 4\n"
+"// a work group computes one output element, its invocations split K and\n"
+"// reduce their partial sums in shared memory, LOCAL_SZ_X is a power of 2\n"
+"shared float partial[LOCAL_SZ_X];\n"
+"void main()\n"
+"{\n"
+"    int lid = int(gl_LocalInvocationID.x);\n"
+"    int n  = int(gl_WorkGroupID.x);\n"
+"    int gy = int(gl_WorkGroupID.y);\n"
+"    int gz = int(gl_WorkGroupID.z);\n"
+"    int width0 = K / VEC_SIZE;\n"
+"    int src0_depth = CHANNELS / VEC_SIZE;\n"
+"    int input_batch_offset = gz * IN_H * IN_W * src0_depth;\n"
+"    int org_y = (gy / OUT_W) * STRIDE_H - PAD_H;\n"
+"    int org_x = (gy % OUT_W) * STRIDE_W - PAD_W;\n"
+"    float sum = 0.0f;\n"
+"    for (int i = lid; i < width0; i += LOCAL_SZ_X)\n"
+"    {\n"
+"        int src0_x = org_x + (i / src0_depth) % FILTER_W;\n"
+"        int src0_y = org_y + (i / src0_depth) / FILTER_W;\n"
+"        if (src0_y >= 0 && src0_y < IN_H && src0_x >= 0 && src0_x < IN_W)\n"
+"        {\n"
+"            vec4 a = src0.data[input_batch_offset + src0_y * (IN_W * src0_depth) + src0_x * src0_depth + i % src0_depth];\n"
+"            sum += dot(a, src1.data[n * width0 + i]);\n"
+"        }\n"
+"    }\n"
+"    partial[lid] = sum;\n"
+"    barrier();\n"
+"    for (int stride = LOCAL_SZ_X / 2; stride > 0; stride /= 2)\n"
+"    {\n"
+"        if (lid < stride)\n"
+"        {\n"
+"            partial[lid] += partial[lid + stride];\n"
+"        }\n"
+"        barrier();\n"
+"    }\n"
+"    if (lid == 0)\n"
+"    {\n"
+"        out0.data[(gz * M + gy) * N + n] = ACTIVATION_FUNCTION(partial[0] + bias.data[n]);\n"
+"    }\n"
+"}\n"
+;
+
 static const char gemmShader1[] =
 "#ifdef ACTIVATION_RELU\n"
 "#define ACTIVATION_FUNCTION(x)  ((x) < 0.f ? 0.f : (x))\n"
@@ -955,6 +1148,207 @@ static const char convShader[] =
 "}\n"
 ;
 
+static const char winogradInputShader[] =
+"layout(binding = 0) readonly buffer Input0{\n"
+"    float data[];\n"
+"} src0;\n"
+"layout(binding = 4) writeonly buffer Output{\n"
+"    float data[];\n"
+"} out0;\n"
+"layout(local_size_x = LOCAL_SZ_X, local_size_y = LOCAL_SZ_Y, local_size_z = 1) in;\n"
+"// V = B^T d B of the 6x6 input tile d of each channel, V[xi][tile][c]\n"
+"void main()\n"
+"{\n"
+"    int c = int(gl_GlobalInvocationID.x);\n"
+"    int t = int(gl_GlobalInvocationID.y);\n"
+"    if (c >= CHANNELS || t >= TILES)\n"
+"        return;\n"
+"    int b  = t / (TILES_H * TILES_W);\n"
+"    int ty = (t / TILES_W) % TILES_H;\n"
+"    int tx = t % TILES_W;\n"
+"    int org_y = ty * 4 - PAD_H;\n"
+"    int org_x = tx * 4 - PAD_W;\n"
+"    float d[36];\n"
+"    for (int y = 0; y < 6; y++)\n"
+"    {\n"
+"        for (int x = 0; x < 6; x++)\n"
+"        {\n"
+"            int iy = org_y + y;\n"
+"            int ix = org_x + x;\n"
+"            d[y * 6 + x] = 0.0;\n"
+"            if (iy >= 0 && iy < IN_H && ix >= 0 && ix < IN_W)\n"
+"            {\n"
+"                d[y * 6 + x] = src0.data[((b * IN_H + iy) * IN_W + ix) * CHANNELS + c];\n"
+"            }\n"
+"        }\n"
+"    }\n"
+"    float bd[36];\n"
+"    for (int x = 0; x < 6; x++)\n"
+"    {\n"
+"        float d0 = d[x];\n"
+"        float d1 = d[6 + x];\n"
+"        float d2 = d[12 + x];\n"
+"        float d3 = d[18 + x];\n"
+"        float d4 = d[24 + x];\n"
+"        float d5 = d[30 + x];\n"
+"        bd[x]      = 4.0 * d0 - 5.0 * d2 + d4;\n"
+"        bd[6 + x]  = -4.0 * d1 - 4.0 * d2 + d3 + d4;\n"
+"        bd[12 + x] = 4.0 * d1 - 4.0 * d2 - d3 + d4;\n"
+"        bd[18 + x] = -2.0 * d1 - d2 + 2.0 * d3 + d4;\n"
+"        bd[24 + x] = 2.0 * d1 - d2 - 2.0 * d3 + d4;\n"
+"        bd[30 + x] = 4.0 * d1 - 5.0 * d3 + d5;\n"
+"    }\n"
+"    int offset = t * CHANNELS + c;\n"
+"    int stride = TILES * CHANNELS;\n"
+"    for (int y = 0; y < 6; y++)\n"
+"    {\n"
+"        float d0 = bd[y * 6];\n"
+"        float d1 = bd[y * 6 + 1];\n"
+"        float d2 = bd[y * 6 + 2];\n"
+"        float d3 = bd[y * 6 + 3];\n"
+"        float d4 = bd[y * 6 + 4];\n"
+"        float d5 = bd[y * 6 + 5];\n"
+"        out0.data[offset] = 4.0 * d0 - 5.0 * d2 + d4;                 offset += stride;\n"
+"        out0.data[offset] = -4.0 * d1 - 4.0 * d2 + d3 + d4;           offset += stride;\n"
+"        out0.data[offset] = 4.0 * d1 - 4.0 * d2 - d3 + d4;            offset += stride;\n"
+"        out0.data[offset] = -2.0 * d1 - d2 + 2.0 * d3 + d4;           offset += stride;\n"
+"        out0.data[offset] = 2.0 * d1 - d2 - 2.0 * d3 + d4;            offset += stride;\n"
+"        out0.data[offset] = 4.0 * d1 - 5.0 * d3 + d5;                 offset += stride;\n"
+"    }\n"
+"}\n"
+;
+
+static const char winogradGemmShader[] =
+"layout(binding = 4) readonly buffer Input0{\n"
+"    float data[];\n"
+"} src0;\n"
+"layout(binding = 2) readonly buffer Input1{\n"
+"    vec4 data[];\n"
+"} src1;\n"
+"layout(binding = 5) writeonly buffer Output{\n"
+"    vec4 data[];\n"
+"} out0;\n"
+"layout(local_size_x = LOCAL_SZ_X, local_size_y = LOCAL_SZ_Y, local_size_z = 1) in;\n"
+"// for each of the 36 xi, M[xi][tile][n] = sum over c of V[xi][tile][c] * U[xi][c][n],\n"
+"// 4 tiles by 4 output channels an invocation\n"
+"void main()\n"
+"{\n"
+"    int gx = int(gl_GlobalInvocationID.x);\n"
+"    int t  = int(gl_GlobalInvocationID.y) * 4;\n"
+"    int xi = int(gl_GlobalInvocationID.z);\n"
+"    int width1 = N / 4;\n"
+"    if (gx >= width1 || t >= TILES)\n"
+"        return;\n"
+"    int row0 = (xi * TILES + t) * CHANNELS;\n"
+"    int row1 = (xi * TILES + min(t + 1, TILES - 1)) * CHANNELS;\n"
+"    int row2 = (xi * TILES + min(t + 2, TILES - 1)) * CHANNELS;\n"
+"    int row3 = (xi * TILES + min(t + 3, TILES - 1)) * CHANNELS;\n"
+"    int src1_offset = xi * CHANNELS * width1 + gx;\n"
+"    vec4 dot0 = vec4(0.f);\n"
+"    vec4 dot1 = vec4(0.f);\n"
+"    vec4 dot2 = vec4(0.f);\n"
+"    vec4 dot3 = vec4(0.f);\n"
+"    for (int c = 0; c < CHANNELS; c++)\n"
+"    {\n"
+"        vec4 u = src1.data[src1_offset];\n"
+"        src1_offset += width1;\n"
+"        dot0 += src0.data[row0 + c] * u;\n"
+"        dot1 += src0.data[row1 + c] * u;\n"
+"        dot2 += src0.data[row2 + c] * u;\n"
+"        dot3 += src0.data[row3 + c] * u;\n"
+"    }\n"
+"    int out_offset = (xi * TILES + t) * width1 + gx;\n"
+"    out0.data[out_offset] = dot0;\n"
+"    if (t + 1 < TILES)\n"
+"        out0.data[out_offset + width1] = dot1;\n"
+"    if (t + 2 < TILES)\n"
+"        out0.data[out_offset + 2 * width1] = dot2;\n"
+"    if (t + 3 < TILES)\n"
+"        out0.data[out_offset + 3 * width1] = dot3;\n"
+"}\n"
+;
+
+static const char winogradOutputShader[] =
+"#if defined(ACTIVATION_RELU)\n"
+"#define ACTIVATION_FUNCTION(x)  clamp(x, vec4(0.0), vec4(999999999.0))\n"
+"#elif defined(ACTIVATION_RELU1)\n"
+"#define ACTIVATION_FUNCTION(x)  clamp(x, vec4(-1.0), vec4(1.0))\n"
+"#elif defined(ACTIVATION_RELU6)\n"
+"#define ACTIVATION_FUNCTION(x)  clamp(x, vec4(0.0), vec4(6.0))\n"
+"#else\n"
+"#define ACTIVATION_FUNCTION(x)  (x)\n"
+"#endif\n"
+"layout(binding = 5) readonly buffer Input0{\n"
+"    vec4 data[];\n"
+"} src0;\n"
+"layout(binding = 1) readonly buffer Input1 {\n"
+"    vec4 data[];\n"
+"} bias;\n"
+"layout(binding = 3) writeonly buffer Output{\n"
+"    vec4 data[];\n"
+"} out0;\n"
+"layout(local_size_x = LOCAL_SZ_X, local_size_y = LOCAL_SZ_Y, local_size_z = 1) in;\n"
+"// Y = A^T m A of the 36 GEMM results of each tile, 4 output channels an invocation\n"
+"void main()\n"
+"{\n"
+"    int gx = int(gl_GlobalInvocationID.x);\n"
+"    int t  = int(gl_GlobalInvocationID.y);\n"
+"    int width1 = N / 4;\n"
+"    if (gx >= width1 || t >= TILES)\n"
+"        return;\n"
+"    vec4 m[36];\n"
+"    int offset = t * width1 + gx;\n"
+"    for (int xi = 0; xi < 36; xi++)\n"
+"    {\n"
+"        m[xi] = src0.data[offset];\n"
+"        offset += TILES * width1;\n"
+"    }\n"
+"    vec4 am[24];\n"
+"    for (int x = 0; x < 6; x++)\n"
+"    {\n"
+"        vec4 m0 = m[x];\n"
+"        vec4 m1 = m[6 + x];\n"
+"        vec4 m2 = m[12 + x];\n"
+"        vec4 m3 = m[18 + x];\n"
+"        vec4 m4 = m[24 + x];\n"
+"        vec4 m5 = m[30 + x];\n"
+"        am[x]      = m0 + m1 + m2 + m3 + m4;\n"
+"        am[6 + x]  = m1 - m2 + 2.0 * m3 - 2.0 * m4;\n"
+"        am[12 + x] = m1 + m2 + 4.0 * m3 + 4.0 * m4;\n"
+"        am[18 + x] = m1 - m2 + 8.0 * m3 - 8.0 * m4 + m5;\n"
+"    }\n"
+"    int b  = t / (TILES_H * TILES_W);\n"
+"    int ty = (t / TILES_W) % TILES_H;\n"
+"    int tx = t % TILES_W;\n"
+"    vec4 bias_val = bias.data[gx];\n"
+"    for (int y = 0; y < 4; y++)\n"
+"    {\n"
+"        int oy = ty * 4 + y;\n"
+"        if (oy >= OUT_H)\n"
+"            break;\n"
+"        vec4 m0 = am[y * 6];\n"
+"        vec4 m1 = am[y * 6 + 1];\n"
+"        vec4 m2 = am[y * 6 + 2];\n"
+"        vec4 m3 = am[y * 6 + 3];\n"
+"        vec4 m4 = am[y * 6 + 4];\n"
+"        vec4 m5 = am[y * 6 + 5];\n"
+"        vec4 r[4];\n"
+"        r[0] = m0 + m1 + m2 + m3 + m4;\n"
+"        r[1] = m1 - m2 + 2.0 * m3 - 2.0 * m4;\n"
+"        r[2] = m1 + m2 + 4.0 * m3 + 4.0 * m4;\n"
+"        r[3] = m1 - m2 + 8.0 * m3 - 8.0 * m4 + m5;\n"
+"        for (int x = 0; x < 4; x++)\n"
+"        {\n"
+"            int ox = tx * 4 + x;\n"
+"            if (ox < OUT_W)\n"
+"            {\n"
+"                out0.data[((b * OUT_H + oy) * OUT_W + ox) * width1 + gx] = ACTIVATION_FUNCTION(r[x] + bias_val);\n"
+"            }\n"
+"        }\n"
+"    }\n"
+"}\n"
+;
+
 void GlesCsProgramManager::getProgNameCONV_2D(const void* progKey, std::string& name)
 {
     const GlesCsProgramKeyConv* key = reinterpret_cast<const GlesCsProgramKeyConv*>(progKey);
@@ -1027,11 +1421,30 @@ void GlesCsProgramManager::getShaderSourceCONV_2D(const void* basicKey, std::str
 
         if (key->shaderType == CONV_SHADER_TYPE_GEMM_4_4_NO_IMG2COL ||
             key->shaderType == CONV_SHADER_TYPE_GEMM_4_4_GENERIC ||
-            key->shaderType == CONV_SHADER_TYPE_GEMM_4_8_GENERIC)
+            key->shaderType == CONV_SHADER_TYPE_GEMM_4_8_GENERIC ||
+            key->shaderType == CONV_SHADER_TYPE_GEMM_4_8_PACKED)
         {
             ss << "#define TAIL_M " << M % 4 << "\n";
         }
 
+        if (key->shaderType == CONV_SHADER_TYPE_GEMM_4_8_PACKED)
+        {
+            ss << "#define PACKED_FILTER\n";
+        }
+
+        if (key->shaderType == CONV_SHADER_TYPE_WINOGRAD_INPUT ||
+            key->shaderType == CONV_SHADER_TYPE_WINOGRAD ||
+            key->shaderType == CONV_SHADER_TYPE_WINOGRAD_OUTPUT)
+        {
+            // F(4x4, 3x3), a 6x6 input tile for each 4x4 output tile
+            int tilesH = (key->convParam.outH + 3) / 4;
+            int tilesW = (key->convParam.outW + 3) / 4;
+            ss << "#define OUT_H " << key->convParam.outH << "\n";
+            ss << "#define TILES_H " << tilesH << "\n";
+            ss << "#define TILES_W " << tilesW << "\n";
+            ss << "#define TILES " << key->convParam.batch * tilesH * tilesW << "\n";
+        }
+
         switch (key->convParam.activation)
         {
             case kRelu6:
@@ -1065,6 +1478,7 @@ void GlesCsProgramManager::getShaderSourceCONV_2D(const void* basicKey, std::str
             ss << gemmShader4_4_generic;
             break;
         case CONV_SHADER_TYPE_GEMM_4_8_GENERIC:
+        case CONV_SHADER_TYPE_GEMM_4_8_PACKED:
             ss << gemmShader4_8_generic;
             break;
         case CONV_SHADER_TYPE_GEMM_4_4_CHN3:
@@ -1073,6 +1487,21 @@ void GlesCsProgramManager::getShaderSourceCONV_2D(const void* basicKey, std::str
         case CONV_SHADER_TYPE_CHN3_TO_CHN4:
             ss << toChn4;
             break;
+        case CONV_SHADER_TYPE_WINOGRAD_INPUT:
+            ss << winogradInputShader;
+            break;
+        case CONV_SHADER_TYPE_WINOGRAD:
+            ss << winogradGemmShader;
+            break;
+        case CONV_SHADER_TYPE_WINOGRAD_OUTPUT:
+            ss << winogradOutputShader;
+            break;
+        case CONV_SHADER_TYPE_GEMM_IMPLICIT:
+            ss << gemmShaderImplicit;
+            break;
+        case CONV_SHADER_TYPE_GEMM_SPLIT_K:
+            ss << gemmShaderSplitK;
+            break;
         default:
             NOT_REACH_HERE;
             break;
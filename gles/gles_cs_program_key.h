@@ -16,6 +16,17 @@ enum ConvShaderType
     CONV_SHADER_TYPE_GEMM_4_4_CHN3,
     CONV_SHADER_TYPE_GEMM_4_8_GENERIC,
     CONV_SHADER_TYPE_CHN3_TO_CHN4,
+    // GEMM_4_8_GENERIC on a filter packed when the model is prepared
+    CONV_SHADER_TYPE_GEMM_4_8_PACKED,
+    // Winograd F(4x4, 3x3): the GEMM over the transformed tiles, the type of the
+    // config, and the input and output transforms in front of and behind it
+    CONV_SHADER_TYPE_WINOGRAD,
+    CONV_SHADER_TYPE_WINOGRAD_INPUT,
+    CONV_SHADER_TYPE_WINOGRAD_OUTPUT,
+    // GEMM 4x4 on im2col and filter tiles shared by the work group
+    CONV_SHADER_TYPE_GEMM_IMPLICIT,
+    // one output element a work group, K split across its invocations
+    CONV_SHADER_TYPE_GEMM_SPLIT_K,
     CONV_SHADER_TYPE_NUM
 };
 
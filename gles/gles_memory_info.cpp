@@ -1,4 +1,3 @@
-#include <sys/mman.h>
 #include "gles_memory_info.h"
 
 NAME_SPACE_BEGIN
@@ -28,7 +27,7 @@ void GlesMemoryInfo::dump()
     glBindBuffer(GL_SHADER_STORAGE_BUFFER, ssbo);
 
     // only dump first 16 float numbers
-    const float* p = (float*)glMapBufferRange(GL_SHADER_STORAGE_BUFFER, 0, 16, GL_MAP_READ_BIT);
+    const float* p = (float*)glMapBufferRange(GL_SHADER_STORAGE_BUFFER, offset, 16, GL_MAP_READ_BIT);
     for (size_t i = 0; i < 15; ++i)
     {
         NN_GPU_DEBUG("dumpped out buffer content: %f, %f, %f, %f, %f, %f, %f, %f, %f, %f, %f, %f, %f, %f, %f, %f",
@@ -56,7 +55,7 @@ void GlesMemoryInfo::dumpToFile(const char* fileName, const int channels)
     glBindBuffer(GL_SHADER_STORAGE_BUFFER, ssbo);
 
     const size_t f_len = length / 4;
-    const float* fp = (float*)glMapBufferRange(GL_SHADER_STORAGE_BUFFER, 0, f_len, GL_MAP_READ_BIT);
+    const float* fp = (float*)glMapBufferRange(GL_SHADER_STORAGE_BUFFER, offset, length, GL_MAP_READ_BIT);
     int cur_c = 1;
 
     NN_GPU_DEBUG("%s: dumpped file length is %zu", __func__, f_len);
@@ -75,48 +74,6 @@ void GlesMemoryInfo::dumpToFile(const char* fileName, const int channels)
     glUnmapBuffer(GL_SHADER_STORAGE_BUFFER);
 }
 
-bool GlesMemoryInfo::sync(std::string name)
-{
-    if (needSync)
-    {
-        ASSERT(ssbo != 0);
-    }
-
-    if (name == "mmap_fd")
-    {
-        if (needSync)
-        {
-            glBindBuffer(GL_SHADER_STORAGE_BUFFER, ssbo);
-            uint8_t* p = (uint8_t*)glMapBufferRange(GL_SHADER_STORAGE_BUFFER, 0, length, GL_MAP_READ_BIT);
-            for (size_t i = 0; i < length; ++i)
-            {
-                userptr[i] = p[i];
-            }
-            glUnmapBuffer(GL_SHADER_STORAGE_BUFFER);
-            msync(userptr, length, MS_SYNC);
-        }
-    }
-    else if (name == "ashmem")
-    {
-        if (needSync)
-        {
-            glBindBuffer(GL_SHADER_STORAGE_BUFFER, ssbo);
-            uint8_t* p = (uint8_t*)glMapBufferRange(GL_SHADER_STORAGE_BUFFER, 0, length, GL_MAP_READ_BIT);
-            for (size_t i = 0; i < length; ++i)
-            {
-                userptr[i] = p[i];
-            }
-            glUnmapBuffer(GL_SHADER_STORAGE_BUFFER);
-        }
-    }
-    else
-    {
-        NOT_IMPLEMENTED;
-    }
-
-    return true;
-}
-
 GLuint GlesMemoryInfo::getSSbo()
 {
     if (ssbo == 0)
@@ -33,11 +33,11 @@ class GlesMemoryInfo
 {
 public:
     GlesMemoryInfo(uint8_t* us, size_t le) :
-                ssbo(0), texture(0), userptr(us), length(le), inUsing(true), refCount(1), needSync(false)
+                ssbo(0), texture(0), userptr(us), length(le), offset(0), inUsing(true), refCount(1), needSync(false)
                 { UNUSED(texture); }
     ~GlesMemoryInfo() {}
     GLuint getSSbo();
-    bool sync(std::string name);
+    GLintptr getOffset() const { return offset; }
     void clean();
     void setNeedSync() { needSync = true; }
     void setNotInUsing();
@@ -45,16 +45,18 @@ public:
     void dumpToFile(const char* fileName = "img_data", const int channels = 0);
     void incRef() { refCount++; }
     void resetRef() { refCount = 0;}
-    void shareFrom(GlesMemoryInfo* from) { ssbo = from->ssbo; from->incRef();}
+    void shareFrom(GlesMemoryInfo* from) { ssbo = from->ssbo; offset = from->offset; from->incRef();}
 private:
     GLuint ssbo;
     GLuint texture;
     uint8_t* userptr;
     size_t length;
+    GLintptr offset;                //in the ssbo, non zero for the planned temporaries
     bool inUsing;
     uint32_t refCount;
     bool needSync;
     friend class GlesMemoryManager;
+    friend class GlesPoolInfo;
 };
 
 NAME_SPACE_STOP
@@ -1,5 +1,7 @@
 #include <sys/mman.h>
+#include <map>
 #include "gles_memory_manager.h"
+#include "host_copy.h"
 
 NAME_SPACE_BEGIN
 
@@ -47,12 +49,59 @@ GlesMemoryInfo* GlesMemoryManager::createIntermediumMemoryInfo(uint8_t* userptr,
     return createMemoryInfo(intermediumMemInfos, userptr, length);
 }
 
+GlesMemoryInfo* GlesMemoryManager::getPlannedMemoryInfo(uint32_t operandIndex, size_t length)
+{
+    if (operandIndex >= plannedMemInfos.size() ||
+        planner.getOffset(operandIndex) == MemoryPlanner::kNotPlanned ||
+        length > planner.getSize(operandIndex))
+    {
+        return nullptr;
+    }
+
+    GlesMemoryInfo& info = plannedMemInfos[operandIndex];
+    info.inUsing = true;
+    info.refCount = 1;
+    return &info;
+}
+
+void GlesMemoryManager::planIntermediums(const Model& model)
+{
+    if (!MemoryPlanner::isEnabled())
+    {
+        return;
+    }
+
+    GLint alignment = 1;
+    glGetIntegerv(GL_SHADER_STORAGE_BUFFER_OFFSET_ALIGNMENT, &alignment);
+    planner.plan(model, alignment);
+    if (planner.getArenaSize() == 0)
+    {
+        return;
+    }
+
+    glGenBuffers(1, &arena);
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, arena);
+    glBufferData(GL_SHADER_STORAGE_BUFFER, planner.getArenaSize(), NULL, GL_STATIC_DRAW);
+
+    plannedMemInfos.reserve(model.operands.size());
+    for (size_t i = 0; i < model.operands.size(); i++)
+    {
+        GlesMemoryInfo info(nullptr, planner.getSize(i));
+        if (planner.getOffset(i) != MemoryPlanner::kNotPlanned)
+        {
+            info.ssbo = arena;
+            info.offset = planner.getOffset(i);
+        }
+        plannedMemInfos.push_back(info);
+    }
+}
+
 bool GlesMemoryManager::initFromModel(const Model& model)
 {
     modelPoolInfos.resize(model.pools.size());
     for (size_t i = 0; i < model.pools.size(); i++)
     {
-        if (!modelPoolInfos[i].set(model.pools[i]))
+        if (!modelPoolInfos[i].set(model.pools[i], poolCache))
         {
             LOGE("Could not map pool");
             return false;
@@ -63,6 +112,9 @@ bool GlesMemoryManager::initFromModel(const Model& model)
     modelMemInfos.reserve(model.operands.size());
     requestMemInfos.reserve(model.operands.size());
     intermediumMemInfos.reserve(model.operands.size());
+
+    // needs the context current, for the gl limits and the arena
+    planIntermediums(model);
     return true;
 }
 
@@ -76,7 +128,7 @@ bool GlesMemoryManager::resetFromRequest(const Request& request)
     requestPoolInfos.resize(request.pools.size());
     for (size_t i = 0; i < request.pools.size(); i++)
     {
-        if (!requestPoolInfos[i].set(request.pools[i]))
+        if (!requestPoolInfos[i].set(request.pools[i], poolCache))
         {
             LOGE("Could not map pool");
             return false;
@@ -87,6 +139,10 @@ bool GlesMemoryManager::resetFromRequest(const Request& request)
     {
         mem.resetRef();
     }
+    for (auto& mem : plannedMemInfos)
+    {
+        mem.resetRef();
+    }
 
     return true;
 }
@@ -95,9 +151,64 @@ bool GlesMemoryManager::sync()
 {
     // should we try for modelPoolInfos?
 
+    std::vector<GlesMemoryInfo*> outputs;
     for (size_t i = 0; i < requestPoolInfos.size(); i++)
     {
-        requestPoolInfos[i].sync();
+        requestPoolInfos[i].getSyncMemInfos(outputs);
+    }
+
+    // a buffer is mapped once at a time, outputs sharing one (the arena) are
+    // read through a single mapping of the range covering all of them
+    std::map<GLuint, std::pair<GLintptr, GLintptr>> ranges;
+    for (auto mem : outputs)
+    {
+        GLintptr end = mem->offset + mem->length;
+        auto it = ranges.find(mem->ssbo);
+        if (it == ranges.end())
+        {
+            ranges[mem->ssbo] = std::make_pair(mem->offset, end);
+        }
+        else
+        {
+            it->second.first = std::min(it->second.first, mem->offset);
+            it->second.second = std::max(it->second.second, end);
+        }
+    }
+
+    std::map<GLuint, const uint8_t*> mapped;
+    for (auto& range : ranges)
+    {
+        glBindBuffer(GL_SHADER_STORAGE_BUFFER, range.first);
+        mapped[range.first] = (const uint8_t*)glMapBufferRange(GL_SHADER_STORAGE_BUFFER, range.second.first,
+                                                              range.second.second - range.second.first,
+                                                              GL_MAP_READ_BIT);
+    }
+
+    std::vector<HostCopy> copies;
+    for (auto mem : outputs)
+    {
+        const uint8_t* p = mapped[mem->ssbo];
+        if (p == nullptr)
+        {
+            LOGE("failed to map the output buffer %u", mem->ssbo);
+            continue;
+        }
+        copies.push_back({mem->userptr, p + (mem->offset - ranges[mem->ssbo].first), mem->length});
+    }
+    HostCopier::run(copies);
+
+    for (auto& range : ranges)
+    {
+        if (mapped[range.first] != nullptr)
+        {
+            glBindBuffer(GL_SHADER_STORAGE_BUFFER, range.first);
+            glUnmapBuffer(GL_SHADER_STORAGE_BUFFER);
+        }
+    }
+
+    for (size_t i = 0; i < requestPoolInfos.size(); i++)
+    {
+        requestPoolInfos[i].commit();
     }
     return true;
 }
@@ -114,11 +225,21 @@ void GlesMemoryManager::clean()
 {
     cleanPoolInfos(modelPoolInfos);
     cleanPoolInfos(requestPoolInfos);
+    poolCache.clear();
 
     for (auto& mem : intermediumMemInfos)
     {
         mem.clean();
     }
+
+    // the planned infos only refer to the arena
+    plannedMemInfos.clear();
+    if (arena != 0)
+    {
+        glDeleteBuffers(1, &arena);
+        arena = 0;
+    }
+    planner.clear();
 }
 
 NAME_SPACE_STOP
\ No newline at end of file
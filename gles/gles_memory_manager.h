@@ -28,19 +28,22 @@
 #include "base_executor.h"
 #include "gles_pool_info.h"
 #include "gles_memory_info.h"
+#include "memory_planner.h"
 
 NAME_SPACE_BEGIN
 
 class GlesMemoryManager
 {
 public:
-    GlesMemoryManager() {}
+    GlesMemoryManager() : arena(0) {}
     ~GlesMemoryManager() {}
 
     bool initFromModel(const Model& model);
     bool resetFromRequest(const Request& request);
     bool sync();
     void clean();
+    // drops the cached mapping of a pool the client freed
+    void invalidatePool(const hidl_memory& pool) { poolCache.invalidate(pool); }
 
     GlesPoolInfo* getModelPoolInfo(size_t index)
     {
@@ -58,16 +61,28 @@ public:
 
     GlesMemoryInfo* createIntermediumMemoryInfo(size_t length);
     GlesMemoryInfo* createIntermediumMemoryInfo(uint8_t* userptr, size_t length);
+    // the range of a temporary operand in the arena, nullptr if it is not planned
+    GlesMemoryInfo* getPlannedMemoryInfo(uint32_t operandIndex, size_t length);
+    // the plan of the temporaries for the compilation cache, loadPlan is called before initFromModel
+    void savePlan(CacheWriter& writer) const { planner.save(writer); }
+    bool loadPlan(CacheReader& reader, const Model& model) { return planner.load(reader, model); }
 
 private:
     std::vector<GlesPoolInfo> modelPoolInfos;
     std::vector<GlesMemoryInfo> modelMemInfos;
 
     std::vector<GlesPoolInfo> requestPoolInfos;
+    PoolMappingCache poolCache;
     std::vector<GlesMemoryInfo> requestMemInfos;
 
     std::vector<GlesMemoryInfo> intermediumMemInfos;
 
+    // the temporary operands of the model, placed in one ssbo by the planner
+    MemoryPlanner planner;
+    GLuint arena;
+    std::vector<GlesMemoryInfo> plannedMemInfos;
+
+    void planIntermediums(const Model& model);
     void cleanPoolInfos(std::vector<GlesPoolInfo>& poolInfos) const;
     GlesMemoryInfo* createMemoryInfo(std::vector<GlesMemoryInfo>& memInfos, uint8_t* userptr, size_t length) const;
 };
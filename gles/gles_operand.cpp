@@ -158,7 +158,11 @@ GLuint GlesOperand::getSSbo()
     {
         if (lifetime == OperandLifeTime::TEMPORARY_VARIABLE)
         {
-            memInfo = memMgr.createIntermediumMemoryInfo(length);
+            memInfo = memMgr.getPlannedMemoryInfo(operandIndex, length);
+            if (memInfo == nullptr)
+            {
+                memInfo = memMgr.createIntermediumMemoryInfo(length);
+            }
         }
         else
         {
@@ -170,6 +174,12 @@ GLuint GlesOperand::getSSbo()
     return memInfo->getSSbo();
 }
 
+GLintptr GlesOperand::getSSboOffset()
+{
+    getSSbo();
+    return memInfo->getOffset();
+}
+
 void GlesOperand::shareGpuStorage(GlesOperand& from)
 {
     // assure the storage allocation of from
@@ -197,7 +207,7 @@ void GlesOperand::retrieveData()
         GLuint ssbo = memInfo->getSSbo();
         ASSERT(ssbo != 0);
         glBindBuffer(GL_SHADER_STORAGE_BUFFER, ssbo);
-        uint8_t* p = (uint8_t*)glMapBufferRange(GL_SHADER_STORAGE_BUFFER, 0, length, GL_MAP_READ_BIT);
+        uint8_t* p = (uint8_t*)glMapBufferRange(GL_SHADER_STORAGE_BUFFER, memInfo->getOffset(), length, GL_MAP_READ_BIT);
         UNUSED(p);
         glUnmapBuffer(GL_SHADER_STORAGE_BUFFER);
     }
@@ -26,6 +26,9 @@ public:
     void restore(const Operand& from);
     bool setArg(const RequestArgument& from);
     GLuint getSSbo();
+    // where the operand starts in the ssbo of getSSbo
+    GLintptr getSSboOffset();
+    size_t size() const { return length; }
 
     GLuint getTexture();
     void shareGpuStorage(GlesOperand& shareFrom);
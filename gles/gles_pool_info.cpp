@@ -7,11 +7,6 @@ NAME_SPACE_BEGIN
 bool GlesPoolInfo::clean()
 {
     ASSERT(userptr != nullptr);
-    if (name == "mmap_fd")
-    {
-        munmap(userptr, size);
-    }
-    userptr = nullptr;
 
     for (auto& mem : memInfos)
     {
@@ -19,76 +14,74 @@ bool GlesPoolInfo::clean()
     }
     memInfos.clear();
 
+    // unmapped here unless the cache keeps it for the next request
+    mapping.reset();
+    userptr = nullptr;
+
     return true;
 }
 
-bool GlesPoolInfo::sync()
+void GlesPoolInfo::getSyncMemInfos(std::vector<GlesMemoryInfo*>& outputs) const
 {
     if (name == "mmap_fd")
     {
         int prot = hidlMemory.handle()->data[1];
-        if (prot & PROT_WRITE)
+        if (!(prot & PROT_WRITE))
         {
-            for (auto& mem : memInfos)
-            {
-                mem->sync(name);
-            }
+            return;
         }
     }
-    else if (name == "ashmem")
-    {
-        for (auto& mem : memInfos)
-        {
-            mem->sync(name);
-        }
-        memory->commit();
-    }
-    else
+    else if (name != "ashmem")
     {
         NOT_IMPLEMENTED;
+        return;
     }
 
-    return true;
+    for (auto& mem : memInfos)
+    {
+        if (mem->needSync)
+        {
+            ASSERT(mem->ssbo != 0);
+            outputs.push_back(mem);
+        }
+    }
 }
 
-bool GlesPoolInfo::set(const hidl_memory& hidlMemory)
+bool GlesPoolInfo::commit()
 {
-    this->hidlMemory = hidlMemory;
-    name = hidlMemory.name();
     if (name == "mmap_fd")
     {
-        size = hidlMemory.size();
-        int fd = hidlMemory.handle()->data[0];
         int prot = hidlMemory.handle()->data[1];
-        size_t offset = getSizeFromInts(hidlMemory.handle()->data[2],
-                                        hidlMemory.handle()->data[3]);
-        userptr = static_cast<uint8_t*>(mmap(nullptr, size, prot, MAP_SHARED, fd, offset));
-        if (userptr == MAP_FAILED)
+        if (prot & PROT_WRITE)
         {
-            LOGE("Can't mmap the file descriptor.");
-            return false;
+            // once for the whole pool instead of once per output
+            msync(userptr, size, MS_SYNC);
         }
-        return true;
     }
     else if (name == "ashmem")
     {
-        memory = mapMemory(hidlMemory);
-        if (memory == nullptr) {
-            LOGE("Can't map shared memory.");
-            return false;
-        }
-        memory->update();
-        userptr = reinterpret_cast<uint8_t*>(static_cast<void*>(memory->getPointer()));
-        if (userptr == nullptr) {
-            LOGE("Can't access shared memory.");
-            return false;
-        }
-        return true;
+        mapping->memory->commit();
     }
     else
     {
         NOT_IMPLEMENTED;
     }
+
+    return true;
+}
+
+bool GlesPoolInfo::set(const hidl_memory& hidlMemory, PoolMappingCache& cache)
+{
+    this->hidlMemory = hidlMemory;
+    name = hidlMemory.name();
+    mapping = cache.get(hidlMemory);
+    if (mapping == nullptr)
+    {
+        return false;
+    }
+    userptr = mapping->userptr;
+    size = mapping->size;
+    return true;
 }
 
 NAME_SPACE_STOP
@@ -26,6 +26,7 @@
 #include <GLES3/gl32.h>
 
 #include "base_executor.h"
+#include "pool_mapping_cache.h"
 
 NAME_SPACE_BEGIN
 
@@ -35,13 +36,15 @@ class GlesPoolInfo {
 public:
     GlesPoolInfo() : userptr(nullptr), size(0) {}
     ~GlesPoolInfo() {}
-    bool set(const hidl_memory& hidlMemory);
-    bool sync();
+    bool set(const hidl_memory& hidlMemory, PoolMappingCache& cache);
+    // the outputs to copy back into the pool, commit after they are copied
+    void getSyncMemInfos(std::vector<GlesMemoryInfo*>& outputs) const;
+    bool commit();
     bool clean();
     void addMemInfo(GlesMemoryInfo* memInfo) { memInfos.push_back(memInfo); }
     uint8_t* getUserptr() { return userptr; }
 private:
-    sp<IMemory> memory;
+    std::shared_ptr<PoolMapping> mapping;
     hidl_memory hidlMemory;
     std::string name;
     uint8_t* userptr;
@@ -0,0 +1,206 @@
+#include <stdio.h>
+#include <unistd.h>
+#include <vector>
+#include <cutils/properties.h>
+#include "gles_tuning_store.h"
+#include "compilation_cache.h"
+
+NAME_SPACE_BEGIN
+
+#define TUNING_STORE_MAGIC 0x53454c47    // "GLES"
+#define TUNING_STORE_VERSION 2
+#define DEFAULT_TUNING_STORE_PATH "/data/gles_tuning_store.bin"
+
+GlesTuningStore::EntryMap GlesTuningStore::entries;
+std::string GlesTuningStore::path;
+std::string GlesTuningStore::renderer;
+std::mutex GlesTuningStore::mtx;
+
+void GlesTuningStore::merge(EntryMap& map, const std::string& key, const Entry& entry)
+{
+    auto it = map.find(key);
+    if (it == map.end() || entry.time_us < it->second.time_us)
+    {
+        map[key] = entry;
+    }
+}
+
+// magic, version and count, then the key, config and time of each entry
+bool GlesTuningStore::read(const std::string& file, EntryMap& map)
+{
+    FILE* file_ptr = fopen(file.c_str(), "rb");
+    if (file_ptr == nullptr)
+    {
+        NN_GPU_DEBUG("tuning store file %s does not exist", file.c_str());
+        return false;
+    }
+
+    std::vector<uint8_t> data;
+    bool ret = false;
+    if (fseek(file_ptr, 0, SEEK_END) == 0)
+    {
+        long size = ftell(file_ptr);
+        if (size > 0 && fseek(file_ptr, 0, SEEK_SET) == 0)
+        {
+            data.resize(size);
+            ret = (fread(data.data(), 1, size, file_ptr) == (size_t)size);
+        }
+    }
+    fclose(file_ptr);
+
+    CacheReader reader(data);
+    uint32_t magic = 0, version = 0, count = 0;
+    if (!ret || !reader.read(magic) || !reader.read(version) || !reader.read(count) ||
+        magic != TUNING_STORE_MAGIC || version != TUNING_STORE_VERSION)
+    {
+        LOGW("tuning store file %s is invalid or of another version, ignore it", file.c_str());
+        return false;
+    }
+
+    EntryMap loaded;
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        std::string key;
+        Entry entry;
+        if (!reader.readArray(key) || !reader.readArray(entry.config) || !reader.read(entry.time_us))
+        {
+            LOGW("tuning store file %s is truncated, ignore it", file.c_str());
+            return false;
+        }
+        merge(loaded, key, entry);
+    }
+
+    for (auto& it : loaded)
+    {
+        merge(map, it.first, it.second);
+    }
+    return true;
+}
+
+bool GlesTuningStore::write(const std::string& file, const EntryMap& map)
+{
+    std::vector<uint8_t> data;
+    CacheWriter writer(data);
+    writer.write<uint32_t>(TUNING_STORE_MAGIC);
+    writer.write<uint32_t>(TUNING_STORE_VERSION);
+    writer.write<uint32_t>(map.size());
+    for (auto& it : map)
+    {
+        writer.writeArray(it.first);
+        writer.writeArray(it.second.config);
+        writer.write(it.second.time_us);
+    }
+
+    // write to a temporary file and rename, so other processes never read a partial file
+    std::string tmp = file + "." + std::to_string(getpid()) + ".tmp";
+    FILE* file_ptr = fopen(tmp.c_str(), "wb");
+    if (file_ptr == nullptr)
+    {
+        LOGW("failed to create tuning store file %s", tmp.c_str());
+        return false;
+    }
+    bool ret = (fwrite(data.data(), 1, data.size(), file_ptr) == data.size());
+    ret = (fclose(file_ptr) == 0) && ret;
+
+    if (!ret || rename(tmp.c_str(), file.c_str()) != 0)
+    {
+        LOGW("failed to store tuning store file %s", file.c_str());
+        remove(tmp.c_str());
+        return false;
+    }
+    return true;
+}
+
+void GlesTuningStore::init(const std::string& glVersion)
+{
+    std::lock_guard<std::mutex> lock(mtx);
+
+    char prop[PROPERTY_VALUE_MAX] = DEFAULT_TUNING_STORE_PATH;
+    property_get("nn.gpgpu.gles_tuning_store", prop, DEFAULT_TUNING_STORE_PATH);
+    path = prop;
+    renderer = glVersion;
+
+    entries.clear();
+    read(path, entries);
+    NN_GPU_DEBUG("tuning store %s, %zu entries loaded", path.c_str(), entries.size());
+
+    if (property_get("nn.gpgpu.gles_tuning_import", prop, "") > 0)
+    {
+        const size_t before = entries.size();
+        if (read(prop, entries))
+        {
+            write(path, entries);
+            NN_GPU_DEBUG("tuning store: imported %s, %zu entries added", prop, entries.size() - before);
+        }
+    }
+}
+
+void GlesTuningStore::deinit()
+{
+    char prop[PROPERTY_VALUE_MAX] = "";
+    if (property_get("nn.gpgpu.gles_tuning_export", prop, "") > 0)
+    {
+        exportFile(prop);
+    }
+}
+
+bool GlesTuningStore::find(const std::string& signature, std::string& config)
+{
+    std::lock_guard<std::mutex> lock(mtx);
+
+    auto it = entries.find(renderer + "|" + signature);
+    if (it == entries.end())
+    {
+        return false;
+    }
+    config = it->second.config;
+    NN_GPU_PERF("CONV_2D: %s: %s, %s, tuned %lld us\n",
+                __func__, signature.c_str(), config.c_str(), (long long)it->second.time_us);
+    return true;
+}
+
+bool GlesTuningStore::update(const std::string& signature, const std::string& config, long time_us)
+{
+    std::lock_guard<std::mutex> lock(mtx);
+
+    // other processes may have stored entries since the file was loaded
+    read(path, entries);
+
+    Entry entry;
+    entry.config = config;
+    entry.time_us = time_us;
+    merge(entries, renderer + "|" + signature, entry);
+
+    bool ret = write(path, entries);
+    NN_GPU_PERF("CONV_2D: %s: store shader config %s: %s, %s, %ld us\n",
+                __func__, ret ? "succeed" : "failed", signature.c_str(), config.c_str(), time_us);
+    return ret;
+}
+
+bool GlesTuningStore::remove(const std::string& signature)
+{
+    std::lock_guard<std::mutex> lock(mtx);
+
+    // also drop it from the file, update would otherwise merge it back
+    read(path, entries);
+    entries.erase(renderer + "|" + signature);
+
+    bool ret = write(path, entries);
+    NN_GPU_PERF("CONV_2D: %s: remove shader config %s: %s\n",
+                __func__, ret ? "succeed" : "failed", signature.c_str());
+    return ret;
+}
+
+bool GlesTuningStore::importFile(const std::string& file)
+{
+    std::lock_guard<std::mutex> lock(mtx);
+    return read(file, entries) && write(path, entries);
+}
+
+bool GlesTuningStore::exportFile(const std::string& file)
+{
+    std::lock_guard<std::mutex> lock(mtx);
+    return write(file, entries);
+}
+
+NAME_SPACE_STOP
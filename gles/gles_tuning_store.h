@@ -0,0 +1,73 @@
+/*
+ * Copyright @2017 Intel Corporation
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef ANDROID_HARDWARE_NEURALNETWORKS_V1_2_GLES_TUNING_STORE_H
+#define ANDROID_HARDWARE_NEURALNETWORKS_V1_2_GLES_TUNING_STORE_H
+
+#include <map>
+#include <mutex>
+#include <string>
+#include "hal_types.h"
+
+NAME_SPACE_BEGIN
+
+// Process wide store of the tuned conv configs in a binary file in the data
+// directory of the service (nn.gpgpu.gles_tuning_store), loaded at once when
+// the process starts. Entries are keyed by the GL renderer and version and the
+// conv signature, and keep the time measured when they were tuned, so several
+// GPUs and drivers can share a file.
+//
+// nn.gpgpu.gles_tuning_import names a file of pre-tuned entries merged in when
+// the process starts, nn.gpgpu.gles_tuning_export one the store is written to
+// when the process ends, both in the format of the store.
+class GlesTuningStore
+{
+public:
+    static void init(const std::string& glVersion);
+    static void deinit();
+
+    static bool find(const std::string& signature, std::string& config);
+    // the entry is only replaced by a faster config
+    static bool update(const std::string& signature, const std::string& config, long time_us);
+    // drops an entry the backend cannot run, so the signature is tuned again
+    static bool remove(const std::string& signature);
+
+    // merge the entries of a file in, keeping the faster config of a key
+    static bool importFile(const std::string& file);
+    static bool exportFile(const std::string& file);
+
+private:
+    struct Entry
+    {
+        std::string config;
+        int64_t time_us;
+    };
+    using EntryMap = std::map<std::string, Entry>;
+
+    static bool read(const std::string& file, EntryMap& map);
+    static bool write(const std::string& file, const EntryMap& map);
+    static void merge(EntryMap& map, const std::string& key, const Entry& entry);
+
+    static EntryMap entries;
+    static std::string path;
+    static std::string renderer;
+    static std::mutex mtx;
+};
+
+NAME_SPACE_STOP
+
+#endif
@@ -2,4 +2,53 @@
 
 NAME_SPACE_BEGIN
 
-NAME_SPACE_STOP
\ No newline at end of file
+bool GpuExecutor::canPrepare(const Operation& operation) const
+{
+    // scalar parameters must be known and every tensor shape fully specified
+    for (uint32_t i : operation.inputs)
+    {
+        const Operand& operand = model.operands[i];
+        if (operand.type == OperandType::FLOAT32 ||
+            operand.type == OperandType::INT32 ||
+            operand.type == OperandType::UINT32)
+        {
+            if (operand.lifetime != OperandLifeTime::CONSTANT_COPY)
+            {
+                return false;
+            }
+            continue;
+        }
+
+        if (operand.dimensions.size() == 0)
+        {
+            return false;
+        }
+        for (uint32_t dim : operand.dimensions)
+        {
+            if (dim == 0)
+            {
+                return false;
+            }
+        }
+    }
+
+    for (uint32_t i : operation.outputs)
+    {
+        const Operand& operand = model.operands[i];
+        if (operand.dimensions.size() == 0)
+        {
+            return false;
+        }
+        for (uint32_t dim : operand.dimensions)
+        {
+            if (dim == 0)
+            {
+                return false;
+            }
+        }
+    }
+
+    return true;
+}
+
+NAME_SPACE_STOP
@@ -33,6 +33,11 @@ class GpuExecutor : public BaseExecutor
 public:
     GpuExecutor(const Model& model) : BaseExecutor(model) {}
     ~GpuExecutor() override {}
+
+protected:
+    // whether the operation can be set up before any request, i.e. its
+    // scalar parameters are constants and its tensor shapes are known
+    bool canPrepare(const Operation& operation) const;
 };
 
 NAME_SPACE_STOP
@@ -0,0 +1,72 @@
+#include <stdlib.h>
+#include <string.h>
+#include <thread>
+#include <cutils/properties.h>
+#include "host_copy.h"
+
+NAME_SPACE_BEGIN
+
+static const size_t kParallelMinSize = 2 << 20;
+static const size_t kChunkSize = 512 << 10;
+
+static size_t getThreadNum()
+{
+    char prop[PROPERTY_VALUE_MAX];
+    property_get("nn.gpgpu.sync_threads", prop, "4");
+    int num = atoi(prop);
+    size_t cores = std::max(std::thread::hardware_concurrency(), 1u);
+    return std::min<size_t>(num > 0 ? num : 1, cores);
+}
+
+void HostCopier::run(const std::vector<HostCopy>& copies)
+{
+    size_t total = 0;
+    for (auto& copy : copies)
+    {
+        total += copy.size;
+    }
+
+    static const size_t threadNum = getThreadNum();
+    if (total < kParallelMinSize || threadNum < 2)
+    {
+        for (auto& copy : copies)
+        {
+            memcpy(copy.dst, copy.src, copy.size);
+        }
+        return;
+    }
+
+    std::vector<HostCopy> chunks;
+    for (auto& copy : copies)
+    {
+        for (size_t done = 0; done < copy.size; done += kChunkSize)
+        {
+            size_t size = std::min(kChunkSize, copy.size - done);
+            chunks.push_back({static_cast<uint8_t*>(copy.dst) + done,
+                              static_cast<const uint8_t*>(copy.src) + done, size});
+        }
+    }
+
+    // thread i copies chunks i, i + n, i + 2n ..., the calling thread is one of them
+    const size_t n = std::min(threadNum, chunks.size());
+    auto work = [&chunks, n](size_t first) {
+        for (size_t i = first; i < chunks.size(); i += n)
+        {
+            memcpy(chunks[i].dst, chunks[i].src, chunks[i].size);
+        }
+    };
+
+    std::vector<std::thread> threads;
+    for (size_t i = 1; i < n; ++i)
+    {
+        threads.push_back(std::thread(work, i));
+    }
+    work(0);
+    for (auto& t : threads)
+    {
+        t.join();
+    }
+    NN_GPU_PERF("synced %zu bytes of %zu outputs on %zu threads", total, copies.size(), n);
+}
+
+NAME_SPACE_STOP
@@ -0,0 +1,28 @@
+#ifndef ANDROID_HARDWARE_NEURALNETWORKS_V1_2_HOST_COPY_H
+#define ANDROID_HARDWARE_NEURALNETWORKS_V1_2_HOST_COPY_H
+
+#include <vector>
+#include "base_executor.h"
+
+NAME_SPACE_BEGIN
+
+struct HostCopy
+{
+    void* dst;
+    const void* src;
+    size_t size;
+};
+
+// Copies the outputs of a request from mapped GPU memory into its pools.
+// Small copies are plain memcpys on the calling thread, when the outputs add
+// up to several MB they are cut into chunks copied by up to nn.gpgpu.sync_threads
+// threads (default 4), a single thread does not saturate the memory bandwidth.
+class HostCopier
+{
+public:
+    static void run(const std::vector<HostCopy>& copies);
+};
+
+NAME_SPACE_STOP
+
+#endif
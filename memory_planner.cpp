@@ -0,0 +1,262 @@
+#include <algorithm>
+#include <cutils/properties.h>
+#include "memory_planner.h"
+#include "base_executor.h"
+#include "compilation_cache.h"
+
+NAME_SPACE_BEGIN
+
+static size_t getTemporarySize(const Operand& operand)
+{
+    size_t size;
+    switch (operand.type)
+    {
+        case OperandType::TENSOR_FLOAT32:
+        case OperandType::TENSOR_INT32:
+            size = 4;
+            break;
+        case OperandType::TENSOR_QUANT8_ASYMM:
+            size = 1;
+            break;
+        default:
+            // left to the executor
+            return 0;
+    }
+
+    if (operand.dimensions.size() == 0)
+    {
+        return 0;
+    }
+    for (auto dim : operand.dimensions)
+    {
+        // 0 for a dimension known only when the model runs
+        size *= dim;
+    }
+    return size;
+}
+
+bool MemoryPlanner::isEnabled()
+{
+    char prop[PROPERTY_VALUE_MAX] = "1";
+    property_get("nn.gpgpu.mem_plan", prop, "1");
+    return prop[0] != '0';
+}
+
+void MemoryPlanner::clear()
+{
+    offsets.clear();
+    sizes.clear();
+    arenaSize = 0;
+    naiveSize = 0;
+    planAlignment = 0;
+    loaded = false;
+}
+
+void MemoryPlanner::save(CacheWriter& writer) const
+{
+    writer.write<uint64_t>(planAlignment);
+    writer.write<uint64_t>(arenaSize);
+    writer.write<uint64_t>(naiveSize);
+    writer.writeArray(offsets);
+    writer.writeArray(sizes);
+}
+
+bool MemoryPlanner::load(CacheReader& reader, const Model& model)
+{
+    clear();
+
+    uint64_t align = 0, arena = 0, naive = 0;
+    if (!reader.read(align) || !reader.read(arena) || !reader.read(naive) ||
+        !reader.readArray(offsets) || !reader.readArray(sizes) ||
+        offsets.size() != sizes.size())
+    {
+        clear();
+        return false;
+    }
+    planAlignment = align;
+    arenaSize = arena;
+    naiveSize = naive;
+
+    if (offsets.empty())
+    {
+        // planned without nn.gpgpu.mem_plan or with no temporaries, plan it when used
+        clear();
+        return true;
+    }
+
+    // a temporary gets the range it would be planned into
+    bool ok = (offsets.size() == model.operands.size() && planAlignment > 0);
+    for (size_t i = 0; ok && i < offsets.size(); ++i)
+    {
+        if (offsets[i] == kNotPlanned)
+        {
+            continue;
+        }
+        ok = model.operands[i].lifetime == OperandLifeTime::TEMPORARY_VARIABLE &&
+             sizes[i] == getTemporarySize(model.operands[i]) && sizes[i] > 0 &&
+             offsets[i] % planAlignment == 0 && offsets[i] <= arenaSize &&
+             ALIGN(sizes[i], planAlignment) <= arenaSize - offsets[i];
+    }
+    if (!ok)
+    {
+        clear();
+        return false;
+    }
+
+    loaded = true;
+    return true;
+}
+
+void MemoryPlanner::plan(const Model& model, size_t alignment)
+{
+    if (alignment == 0)
+    {
+        alignment = 1;
+    }
+    if (loaded && planAlignment == alignment && offsets.size() == model.operands.size())
+    {
+        NN_GPU_PERF("memory planner: the plan of the compilation cache, an arena of %zu bytes, %zu bytes with a buffer each",
+                    arenaSize, naiveSize);
+        return;
+    }
+
+    clear();
+    planAlignment = alignment;
+
+    const size_t numOperands = model.operands.size();
+    const size_t numOperations = model.operations.size();
+
+    offsets.resize(numOperands, kNotPlanned);
+    sizes.resize(numOperands, 0);
+
+    // live interval [first, last] in operation indexes, and the temporary
+    // whose storage an operand shares (itself unless it is a RESHAPE output)
+    std::vector<size_t> first(numOperands, numOperations);
+    std::vector<size_t> last(numOperands, 0);
+    std::vector<uint32_t> root(numOperands);
+    for (size_t i = 0; i < numOperands; ++i)
+    {
+        root[i] = i;
+        if (model.operands[i].lifetime == OperandLifeTime::TEMPORARY_VARIABLE)
+        {
+            sizes[i] = getTemporarySize(model.operands[i]);
+        }
+    }
+
+    auto isPlanned = [&](uint32_t index) {
+        return model.operands[index].lifetime == OperandLifeTime::TEMPORARY_VARIABLE && sizes[index] > 0;
+    };
+
+    for (size_t i = 0; i < numOperations; ++i)
+    {
+        const Operation& operation = model.operations[i];
+        for (uint32_t index : operation.inputs)
+        {
+            uint32_t r = root[index];
+            last[r] = std::max(last[r], i);
+        }
+        for (uint32_t index : operation.outputs)
+        {
+            first[index] = std::min(first[index], i);
+            last[index] = std::max(last[index], i);
+        }
+
+        if (operation.type == OperationType::RESHAPE && operation.inputs.size() > 0 &&
+            operation.outputs.size() == 1)
+        {
+            uint32_t in = root[operation.inputs[0]];
+            uint32_t out = operation.outputs[0];
+            if (!isPlanned(in))
+            {
+                continue;
+            }
+            if (model.operands[out].lifetime == OperandLifeTime::MODEL_OUTPUT)
+            {
+                // read back when the request is done
+                last[in] = numOperations;
+            }
+            else if (isPlanned(out) && sizes[out] <= sizes[in])
+            {
+                root[out] = in;
+            }
+        }
+    }
+
+    // placed largest first, ties in model order
+    std::vector<uint32_t> order;
+    for (size_t i = 0; i < numOperands; ++i)
+    {
+        if (isPlanned(i) && root[i] == i)
+        {
+            if (first[i] == numOperations)
+            {
+                // never written, e.g. the operation producing it was removed
+                first[i] = 0;
+            }
+            last[i] = std::max(last[i], first[i]);
+            order.push_back(i);
+        }
+    }
+    std::stable_sort(order.begin(), order.end(), [this](uint32_t a, uint32_t b) {
+        return sizes[a] > sizes[b];
+    });
+
+    std::vector<uint32_t> placed;
+    for (uint32_t index : order)
+    {
+        const size_t size = ALIGN(sizes[index], alignment);
+
+        // the ranges already taken while this temporary is alive, by offset
+        std::vector<uint32_t> overlaps;
+        for (uint32_t other : placed)
+        {
+            if (first[other] <= last[index] && first[index] <= last[other])
+            {
+                overlaps.push_back(other);
+            }
+        }
+        std::sort(overlaps.begin(), overlaps.end(), [this](uint32_t a, uint32_t b) {
+            return offsets[a] < offsets[b];
+        });
+
+        // the smallest gap it fits in, or the end of the overlapping ranges
+        size_t offset = 0;
+        size_t bestOffset = kNotPlanned;
+        size_t bestGap = kNotPlanned;
+        for (uint32_t other : overlaps)
+        {
+            if (offsets[other] > offset)
+            {
+                size_t gap = offsets[other] - offset;
+                if (gap >= size && gap < bestGap)
+                {
+                    bestGap = gap;
+                    bestOffset = offset;
+                }
+            }
+            offset = std::max(offset, offsets[other] + ALIGN(sizes[other], alignment));
+        }
+        if (bestOffset == kNotPlanned)
+        {
+            bestOffset = offset;
+        }
+
+        offsets[index] = bestOffset;
+        placed.push_back(index);
+        arenaSize = std::max(arenaSize, bestOffset + size);
+        naiveSize += sizes[index];
+    }
+
+    for (size_t i = 0; i < numOperands; ++i)
+    {
+        if (root[i] != i)
+        {
+            offsets[i] = offsets[root[i]];
+        }
+    }
+
+    NN_GPU_PERF("memory planner: %zu temporaries in an arena of %zu bytes, %zu bytes with a buffer each",
+                order.size(), arenaSize, naiveSize);
+}
+
+NAME_SPACE_STOP
@@ -0,0 +1,67 @@
+#ifndef ANDROID_HARDWARE_NEURALNETWORKS_V1_2_MEMORY_PLANNER_H
+#define ANDROID_HARDWARE_NEURALNETWORKS_V1_2_MEMORY_PLANNER_H
+
+#include <vector>
+#include "hal_types.h"
+
+NAME_SPACE_BEGIN
+
+class CacheWriter;
+class CacheReader;
+
+// Static placement of the temporary operands of a model in one arena.
+//
+// The live interval of a temporary runs from the operation writing it to the
+// last operation reading it (the operations run in model order), temporaries
+// whose intervals overlap get disjoint ranges of the arena. They are placed
+// greedily, the largest first, each into the lowest gap left by the placed
+// temporaries it overlaps with.
+//
+// RESHAPE does not copy, its output shares the storage of its input, so the
+// two are planned as one temporary which lives until the output is dead.
+class MemoryPlanner
+{
+public:
+    static const size_t kNotPlanned = SIZE_MAX;
+
+    MemoryPlanner() : arenaSize(0), naiveSize(0), planAlignment(0), loaded(false) {}
+
+    // nn.gpgpu.mem_plan=0 gives every temporary a buffer of its own again
+    static bool isEnabled();
+
+    // alignment is the one of the buffer offsets bound to the shaders, a plan
+    // loaded from the compilation cache for the same alignment is kept
+    void plan(const Model& model, size_t alignment);
+    void clear();
+
+    // the plan is kept in the compilation cache, so a model loaded from it and
+    // the other execution contexts of a model do not plan again
+    void save(CacheWriter& writer) const;
+    bool load(CacheReader& reader, const Model& model);
+
+    // kNotPlanned for operands without a place in the arena, e.g. whose shape is unknown
+    size_t getOffset(uint32_t operandIndex) const
+    {
+        return operandIndex < offsets.size() ? offsets[operandIndex] : kNotPlanned;
+    }
+    size_t getSize(uint32_t operandIndex) const
+    {
+        return operandIndex < sizes.size() ? sizes[operandIndex] : 0;
+    }
+
+    // the peak memory of the temporaries, and what they take with a buffer each
+    size_t getArenaSize() const { return arenaSize; }
+    size_t getNaiveSize() const { return naiveSize; }
+
+private:
+    std::vector<size_t> offsets;
+    std::vector<size_t> sizes;
+    size_t arenaSize;
+    size_t naiveSize;
+    size_t planAlignment;
+    bool loaded;
+};
+
+NAME_SPACE_STOP
+
+#endif
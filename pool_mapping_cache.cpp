@@ -0,0 +1,155 @@
+#include <stdlib.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <cutils/properties.h>
+#include "pool_mapping_cache.h"
+
+NAME_SPACE_BEGIN
+
+#define DEFAULT_POOL_CACHE_SIZE 8
+
+PoolMapping::~PoolMapping()
+{
+    gpuObject.reset();
+    if (name == "mmap_fd" && userptr != nullptr)
+    {
+        munmap(userptr, size);
+    }
+}
+
+bool PoolMapping::map(const hidl_memory& hidlMemory)
+{
+    name = hidlMemory.name();
+    size = hidlMemory.size();
+    if (name == "mmap_fd")
+    {
+        int fd = hidlMemory.handle()->data[0];
+        int prot = hidlMemory.handle()->data[1];
+        size_t offset = getSizeFromInts(hidlMemory.handle()->data[2],
+                                        hidlMemory.handle()->data[3]);
+        void* ptr = mmap(nullptr, size, prot, MAP_SHARED, fd, offset);
+        if (ptr == MAP_FAILED)
+        {
+            LOGE("Can't mmap the file descriptor.");
+            return false;
+        }
+        userptr = static_cast<uint8_t*>(ptr);
+        return true;
+    }
+    else if (name == "ashmem")
+    {
+        memory = mapMemory(hidlMemory);
+        if (memory == nullptr) {
+            LOGE("Can't map shared memory.");
+            return false;
+        }
+        userptr = reinterpret_cast<uint8_t*>(static_cast<void*>(memory->getPointer()));
+        if (userptr == nullptr) {
+            LOGE("Can't access shared memory.");
+            return false;
+        }
+        return true;
+    }
+    else
+    {
+        NOT_IMPLEMENTED;
+        return false;
+    }
+}
+
+PoolMappingCache::PoolMappingCache()
+{
+    char prop[PROPERTY_VALUE_MAX];
+    property_get("nn.gpgpu.pool_cache", prop, "");
+    capacity = prop[0] ? atoi(prop) : DEFAULT_POOL_CACHE_SIZE;
+}
+
+bool PoolMappingCache::getKey(const hidl_memory& hidlMemory, Key& key)
+{
+    const native_handle_t* handle = hidlMemory.handle();
+    if (handle == nullptr || handle->numFds < 1 || hidlMemory.name() != "mmap_fd")
+    {
+        return false;
+    }
+
+    struct stat st;
+    if (fstat(handle->data[0], &st) != 0)
+    {
+        return false;
+    }
+
+    int prot = handle->data[1];
+    size_t offset = getSizeFromInts(handle->data[2], handle->data[3]);
+    key = Key(hidlMemory.name(), st.st_dev, st.st_ino, offset, hidlMemory.size(), prot);
+    return true;
+}
+
+std::shared_ptr<PoolMapping> PoolMappingCache::get(const hidl_memory& hidlMemory)
+{
+    Key key;
+    bool cacheable = capacity > 0 && getKey(hidlMemory, key);
+    std::lock_guard<std::mutex> lock(mtx);
+    if (cacheable)
+    {
+        auto it = entries.find(key);
+        if (it != entries.end())
+        {
+            lru.splice(lru.begin(), lru, it->second);
+            std::shared_ptr<PoolMapping> mapping = lru.front().second;
+            if (mapping->memory != nullptr)
+            {
+                mapping->memory->update();
+            }
+            return mapping;
+        }
+    }
+
+    std::shared_ptr<PoolMapping> mapping = std::make_shared<PoolMapping>();
+    if (!mapping->map(hidlMemory))
+    {
+        return nullptr;
+    }
+    if (mapping->memory != nullptr)
+    {
+        mapping->memory->update();
+    }
+    if (!cacheable)
+    {
+        return mapping;
+    }
+
+    lru.push_front(std::make_pair(key, mapping));
+    entries[key] = lru.begin();
+    while (lru.size() > capacity)
+    {
+        // still mapped while a pool info uses it
+        entries.erase(lru.back().first);
+        lru.pop_back();
+    }
+    return mapping;
+}
+
+void PoolMappingCache::invalidate(const hidl_memory& hidlMemory)
+{
+    Key key;
+    if (!getKey(hidlMemory, key))
+    {
+        return;
+    }
+    std::lock_guard<std::mutex> lock(mtx);
+    auto it = entries.find(key);
+    if (it != entries.end())
+    {
+        lru.erase(it->second);
+        entries.erase(it);
+    }
+}
+
+void PoolMappingCache::clear()
+{
+    std::lock_guard<std::mutex> lock(mtx);
+    entries.clear();
+    lru.clear();
+}
+
+NAME_SPACE_STOP
@@ -0,0 +1,69 @@
+#ifndef ANDROID_HARDWARE_NEURALNETWORKS_V1_2_POOL_MAPPING_CACHE_H
+#define ANDROID_HARDWARE_NEURALNETWORKS_V1_2_POOL_MAPPING_CACHE_H
+
+#include <list>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <tuple>
+#include "base_executor.h"
+
+NAME_SPACE_BEGIN
+
+// the host mapping of one hidl_memory pool, unmapped when the last user drops it
+class PoolMapping
+{
+public:
+    PoolMapping() : userptr(nullptr), size(0), gpuObjectTried(false) {}
+    ~PoolMapping();
+
+    bool map(const hidl_memory& hidlMemory);
+
+    std::string name;
+    sp<IMemory> memory;     // ashmem
+    uint8_t* userptr;
+    size_t size;
+
+    // made from the mapping by the backend once, e.g. the imported Vulkan
+    // buffer of the pool, released before the pool is unmapped
+    std::shared_ptr<void> gpuObject;
+    bool gpuObjectTried;
+};
+
+// Mappings of the request pools kept across executions, clients pass the same
+// few pools frame after frame. A pool is identified by the file behind its fd
+// (device and inode, an fd number may be reused for another file), the offset,
+// size and protection of the mapping, so an execution costs one fstat per pool
+// instead of an mmap and munmap. The least recently used mappings beyond
+// nn.gpgpu.pool_cache (default 8, 0 disables the cache) are dropped.
+//
+// ashmem pools are mapped per request: their fds all refer to the /dev/ashmem
+// node, so two regions of the same size cannot be told apart by the file.
+class PoolMappingCache
+{
+public:
+    PoolMappingCache();
+
+    // nullptr if the pool cannot be mapped
+    std::shared_ptr<PoolMapping> get(const hidl_memory& hidlMemory);
+    // the client freed the pool, e.g. a burst slot, may be called from any thread
+    void invalidate(const hidl_memory& hidlMemory);
+    void clear();
+
+private:
+    typedef std::tuple<std::string, dev_t, ino_t, size_t, size_t, int> Key;
+    typedef std::list<std::pair<Key, std::shared_ptr<PoolMapping>>> LruList;
+
+    static bool getKey(const hidl_memory& hidlMemory, Key& key);
+
+    size_t capacity;
+    // get runs on the thread of the execution context, invalidate on the one
+    // of the burst which freed the pool
+    std::mutex mtx;
+    LruList lru;            // the most recently used first
+    std::map<Key, LruList::iterator> entries;
+};
+
+NAME_SPACE_STOP
+
+#endif
@@ -3,10 +3,14 @@
 #include <string.h>
 
 #include <hidl/LegacySupport.h>
+#include <future>
+#include <map>
 #include <thread>
+#include <cutils/properties.h>
 
 #include "prepare_model.h"
 #include "executor_manager.h"
+#include "ExecutionBurstServer.h"
 #include "ValidateHal.h"
 
 NAME_SPACE_BEGIN
@@ -20,30 +24,122 @@ auto now()
     return std::chrono::steady_clock::now();
 };
 
+// timing of a successful execution, timeInDriver runs until now
+static Timing getTiming(MeasureTiming measure, const time_point& driverStart, uint64_t timeOnDevice)
+{
+    if (measure != MeasureTiming::YES)
+    {
+        return kNoTiming;
+    }
+
+    uint64_t timeInDriver = std::chrono::duration_cast<std::chrono::microseconds>(now() - driverStart).count();
+    // GPU and CPU clocks are apart, the device time is part of the driver time though
+    if (timeOnDevice != UINT64_MAX && timeOnDevice > timeInDriver)
+    {
+        timeOnDevice = timeInDriver;
+    }
+    return {.timeOnDevice = timeOnDevice, .timeInDriver = timeInDriver};
+}
+
+static const uint32_t kMaxExecContexts = 8;
+
+// every execution context holds its own copy of the model constants on the
+// GPU, so more than one is only worth it when requests of a model overlap
+static uint32_t getNumExecContexts()
+{
+    char prop[PROPERTY_VALUE_MAX] = "1";
+    property_get("nn.gpgpu.exec_contexts", prop, "1");
+    int num = atoi(prop);
+    return std::min<uint32_t>(std::max(num, 1), kMaxExecContexts);
+}
+
 PreparedModel::PreparedModel(const Model& model)
       : // Make a copy of the model, as we need to preserve it.
         mModel(model)
 {
     NN_GPU_CALL();
-    exec = ExecutorManager::createExecutor(mModel);
+    execs.push_back(ExecutorManager::createExecutor(mModel));
 }
 
 bool PreparedModel::initialize()
 {
     NN_GPU_CALL();
-    return exec->initPerModel();
+    if (!execs[0]->initPerModel())
+    {
+        return false;
+    }
+
+    // the other contexts take the compiled plan of the first one instead of tuning again
+    std::vector<uint8_t> plan, data;
+    if (getNumExecContexts() > 1 && !execs[0]->saveCache(plan, data))
+    {
+        LOGW("the executor has no plan to share, run the model with one execution context");
+        plan.clear();
+    }
+    createExecContexts(plan, data);
+    return true;
+}
+
+bool PreparedModel::initializeFromCache(const std::vector<uint8_t>& plan, const std::vector<uint8_t>& data)
+{
+    NN_GPU_CALL();
+    if (!execs[0]->loadCache(plan, data))
+    {
+        LOGW("compilation cache is not accepted by the executor");
+        return false;
+    }
+    if (!execs[0]->initPerModel())
+    {
+        return false;
+    }
+    createExecContexts(plan, data);
+    return true;
+}
+
+void PreparedModel::createExecContexts(const std::vector<uint8_t>& plan, const std::vector<uint8_t>& data)
+{
+    NN_GPU_CALL();
+
+    const uint32_t num = plan.empty() ? 1 : getNumExecContexts();
+    for (uint32_t i = 1; i < num; ++i)
+    {
+        sp<BaseExecutor> e = ExecutorManager::createExecutor(mModel);
+        if (!e->loadCache(plan, data))
+        {
+            break;
+        }
+        if (!e->initPerModel())
+        {
+            LOGW("failed to create execution context %u, run the model with %zu", i, execs.size());
+            e->deinitPerModel();
+            break;
+        }
+        execs.push_back(e);
+    }
+    NN_GPU_DEBUG("%zu execution contexts for the model", execs.size());
+
+    workers.reset(new ExecutionWorkerPool(execs));
+}
+
+bool PreparedModel::saveToCache(const hidl_vec<hidl_handle>& modelCache,
+                                const hidl_vec<hidl_handle>& dataCache,
+                                const HidlToken& token)
+{
+    NN_GPU_CALL();
+    return CompilationCache::save(mModel, execs[0].get(), modelCache, dataCache, token);
 }
 
 void PreparedModel::asyncExecute_1_2(const Request& request,
-                                     const sp<V1_2::IExecutionCallback>& callback)
+                                     const sp<V1_2::IExecutionCallback>& callback,
+                                     MeasureTiming measure, const time_point& driverStart,
+                                     BaseExecutor& exec, bool ready)
 {
     NN_GPU_CALL();
-    exec->initPerExecThread();
-    bool succ = exec->run(request);
-    exec->deinitPerExecThread();
+    uint64_t timeOnDevice = UINT64_MAX;
+    bool succ = ready && exec.run(request, measure, timeOnDevice);
     if (succ)
     {
-        callback->notify_1_2(ErrorStatus::NONE, {}, kNoTiming);
+        callback->notify_1_2(ErrorStatus::NONE, {}, getTiming(measure, driverStart, timeOnDevice));
     }
     else
     {
@@ -52,13 +148,13 @@ void PreparedModel::asyncExecute_1_2(const Request& request,
 }
 
 void PreparedModel::asyncExecute(const Request& request,
-                                 const sp<V1_0::IExecutionCallback>& callback)
+                                 const sp<V1_0::IExecutionCallback>& callback,
+                                 BaseExecutor& exec, bool ready)
 {
     NN_GPU_CALL();
 
-    exec->initPerExecThread();
-    bool succ = exec->run(request);
-    exec->deinitPerExecThread();
+    uint64_t timeOnDevice = UINT64_MAX;
+    bool succ = ready && exec.run(request, MeasureTiming::NO, timeOnDevice);
 
     if (succ)
     {
@@ -87,7 +183,9 @@ Return<ErrorStatus> PreparedModel::execute(const Request& request,
         return ErrorStatus::INVALID_ARGUMENT;
     }
 
-    execThreads.push_back(std::thread([this, request, callback]{ asyncExecute(request, callback); }));
+    workers->submit([this, request, callback](BaseExecutor& exec, bool ready) {
+        asyncExecute(request, callback, exec, ready);
+    });
 
     return ErrorStatus::NONE;
 }
@@ -116,11 +214,33 @@ Return<ErrorStatus> PreparedModel::execute_1_2(const Request& request,
         return ErrorStatus::INVALID_ARGUMENT;
     }
 
-    execThreads.push_back(std::thread([this, request, callback]{ asyncExecute(request, callback); }));
+    workers->submit([this, request, callback, measure, driverStart](BaseExecutor& exec, bool ready) {
+        asyncExecute_1_2(request, callback, measure, driverStart, exec, ready);
+    });
 
     return ErrorStatus::NONE;
 }
 
+bool PreparedModel::executeOnWorker(const Request& request, MeasureTiming measure, uint64_t& timeOnDevice)
+{
+    NN_GPU_CALL();
+
+    std::promise<bool> result;
+    std::future<bool> done = result.get_future();
+    workers->submit([&request, &result, measure, &timeOnDevice](BaseExecutor& exec, bool ready) {
+        result.set_value(ready && exec.run(request, measure, timeOnDevice));
+    });
+    return done.get();
+}
+
+void PreparedModel::invalidatePool(const hidl_memory& pool)
+{
+    for (auto& exec : execs)
+    {
+        exec->invalidatePool(pool);
+    }
+}
+
 Return<void> PreparedModel::executeSynchronously(const Request& request,
                                                  MeasureTiming measure,
                                                  executeSynchronously_cb cb)
@@ -139,13 +259,12 @@ Return<void> PreparedModel::executeSynchronously(const Request& request,
         return Void();
     }
 
-    exec->initPerExecThread();
-    bool succ = exec->run(request);
-    exec->deinitPerExecThread();
+    uint64_t timeOnDevice = UINT64_MAX;
+    bool succ = executeOnWorker(request, measure, timeOnDevice);
 
     if (succ)
     {
-        cb(ErrorStatus::NONE, {}, kNoTiming);
+        cb(ErrorStatus::NONE, {}, getTiming(measure, driverStart, timeOnDevice));
     }
     else
     {
@@ -155,6 +274,81 @@ Return<void> PreparedModel::executeSynchronously(const Request& request,
     return Void();
 }
 
+// Executes the requests of a burst. The request pools are not sent through the
+// FMQ, only their slot identifiers, the memories behind the slots are cached here
+// until the client frees them, so a frame only costs the FMQ round trip.
+class BurstExecutorWithCache : public ExecutionBurstServer::IBurstExecutorWithCache
+{
+public:
+    BurstExecutorWithCache(const Model& model, const sp<PreparedModel>& preparedModel)
+        : mModel(model), mPreparedModel(preparedModel) {}
+
+    bool isCacheEntryPresent(int32_t slot) const override
+    {
+        return mMemoryCache.find(slot) != mMemoryCache.end();
+    }
+
+    void addCacheEntry(const hidl_memory& memory, int32_t slot) override
+    {
+        mMemoryCache[slot] = memory;
+    }
+
+    void removeCacheEntry(int32_t slot) override
+    {
+        auto it = mMemoryCache.find(slot);
+        if (it == mMemoryCache.end())
+        {
+            return;
+        }
+        mPreparedModel->invalidatePool(it->second);
+        mMemoryCache.erase(it);
+    }
+
+    std::tuple<ErrorStatus, hidl_vec<OutputShape>, Timing> execute(
+            const Request& request, const std::vector<int32_t>& slots,
+            MeasureTiming measure) override
+    {
+        NN_GPU_CALL();
+
+        time_point driverStart;
+        if (measure == MeasureTiming::YES)
+        {
+            driverStart = now();
+        }
+
+        Request fullRequest = request;
+        fullRequest.pools.resize(slots.size());
+        for (size_t i = 0; i < slots.size(); ++i)
+        {
+            auto it = mMemoryCache.find(slots[i]);
+            if (it == mMemoryCache.end())
+            {
+                LOGE("burst slot %d is not in the memory cache", slots[i]);
+                return {ErrorStatus::INVALID_ARGUMENT, {}, kNoTiming};
+            }
+            fullRequest.pools[i] = it->second;
+        }
+
+        if (!validateRequest(fullRequest, mModel))
+        {
+            return {ErrorStatus::INVALID_ARGUMENT, {}, kNoTiming};
+        }
+
+        uint64_t timeOnDevice = UINT64_MAX;
+        if (!mPreparedModel->executeOnWorker(fullRequest, measure, timeOnDevice))
+        {
+            return {ErrorStatus::GENERAL_FAILURE, {}, kNoTiming};
+        }
+        return {ErrorStatus::NONE, {}, getTiming(measure, driverStart, timeOnDevice)};
+    }
+
+private:
+    const Model& mModel;
+    // keeps the model and its workers alive as long as the burst
+    const sp<PreparedModel> mPreparedModel;
+    std::map<int32_t, hidl_memory> mMemoryCache;
+};
+
 Return<void> PreparedModel::configureExecutionBurst(const sp<V1_2::IBurstCallback>& callback,
                                                     const MQDescriptorSync<V1_2::FmqRequestDatum>& requestChannel,
                                                     const MQDescriptorSync<V1_2::FmqResultDatum>& resultChannel,
@@ -162,10 +356,22 @@ Return<void> PreparedModel::configureExecutionBurst(const sp<V1_2::IBurstCallbac
 {
     NN_GPU_CALL();
 
-    UNUSED(callback);
-    UNUSED(requestChannel);
-    UNUSED(resultChannel);
-    UNUSED(cb);
+    // the burst server owns the FMQs and a worker thread which waits on the
+    // request channel and calls back into the executor with cache
+    std::shared_ptr<BurstExecutorWithCache> executorWithCache =
+            std::make_shared<BurstExecutorWithCache>(mModel, this);
+    const sp<V1_2::IBurstContext> burst =
+            ExecutionBurstServer::create(callback, requestChannel, resultChannel, executorWithCache);
+
+    if (burst == nullptr)
+    {
+        LOGE("failed to create the execution burst server");
+        cb(ErrorStatus::GENERAL_FAILURE, {});
+    }
+    else
+    {
+        cb(ErrorStatus::NONE, burst);
+    }
 
     return Void();
 }
@@ -173,8 +379,15 @@ Return<void> PreparedModel::configureExecutionBurst(const sp<V1_2::IBurstCallbac
 PreparedModel::~PreparedModel()
 {
     NN_GPU_CALL();
-    for (auto& th : execThreads) th.join();
-    exec->deinitPerModel();
+    // the workers finish the pending executions and release their thread state first
+    if (workers)
+    {
+        workers->stop();
+    }
+    for (auto& exec : execs)
+    {
+        exec->deinitPerModel();
+    }
 }
 
 NAME_SPACE_STOP
@@ -2,6 +2,8 @@
 #define ANDROID_HARDWARE_NEURALNETWORKS_V1_2_PREPARE_MODEL_H
 
 #include "hal_types.h"
+#include "compilation_cache.h"
+#include "execution_worker_pool.h"
 
 NAME_SPACE_BEGIN
 
@@ -15,6 +17,10 @@ public:
     PreparedModel(const Model& model);
     ~PreparedModel() override;
     bool initialize();
+    bool initializeFromCache(const std::vector<uint8_t>& plan, const std::vector<uint8_t>& data);
+    bool saveToCache(const hidl_vec<hidl_handle>& modelCache,
+                     const hidl_vec<hidl_handle>& dataCache,
+                     const HidlToken& token);
     Return<ErrorStatus> execute(const Request& request,
                                 const sp<V1_0::IExecutionCallback>& callback) override;
     Return<ErrorStatus> execute_1_2(const Request& request,
@@ -28,13 +34,26 @@ public:
                                          const MQDescriptorSync<V1_2::FmqResultDatum>& resultChannel,
                                          configureExecutionBurst_cb cb) override;
 
+    // runs a validated request on a worker and waits for it
+    bool executeOnWorker(const Request& request, MeasureTiming measure, uint64_t& timeOnDevice);
+    // the client freed a pool, drops its mapping from every execution context
+    void invalidatePool(const hidl_memory& pool);
+
 private:
-    void asyncExecute(const Request& request, const sp<V1_0::IExecutionCallback>& callback);
-    void asyncExecute_1_2(const Request& request, const sp<V1_2::IExecutionCallback>& callback);
+    void asyncExecute(const Request& request, const sp<V1_0::IExecutionCallback>& callback,
+                      BaseExecutor& exec, bool ready);
+    void asyncExecute_1_2(const Request& request, const sp<V1_2::IExecutionCallback>& callback,
+                          MeasureTiming measure, const time_point& driverStart,
+                          BaseExecutor& exec, bool ready);
+    // adds the execution contexts beyond the first from its plan and starts the workers
+    void createExecContexts(const std::vector<uint8_t>& plan, const std::vector<uint8_t>& data);
 
     Model mModel;
-    sp<BaseExecutor> exec;
-    std::vector<std::thread> execThreads;
+    // execution contexts of the model, the compiled plan is shared and everything a
+    // request touches (operands, memory, command buffers, GL context) is per context
+    std::vector<sp<BaseExecutor>> execs;
+    // all executions of the model go through the workers, one per context
+    std::unique_ptr<ExecutionWorkerPool> workers;
 };
 
 NAME_SPACE_STOP
@@ -0,0 +1,245 @@
+#include "../../base.h"
+
+NAME_SPACE_BEGIN
+
+extern const unsigned int conv_gemm_split_k_spv[1895] = {
+    0x07230203,0x00010000,0x00000000,0x0000012f,0x00000000,0x00020011,0x00000001,0x0006000b,
+    0x00000001,0x4c534c47,0x6474732e,0x3035342e,0x00000000,0x0003000e,0x00000000,0x00000001,
+    0x0007000f,0x00000005,0x0000007b,0x6e69616d,0x00000000,0x0000007f,0x0000008a,0x00060010,
+    0x0000007b,0x00000011,0x00000001,0x00000001,0x00000001,0x00030003,0x00000002,0x000001c2,
+    0x00050005,0x00000004,0x41434f4c,0x5a535f4c,0x0000585f,0x00050005,0x00000006,0x41434f4c,
+    0x5a535f4c,0x0000595f,0x00050005,0x00000008,0x41434f4c,0x5a535f4c,0x00005a5f,0x00040005,
+    0x0000000a,0x485f4e49,0x00000000,0x00040005,0x0000000c,0x575f4e49,0x00000000,0x00040005,
+    0x0000000e,0x5f54554f,0x00000048,0x00040005,0x00000010,0x5f54554f,0x00000057,0x00050005,
+    0x00000012,0x49525453,0x485f4544,0x00000000,0x00050005,0x00000014,0x49525453,0x575f4544,
+    0x00000000,0x00040005,0x00000016,0x5f444150,0x00000048,0x00040005,0x00000018,0x5f444150,
+    0x00000057,0x00050005,0x0000001a,0x544c4946,0x485f5245,0x00000000,0x00050005,0x0000001c,
+    0x544c4946,0x575f5245,0x00000000,0x00050005,0x0000001e,0x4e414843,0x534c454e,0x00000000,
+    0x00040005,0x00000020,0x43544142,0x00000048,0x00030005,0x00000022,0x0000004d,0x00030005,
+    0x00000024,0x0000004b,0x00030005,0x00000026,0x0000004e,0x00050005,0x00000028,0x49544341,
+    0x49544156,0x00004e4f,0x00050005,0x0000002a,0x5f4d554e,0x4d455449,0x00000053,0x00040005,
+    0x0000002c,0x4c494154,0x00004d5f,0x00070005,0x0000002d,0x69746361,0x69746176,0x66286e6f,
+    0x74616f6c,0x0000003b,0x00030005,0x00000032,0x00000078,0x00040005,0x00000069,0x75706e49,
+    0x00003074,0x00030005,0x0000006a,0x00000000,0x00040005,0x0000006d,0x75706e49,0x00003174,
+    0x00030005,0x0000006e,0x00000000,0x00040005,0x00000071,0x75706e49,0x00003274,0x00030005,
+    0x00000072,0x00000000,0x00040005,0x00000075,0x7074754f,0x00007475,0x00030005,0x00000076,
+    0x00000000,0x00040005,0x00000078,0x74726170,0x006c6169,0x00040005,0x0000007b,0x6e69616d,
+    0x00000000,0x00080005,0x0000007f,0x4c5f6c67,0x6c61636f,0x6f766e49,0x69746163,0x44496e6f,
+    0x00000000,0x00030005,0x00000088,0x0064696c,0x00060005,0x0000008a,0x575f6c67,0x476b726f,
+    0x70756f72,0x00004449,0x00030005,0x0000008e,0x0000006e,0x00030005,0x00000093,0x00007967,
+    0x00030005,0x00000098,0x00007a67,0x00040005,0x0000009a,0x74646977,0x00003068,0x00050005,
+    0x0000009c,0x30637273,0x7065645f,0x00006874,0x00070005,0x000000a2,0x75706e69,0x61625f74,
+    0x5f686374,0x7366666f,0x00007465,0x00040005,0x000000a7,0x5f67726f,0x00000079,0x00040005,
+    0x000000ac,0x5f67726f,0x00000078,0x00030005,0x000000ad,0x006d7573,0x00030005,0x000000af,
+    0x00000069,0x00040005,0x000000be,0x30637273,0x0000785f,0x00040005,0x000000c5,0x30637273,
+    0x0000795f,0x00030005,0x000000ea,0x00000061,0x00040005,0x000000ff,0x69727473,0x00006564,
+    0x00070005,0x0000012e,0x575f6c67,0x476b726f,0x70756f72,0x657a6953,0x00000000,0x00040047,
+    0x00000004,0x00000001,0x00000000,0x00040047,0x00000006,0x00000001,0x00000001,0x00040047,
+    0x00000008,0x00000001,0x00000002,0x00040047,0x0000000a,0x00000001,0x00000003,0x00040047,
+    0x0000000c,0x00000001,0x00000004,0x00040047,0x0000000e,0x00000001,0x00000005,0x00040047,
+    0x00000010,0x00000001,0x00000006,0x00040047,0x00000012,0x00000001,0x00000007,0x00040047,
+    0x00000014,0x00000001,0x00000008,0x00040047,0x00000016,0x00000001,0x00000009,0x00040047,
+    0x00000018,0x00000001,0x0000000a,0x00040047,0x0000001a,0x00000001,0x0000000b,0x00040047,
+    0x0000001c,0x00000001,0x0000000c,0x00040047,0x0000001e,0x00000001,0x0000000d,0x00040047,
+    0x00000020,0x00000001,0x0000000e,0x00040047,0x00000022,0x00000001,0x0000000f,0x00040047,
+    0x00000024,0x00000001,0x00000010,0x00040047,0x00000026,0x00000001,0x00000011,0x00040047,
+    0x00000028,0x00000001,0x00000012,0x00040047,0x0000002a,0x00000001,0x00000013,0x00040047,
+    0x0000002c,0x00000001,0x00000014,0x00040047,0x00000068,0x00000006,0x00000010,0x00040048,
+    0x00000069,0x00000000,0x00000018,0x00050048,0x00000069,0x00000000,0x00000023,0x00000000,
+    0x00030047,0x00000069,0x00000003,0x00040047,0x0000006a,0x00000022,0x00000000,0x00040047,
+    0x0000006a,0x00000021,0x00000000,0x00040047,0x0000006c,0x00000006,0x00000010,0x00040048,
+    0x0000006d,0x00000000,0x00000018,0x00050048,0x0000006d,0x00000000,0x00000023,0x00000000,
+    0x00030047,0x0000006d,0x00000003,0x00040047,0x0000006e,0x00000022,0x00000000,0x00040047,
+    0x0000006e,0x00000021,0x00000001,0x00040047,0x00000070,0x00000006,0x00000004,0x00040048,
+    0x00000071,0x00000000,0x00000018,0x00050048,0x00000071,0x00000000,0x00000023,0x00000000,
+    0x00030047,0x00000071,0x00000003,0x00040047,0x00000072,0x00000022,0x00000000,0x00040047,
+    0x00000072,0x00000021,0x00000002,0x00040047,0x00000074,0x00000006,0x00000004,0x00040048,
+    0x00000075,0x00000000,0x00000019,0x00050048,0x00000075,0x00000000,0x00000023,0x00000000,
+    0x00030047,0x00000075,0x00000003,0x00040047,0x00000076,0x00000022,0x00000000,0x00040047,
+    0x00000076,0x00000021,0x00000003,0x00040047,0x0000007f,0x0000000b,0x0000001b,0x00040047,
+    0x0000008a,0x0000000b,0x0000001a,0x00040047,0x0000012b,0x00000001,0x00000000,0x00040047,
+    0x0000012c,0x00000001,0x00000001,0x00040047,0x0000012d,0x00000001,0x00000002,0x00040047,
+    0x0000012e,0x0000000b,0x00000019,0x00040015,0x00000002,0x00000020,0x00000001,0x0004002b,
+    0x00000002,0x00000003,0x00000000,0x00040032,0x00000002,0x00000004,0x00000000,0x0004002b,
+    0x00000002,0x00000005,0x00000001,0x00040032,0x00000002,0x00000006,0x00000000,0x0004002b,
+    0x00000002,0x00000007,0x00000002,0x00040032,0x00000002,0x00000008,0x00000000,0x0004002b,
+    0x00000002,0x00000009,0x00000003,0x00040032,0x00000002,0x0000000a,0x00000000,0x0004002b,
+    0x00000002,0x0000000b,0x00000004,0x00040032,0x00000002,0x0000000c,0x00000000,0x0004002b,
+    0x00000002,0x0000000d,0x00000005,0x00040032,0x00000002,0x0000000e,0x00000000,0x0004002b,
+    0x00000002,0x0000000f,0x00000006,0x00040032,0x00000002,0x00000010,0x00000000,0x0004002b,
+    0x00000002,0x00000011,0x00000007,0x00040032,0x00000002,0x00000012,0x00000000,0x0004002b,
+    0x00000002,0x00000013,0x00000008,0x00040032,0x00000002,0x00000014,0x00000000,0x0004002b,
+    0x00000002,0x00000015,0x00000009,0x00040032,0x00000002,0x00000016,0x00000000,0x0004002b,
+    0x00000002,0x00000017,0x0000000a,0x00040032,0x00000002,0x00000018,0x00000000,0x0004002b,
+    0x00000002,0x00000019,0x0000000b,0x00040032,0x00000002,0x0000001a,0x00000000,0x0004002b,
+    0x00000002,0x0000001b,0x0000000c,0x00040032,0x00000002,0x0000001c,0x00000000,0x0004002b,
+    0x00000002,0x0000001d,0x0000000d,0x00040032,0x00000002,0x0000001e,0x00000000,0x0004002b,
+    0x00000002,0x0000001f,0x0000000e,0x00040032,0x00000002,0x00000020,0x00000000,0x0004002b,
+    0x00000002,0x00000021,0x0000000f,0x00040032,0x00000002,0x00000022,0x00000000,0x0004002b,
+    0x00000002,0x00000023,0x00000010,0x00040032,0x00000002,0x00000024,0x00000000,0x0004002b,
+    0x00000002,0x00000025,0x00000011,0x00040032,0x00000002,0x00000026,0x00000000,0x0004002b,
+    0x00000002,0x00000027,0x00000012,0x00040032,0x00000002,0x00000028,0x00000000,0x0004002b,
+    0x00000002,0x00000029,0x00000013,0x00040032,0x00000002,0x0000002a,0x00000000,0x0004002b,
+    0x00000002,0x0000002b,0x00000014,0x00040032,0x00000002,0x0000002c,0x00000000,0x00030016,
+    0x0000002e,0x00000020,0x00040021,0x0000002f,0x0000002e,0x0000002e,0x00040020,0x00000033,
+    0x00000007,0x0000002e,0x00020014,0x00000035,0x0004002b,0x0000002e,0x0000003a,0x00000000,
+    0x0004002b,0x0000002e,0x00000046,0x3f800000,0x0004002b,0x0000002e,0x0000004c,0xbf800000,
+    0x0004002b,0x0000002e,0x00000059,0x40c00000,0x00040017,0x00000067,0x0000002e,0x00000004,
+    0x0003001d,0x00000068,0x00000067,0x0003001e,0x00000069,0x00000068,0x00040020,0x0000006b,
+    0x00000002,0x00000069,0x0004003b,0x0000006b,0x0000006a,0x00000002,0x0003001d,0x0000006c,
+    0x00000067,0x0003001e,0x0000006d,0x0000006c,0x00040020,0x0000006f,0x00000002,0x0000006d,
+    0x0004003b,0x0000006f,0x0000006e,0x00000002,0x0003001d,0x00000070,0x0000002e,0x0003001e,
+    0x00000071,0x00000070,0x00040020,0x00000073,0x00000002,0x00000071,0x0004003b,0x00000073,
+    0x00000072,0x00000002,0x0003001d,0x00000074,0x0000002e,0x0003001e,0x00000075,0x00000074,
+    0x00040020,0x00000077,0x00000002,0x00000075,0x0004003b,0x00000077,0x00000076,0x00000002,
+    0x0004001c,0x00000079,0x0000002e,0x00000004,0x00040020,0x0000007a,0x00000004,0x00000079,
+    0x0004003b,0x0000007a,0x00000078,0x00000004,0x00020013,0x0000007c,0x00030021,0x0000007d,
+    0x0000007c,0x00040015,0x00000080,0x00000020,0x00000000,0x00040017,0x00000081,0x00000080,
+    0x00000003,0x00040020,0x00000082,0x00000001,0x00000081,0x0004003b,0x00000082,0x0000007f,
+    0x00000001,0x00040020,0x00000084,0x00000001,0x00000080,0x0004002b,0x00000080,0x00000085,
+    0x00000000,0x00040020,0x00000089,0x00000007,0x00000002,0x0004003b,0x00000082,0x0000008a,
+    0x00000001,0x0004002b,0x00000080,0x00000090,0x00000001,0x0004002b,0x00000080,0x00000095,
+    0x00000002,0x00040020,0x000000e8,0x00000002,0x00000067,0x00040020,0x000000eb,0x00000007,
+    0x00000067,0x00040020,0x000000fb,0x00000004,0x0000002e,0x0004002b,0x00000080,0x000000fd,
+    0x00000108,0x00040020,0x00000123,0x00000002,0x0000002e,0x00040032,0x00000080,0x0000012b,
+    0x00000001,0x00040032,0x00000080,0x0000012c,0x00000001,0x00040032,0x00000080,0x0000012d,
+    0x00000001,0x00060033,0x00000081,0x0000012e,0x0000012b,0x0000012c,0x0000012d,0x00050036,
+    0x0000002e,0x0000002d,0x00000000,0x0000002f,0x00030037,0x0000002e,0x00000030,0x000200f8,
+    0x00000031,0x0004003b,0x00000033,0x00000032,0x00000007,0x0003003e,0x00000032,0x00000030,
+    0x000500aa,0x00000035,0x00000034,0x00000028,0x00000005,0x000300f7,0x00000037,0x00000000,
+    0x000400fa,0x00000034,0x00000036,0x00000038,0x000200f8,0x00000036,0x0004003d,0x0000002e,
+    0x00000039,0x00000032,0x000500b8,0x00000035,0x0000003b,0x00000039,0x0000003a,0x000300f7,
+    0x0000003e,0x00000000,0x000400fa,0x0000003b,0x0000003c,0x0000003d,0x000200f8,0x0000003c,
+    0x000200f9,0x0000003e,0x000200f8,0x0000003d,0x0004003d,0x0000002e,0x0000003f,0x00000032,
+    0x000200f9,0x0000003e,0x000200f8,0x0000003e,0x000700f5,0x0000002e,0x00000040,0x0000003a,
+    0x0000003c,0x0000003f,0x0000003d,0x000200fe,0x00000040,0x000200f8,0x00000038,0x000500aa,
+    0x00000035,0x00000041,0x00000028,0x00000007,0x000300f7,0x00000043,0x00000000,0x000400fa,
+    0x00000041,0x00000042,0x00000044,0x000200f8,0x00000042,0x0004003d,0x0000002e,0x00000045,
+    0x00000032,0x000500ba,0x00000035,0x00000047,0x00000045,0x00000046,0x000300f7,0x0000004a,
+    0x00000000,0x000400fa,0x00000047,0x00000048,0x00000049,0x000200f8,0x00000048,0x000200f9,
+    0x0000004a,0x000200f8,0x00000049,0x0004003d,0x0000002e,0x0000004b,0x00000032,0x000500b8,
+    0x00000035,0x0000004d,0x0000004b,0x0000004c,0x000300f7,0x00000050,0x00000000,0x000400fa,
+    0x0000004d,0x0000004e,0x0000004f,0x000200f8,0x0000004e,0x000200f9,0x00000050,0x000200f8,
+    0x0000004f,0x0004003d,0x0000002e,0x00000051,0x00000032,0x000200f9,0x00000050,0x000200f8,
+    0x00000050,0x000700f5,0x0000002e,0x00000052,0x0000004c,0x0000004e,0x00000051,0x0000004f,
+    0x000200f9,0x0000004a,0x000200f8,0x0000004a,0x000700f5,0x0000002e,0x00000053,0x00000046,
+    0x00000048,0x00000052,0x00000050,0x000200fe,0x00000053,0x000200f8,0x00000044,0x000500aa,
+    0x00000035,0x00000054,0x00000028,0x00000009,0x000300f7,0x00000056,0x00000000,0x000400fa,
+    0x00000054,0x00000055,0x00000057,0x000200f8,0x00000055,0x0004003d,0x0000002e,0x00000058,
+    0x00000032,0x000500ba,0x00000035,0x0000005a,0x00000058,0x00000059,0x000300f7,0x0000005d,
+    0x00000000,0x000400fa,0x0000005a,0x0000005b,0x0000005c,0x000200f8,0x0000005b,0x000200f9,
+    0x0000005d,0x000200f8,0x0000005c,0x0004003d,0x0000002e,0x0000005e,0x00000032,0x000500b8,
+    0x00000035,0x0000005f,0x0000005e,0x0000003a,0x000300f7,0x00000062,0x00000000,0x000400fa,
+    0x0000005f,0x00000060,0x00000061,0x000200f8,0x00000060,0x000200f9,0x00000062,0x000200f8,
+    0x00000061,0x0004003d,0x0000002e,0x00000063,0x00000032,0x000200f9,0x00000062,0x000200f8,
+    0x00000062,0x000700f5,0x0000002e,0x00000064,0x0000003a,0x00000060,0x00000063,0x00000061,
+    0x000200f9,0x0000005d,0x000200f8,0x0000005d,0x000700f5,0x0000002e,0x00000065,0x00000059,
+    0x0000005b,0x00000064,0x00000062,0x000200fe,0x00000065,0x000200f8,0x00000057,0x0004003d,
+    0x0000002e,0x00000066,0x00000032,0x000200fe,0x00000066,0x000200f8,0x00000056,0x000200f9,
+    0x00000043,0x000200f8,0x00000043,0x000200f9,0x00000037,0x000200f8,0x00000037,0x000100ff,
+    0x00010038,0x00050036,0x0000007c,0x0000007b,0x00000000,0x0000007d,0x000200f8,0x0000007e,
+    0x0004003b,0x00000089,0x00000088,0x00000007,0x0004003b,0x00000089,0x0000008e,0x00000007,
+    0x0004003b,0x00000089,0x00000093,0x00000007,0x0004003b,0x00000089,0x00000098,0x00000007,
+    0x0004003b,0x00000089,0x0000009a,0x00000007,0x0004003b,0x00000089,0x0000009c,0x00000007,
+    0x0004003b,0x00000089,0x000000a2,0x00000007,0x0004003b,0x00000089,0x000000a7,0x00000007,
+    0x0004003b,0x00000089,0x000000ac,0x00000007,0x0004003b,0x00000033,0x000000ad,0x00000007,
+    0x0004003b,0x00000089,0x000000af,0x00000007,0x0004003b,0x00000089,0x000000be,0x00000007,
+    0x0004003b,0x00000089,0x000000c5,0x00000007,0x0004003b,0x000000eb,0x000000ea,0x00000007,
+    0x0004003b,0x00000089,0x000000ff,0x00000007,0x00050041,0x00000084,0x00000083,0x0000007f,
+    0x00000085,0x0004003d,0x00000080,0x00000086,0x00000083,0x0004007c,0x00000002,0x00000087,
+    0x00000086,0x0003003e,0x00000088,0x00000087,0x00050041,0x00000084,0x0000008b,0x0000008a,
+    0x00000085,0x0004003d,0x00000080,0x0000008c,0x0000008b,0x0004007c,0x00000002,0x0000008d,
+    0x0000008c,0x0003003e,0x0000008e,0x0000008d,0x00050041,0x00000084,0x0000008f,0x0000008a,
+    0x00000090,0x0004003d,0x00000080,0x00000091,0x0000008f,0x0004007c,0x00000002,0x00000092,
+    0x00000091,0x0003003e,0x00000093,0x00000092,0x00050041,0x00000084,0x00000094,0x0000008a,
+    0x00000095,0x0004003d,0x00000080,0x00000096,0x00000094,0x0004007c,0x00000002,0x00000097,
+    0x00000096,0x0003003e,0x00000098,0x00000097,0x00050087,0x00000002,0x00000099,0x00000024,
+    0x0000000b,0x0003003e,0x0000009a,0x00000099,0x00050087,0x00000002,0x0000009b,0x0000001e,
+    0x0000000b,0x0003003e,0x0000009c,0x0000009b,0x0004003d,0x00000002,0x0000009d,0x00000098,
+    0x00050084,0x00000002,0x0000009e,0x0000009d,0x0000000a,0x00050084,0x00000002,0x0000009f,
+    0x0000009e,0x0000000c,0x0004003d,0x00000002,0x000000a0,0x0000009c,0x00050084,0x00000002,
+    0x000000a1,0x0000009f,0x000000a0,0x0003003e,0x000000a2,0x000000a1,0x0004003d,0x00000002,
+    0x000000a3,0x00000093,0x00050087,0x00000002,0x000000a4,0x000000a3,0x00000010,0x00050084,
+    0x00000002,0x000000a5,0x000000a4,0x00000012,0x00050082,0x00000002,0x000000a6,0x000000a5,
+    0x00000016,0x0003003e,0x000000a7,0x000000a6,0x0004003d,0x00000002,0x000000a8,0x00000093,
+    0x0005008b,0x00000002,0x000000a9,0x000000a8,0x00000010,0x00050084,0x00000002,0x000000aa,
+    0x000000a9,0x00000014,0x00050082,0x00000002,0x000000ab,0x000000aa,0x00000018,0x0003003e,
+    0x000000ac,0x000000ab,0x0003003e,0x000000ad,0x0000003a,0x0004003d,0x00000002,0x000000ae,
+    0x00000088,0x0003003e,0x000000af,0x000000ae,0x000200f9,0x000000b0,0x000200f8,0x000000b0,
+    0x000400f6,0x000000b4,0x000000b3,0x00000000,0x000200f9,0x000000b1,0x000200f8,0x000000b1,
+    0x0004003d,0x00000002,0x000000b5,0x000000af,0x0004003d,0x00000002,0x000000b6,0x0000009a,
+    0x000500b1,0x00000035,0x000000b7,0x000000b5,0x000000b6,0x000400fa,0x000000b7,0x000000b2,
+    0x000000b4,0x000200f8,0x000000b2,0x0004003d,0x00000002,0x000000b8,0x000000ac,0x0004003d,
+    0x00000002,0x000000b9,0x000000af,0x0004003d,0x00000002,0x000000ba,0x0000009c,0x00050087,
+    0x00000002,0x000000bb,0x000000b9,0x000000ba,0x0005008b,0x00000002,0x000000bc,0x000000bb,
+    0x0000001c,0x00050080,0x00000002,0x000000bd,0x000000b8,0x000000bc,0x0003003e,0x000000be,
+    0x000000bd,0x0004003d,0x00000002,0x000000bf,0x000000a7,0x0004003d,0x00000002,0x000000c0,
+    0x000000af,0x0004003d,0x00000002,0x000000c1,0x0000009c,0x00050087,0x00000002,0x000000c2,
+    0x000000c0,0x000000c1,0x00050087,0x00000002,0x000000c3,0x000000c2,0x0000001c,0x00050080,
+    0x00000002,0x000000c4,0x000000bf,0x000000c3,0x0003003e,0x000000c5,0x000000c4,0x0004003d,
+    0x00000002,0x000000c6,0x000000c5,0x000500af,0x00000035,0x000000c7,0x000000c6,0x00000003,
+    0x000300f7,0x000000c9,0x00000000,0x000400fa,0x000000c7,0x000000c8,0x000000c9,0x000200f8,
+    0x000000c8,0x0004003d,0x00000002,0x000000ca,0x000000c5,0x000500b1,0x00000035,0x000000cb,
+    0x000000ca,0x0000000a,0x000200f9,0x000000c9,0x000200f8,0x000000c9,0x000700f5,0x00000035,
+    0x000000cc,0x000000c7,0x000000b2,0x000000cb,0x000000c8,0x000300f7,0x000000ce,0x00000000,
+    0x000400fa,0x000000cc,0x000000cd,0x000000ce,0x000200f8,0x000000cd,0x0004003d,0x00000002,
+    0x000000cf,0x000000be,0x000500af,0x00000035,0x000000d0,0x000000cf,0x00000003,0x000200f9,
+    0x000000ce,0x000200f8,0x000000ce,0x000700f5,0x00000035,0x000000d1,0x000000cc,0x000000c9,
+    0x000000d0,0x000000cd,0x000300f7,0x000000d3,0x00000000,0x000400fa,0x000000d1,0x000000d2,
+    0x000000d3,0x000200f8,0x000000d2,0x0004003d,0x00000002,0x000000d4,0x000000be,0x000500b1,
+    0x00000035,0x000000d5,0x000000d4,0x0000000c,0x000200f9,0x000000d3,0x000200f8,0x000000d3,
+    0x000700f5,0x00000035,0x000000d6,0x000000d1,0x000000ce,0x000000d5,0x000000d2,0x000300f7,
+    0x000000d8,0x00000000,0x000400fa,0x000000d6,0x000000d7,0x000000d8,0x000200f8,0x000000d7,
+    0x0004003d,0x00000002,0x000000d9,0x000000a2,0x0004003d,0x00000002,0x000000da,0x000000c5,
+    0x0004003d,0x00000002,0x000000db,0x0000009c,0x00050084,0x00000002,0x000000dc,0x0000000c,
+    0x000000db,0x00050084,0x00000002,0x000000dd,0x000000da,0x000000dc,0x00050080,0x00000002,
+    0x000000de,0x000000d9,0x000000dd,0x0004003d,0x00000002,0x000000df,0x000000be,0x0004003d,
+    0x00000002,0x000000e0,0x0000009c,0x00050084,0x00000002,0x000000e1,0x000000df,0x000000e0,
+    0x00050080,0x00000002,0x000000e2,0x000000de,0x000000e1,0x0004003d,0x00000002,0x000000e3,
+    0x000000af,0x0004003d,0x00000002,0x000000e4,0x0000009c,0x0005008b,0x00000002,0x000000e5,
+    0x000000e3,0x000000e4,0x00050080,0x00000002,0x000000e6,0x000000e2,0x000000e5,0x00060041,
+    0x000000e8,0x000000e7,0x0000006a,0x00000003,0x000000e6,0x0004003d,0x00000067,0x000000e9,
+    0x000000e7,0x0003003e,0x000000ea,0x000000e9,0x0004003d,0x00000067,0x000000ec,0x000000ea,
+    0x0004003d,0x00000002,0x000000ed,0x0000008e,0x0004003d,0x00000002,0x000000ee,0x0000009a,
+    0x00050084,0x00000002,0x000000ef,0x000000ed,0x000000ee,0x0004003d,0x00000002,0x000000f0,
+    0x000000af,0x00050080,0x00000002,0x000000f1,0x000000ef,0x000000f0,0x00060041,0x000000e8,
+    0x000000f2,0x0000006e,0x00000003,0x000000f1,0x0004003d,0x00000067,0x000000f3,0x000000f2,
+    0x00050094,0x0000002e,0x000000f4,0x000000ec,0x000000f3,0x0004003d,0x0000002e,0x000000f5,
+    0x000000ad,0x00050081,0x0000002e,0x000000f6,0x000000f5,0x000000f4,0x0003003e,0x000000ad,
+    0x000000f6,0x000200f9,0x000000d8,0x000200f8,0x000000d8,0x000200f9,0x000000b3,0x000200f8,
+    0x000000b3,0x0004003d,0x00000002,0x000000f7,0x000000af,0x00050080,0x00000002,0x000000f8,
+    0x000000f7,0x00000004,0x0003003e,0x000000af,0x000000f8,0x000200f9,0x000000b0,0x000200f8,
+    0x000000b4,0x0004003d,0x00000002,0x000000f9,0x00000088,0x00050041,0x000000fb,0x000000fa,
+    0x00000078,0x000000f9,0x0004003d,0x0000002e,0x000000fc,0x000000ad,0x0003003e,0x000000fa,
+    0x000000fc,0x000400e0,0x00000095,0x00000095,0x000000fd,0x00050087,0x00000002,0x000000fe,
+    0x00000004,0x00000007,0x0003003e,0x000000ff,0x000000fe,0x000200f9,0x00000100,0x000200f8,
+    0x00000100,0x000400f6,0x00000104,0x00000103,0x00000000,0x000200f9,0x00000101,0x000200f8,
+    0x00000101,0x0004003d,0x00000002,0x00000105,0x000000ff,0x000500ad,0x00000035,0x00000106,
+    0x00000105,0x00000003,0x000400fa,0x00000106,0x00000102,0x00000104,0x000200f8,0x00000102,
+    0x0004003d,0x00000002,0x00000107,0x00000088,0x0004003d,0x00000002,0x00000108,0x000000ff,
+    0x000500b1,0x00000035,0x00000109,0x00000107,0x00000108,0x000300f7,0x0000010b,0x00000000,
+    0x000400fa,0x00000109,0x0000010a,0x0000010b,0x000200f8,0x0000010a,0x0004003d,0x00000002,
+    0x0000010c,0x00000088,0x00050041,0x000000fb,0x0000010d,0x00000078,0x0000010c,0x0004003d,
+    0x00000002,0x0000010e,0x00000088,0x0004003d,0x00000002,0x0000010f,0x000000ff,0x00050080,
+    0x00000002,0x00000110,0x0000010e,0x0000010f,0x00050041,0x000000fb,0x00000111,0x00000078,
+    0x00000110,0x0004003d,0x0000002e,0x00000112,0x00000111,0x0004003d,0x0000002e,0x00000113,
+    0x0000010d,0x00050081,0x0000002e,0x00000114,0x00000113,0x00000112,0x0003003e,0x0000010d,
+    0x00000114,0x000200f9,0x0000010b,0x000200f8,0x0000010b,0x000400e0,0x00000095,0x00000095,
+    0x000000fd,0x000200f9,0x00000103,0x000200f8,0x00000103,0x0004003d,0x00000002,0x00000115,
+    0x000000ff,0x00050087,0x00000002,0x00000116,0x00000115,0x00000007,0x0003003e,0x000000ff,
+    0x00000116,0x000200f9,0x00000100,0x000200f8,0x00000104,0x0004003d,0x00000002,0x00000117,
+    0x00000088,0x000500aa,0x00000035,0x00000118,0x00000117,0x00000003,0x000300f7,0x0000011a,
+    0x00000000,0x000400fa,0x00000118,0x00000119,0x0000011a,0x000200f8,0x00000119,0x0004003d,
+    0x00000002,0x0000011b,0x00000098,0x00050084,0x00000002,0x0000011c,0x0000011b,0x00000022,
+    0x0004003d,0x00000002,0x0000011d,0x00000093,0x00050080,0x00000002,0x0000011e,0x0000011c,
+    0x0000011d,0x00050084,0x00000002,0x0000011f,0x0000011e,0x00000026,0x0004003d,0x00000002,
+    0x00000120,0x0000008e,0x00050080,0x00000002,0x00000121,0x0000011f,0x00000120,0x00060041,
+    0x00000123,0x00000122,0x00000076,0x00000003,0x00000121,0x00050041,0x000000fb,0x00000124,
+    0x00000078,0x00000003,0x0004003d,0x0000002e,0x00000125,0x00000124,0x0004003d,0x00000002,
+    0x00000126,0x0000008e,0x00060041,0x00000123,0x00000127,0x00000072,0x00000003,0x00000126,
+    0x0004003d,0x0000002e,0x00000128,0x00000127,0x00050081,0x0000002e,0x00000129,0x00000125,
+    0x00000128,0x00050039,0x0000002e,0x0000012a,0x0000002d,0x00000129,0x0003003e,0x00000122,
+    0x0000012a,0x000200f9,0x0000011a,0x000200f8,0x0000011a,0x000100fd,0x00010038
+};
+
+NAME_SPACE_STOP
@@ -31,8 +31,17 @@ extern const unsigned int lrn_spv[1730];
 extern const unsigned int dw_conv_spv[2231];
 extern const unsigned int logistic_spv[368];
 extern const unsigned int conv_chn3to4_spv[729];
-extern const unsigned int conv_gemmShader4_8_spv[7691];
+extern const unsigned int conv_gemmShader4_8_spv[7648];
+extern const unsigned int conv_gemmShader4_8_packed_spv[7548];
 extern const unsigned int conv_gemm1_spv[1320];
+extern const unsigned int conv_gemmShader4_4_spv[5650];
+extern const unsigned int conv_gemmShader4_4_no_img2col_spv[3695];
+extern const unsigned int conv_gemmShader4_4_chn3_spv[3083];
+extern const unsigned int conv_winograd_input_spv[2573];
+extern const unsigned int conv_winograd_gemm_spv[1662];
+extern const unsigned int conv_winograd_output_spv[2493];
+extern const unsigned int conv_gemm_split_k_spv[1895];
+extern const unsigned int conv_gemm_implicit_spv[3312];
 
 NAME_SPACE_STOP
 
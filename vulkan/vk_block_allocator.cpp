@@ -0,0 +1,542 @@
+/*
+ * Copyright @2017 Intel Corporation
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library. If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <stdlib.h>
+#include <unistd.h>
+#include <algorithm>
+#include <iterator>
+#include <cutils/properties.h>
+#include "vk_common.h"
+#include "vk_wrapper.h"
+#include "vk_block_allocator.h"
+
+NAME_SPACE_BEGIN
+
+#define DEFAULT_BLOCK_SIZE_MB 64
+
+std::list<VkMemoryBlock> VkBlockAllocator::blocks;
+std::mutex VkBlockAllocator::mtx;
+VkDeviceSize VkBlockAllocator::blockSize = DEFAULT_BLOCK_SIZE_MB << 20;
+VkDeviceSize VkBlockAllocator::alignment = 256;
+uint32_t VkBlockAllocator::memoryTypes[kMemoryUsageNum];
+bool VkBlockAllocator::mapDevice = true;
+PFN_vkGetMemoryHostPointerPropertiesEXT VkBlockAllocator::getMemoryHostPointerProperties = nullptr;
+VkCommandPool VkBlockAllocator::copyPool = VK_NULL_HANDLE;
+std::mutex VkBlockAllocator::copyMtx;
+
+static VkPhysicalDeviceMemoryProperties memoryProperties;
+
+// the first type with properties and preferred, else the first one with properties
+static uint32_t findMemoryType(uint32_t memoryTypeBits, VkMemoryPropertyFlags properties,
+                               VkMemoryPropertyFlags preferred = 0)
+{
+    uint32_t found = -1;
+    for (uint32_t i = 0; i < memoryProperties.memoryTypeCount; ++i) {
+        VkMemoryPropertyFlags flags = memoryProperties.memoryTypes[i].propertyFlags;
+        if (!(memoryTypeBits & (1 << i)) || (flags & properties) != properties)
+            continue;
+        if ((flags & preferred) == preferred)
+            return i;
+        if (found == (uint32_t)-1)
+            found = i;
+    }
+    return found;
+}
+
+void VkBlockAllocator::init()
+{
+    char prop[PROPERTY_VALUE_MAX];
+    property_get("nn.gpgpu.vk_block_size", prop, "");
+    int mb = atoi(prop);
+    blockSize = (VkDeviceSize)(mb > 0 ? mb : DEFAULT_BLOCK_SIZE_MB) << 20;
+    alignment = std::max<VkDeviceSize>(kDeviceProps.limits.minStorageBufferOffsetAlignment,
+                                       kDeviceProps.limits.nonCoherentAtomSize);
+    alignment = std::max<VkDeviceSize>(alignment, 4);
+
+    vkGetPhysicalDeviceMemoryProperties(kPhysicalDevice, &memoryProperties);
+
+    // the memory types a storage buffer can be bound to, the same for every size
+    uint32_t typeBits = 0;
+    VkBuffer probe;
+    VkBufferCreateInfo bufferCreateInfo = {};
+    bufferCreateInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+    bufferCreateInfo.size = alignment;
+    bufferCreateInfo.usage = VK_BUFFER_USAGE_STORAGE_BUFFER_BIT |
+                             VK_BUFFER_USAGE_TRANSFER_SRC_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT;
+    bufferCreateInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+    if (vkCreateBuffer(kDevice, &bufferCreateInfo, NULL, &probe) == VK_SUCCESS)
+    {
+        VkMemoryRequirements memoryRequirements;
+        vkGetBufferMemoryRequirements(kDevice, probe, &memoryRequirements);
+        typeBits = memoryRequirements.memoryTypeBits;
+        vkDestroyBuffer(kDevice, probe, NULL);
+    }
+
+    const VkMemoryPropertyFlags host = VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT;
+    property_get("nn.gpgpu.vk_mem_policy", prop, "auto");
+    std::string policy = prop;
+    if (policy == "host")
+    {
+        for (uint32_t i = 0; i < kMemoryUsageNum; ++i)
+        {
+            memoryTypes[i] = findMemoryType(typeBits, host);
+        }
+    }
+    else
+    {
+        memoryTypes[kMemoryUsageHost]     = findMemoryType(typeBits, host);
+        memoryTypes[kMemoryUsageDevice]   = findMemoryType(typeBits, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+        memoryTypes[kMemoryUsageUpload]   = findMemoryType(typeBits, host);
+        memoryTypes[kMemoryUsageReadback] = findMemoryType(typeBits, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT,
+                                                           VK_MEMORY_PROPERTY_HOST_CACHED_BIT);
+        for (uint32_t i = 0; i < kMemoryUsageNum; ++i)
+        {
+            if (memoryTypes[i] == (uint32_t)-1)
+            {
+                memoryTypes[i] = memoryTypes[kMemoryUsageHost];
+            }
+        }
+    }
+    mapDevice = policy != "device";
+    NN_GPU_PERF("VkBlockAllocator: block size %llu, alignment %llu, policy %s, memory types %u %u %u %u",
+                (unsigned long long)blockSize, (unsigned long long)alignment, policy.c_str(),
+                memoryTypes[kMemoryUsageHost], memoryTypes[kMemoryUsageDevice],
+                memoryTypes[kMemoryUsageUpload], memoryTypes[kMemoryUsageReadback]);
+
+    if (kExternalMemoryHost)
+    {
+        getMemoryHostPointerProperties = reinterpret_cast<PFN_vkGetMemoryHostPointerPropertiesEXT>(
+            vkGetDeviceProcAddr(kDevice, "vkGetMemoryHostPointerPropertiesEXT"));
+    }
+
+    VkCommandPoolCreateInfo commandPoolCreateInfo = {};
+    commandPoolCreateInfo.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+    commandPoolCreateInfo.flags = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT;
+    commandPoolCreateInfo.queueFamilyIndex = kQueueFamilyIndex;
+    VK_CHECK_RESULT(vkCreateCommandPool(kDevice, &commandPoolCreateInfo, NULL, &copyPool));
+}
+
+void VkBlockAllocator::deinit()
+{
+    std::lock_guard<std::mutex> lock(mtx);
+    for (auto it = blocks.begin(); it != blocks.end();)
+    {
+        if (it->used > 0)
+        {
+            // still referenced by a Buffer, which frees its range later
+            LOGW("VkBlockAllocator: %llu bytes still allocated", (unsigned long long)it->used);
+            ++it;
+            continue;
+        }
+        destroyBlock(*it);
+        it = blocks.erase(it);
+    }
+
+    if (copyPool != VK_NULL_HANDLE)
+    {
+        vkDestroyCommandPool(kDevice, copyPool, NULL);
+        copyPool = VK_NULL_HANDLE;
+    }
+}
+
+VkMemoryBlock* VkBlockAllocator::createBlock(VkDeviceSize size, VkMemoryUsage usage, bool dedicated)
+{
+    VkMemoryBlock block = {};
+    block.size = size;
+    block.usage = usage;
+    block.dedicated = dedicated;
+
+    VkBufferCreateInfo bufferCreateInfo = {};
+    bufferCreateInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+    bufferCreateInfo.size = size;
+    bufferCreateInfo.usage = VK_BUFFER_USAGE_STORAGE_BUFFER_BIT |
+                             VK_BUFFER_USAGE_TRANSFER_SRC_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT;
+    bufferCreateInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+    if (vkCreateBuffer(kDevice, &bufferCreateInfo, NULL, &block.buffer) != VK_SUCCESS)
+    {
+        LOGE("VkBlockAllocator: failed to create a buffer of %llu bytes", (unsigned long long)size);
+        return nullptr;
+    }
+
+    VkMemoryRequirements memoryRequirements;
+    vkGetBufferMemoryRequirements(kDevice, block.buffer, &memoryRequirements);
+
+    VkMemoryAllocateInfo allocateInfo = {};
+    allocateInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+    allocateInfo.allocationSize = memoryRequirements.size;
+    allocateInfo.memoryTypeIndex = memoryTypes[usage];
+    if (vkAllocateMemory(kDevice, &allocateInfo, NULL, &block.memory) != VK_SUCCESS)
+    {
+        LOGE("VkBlockAllocator: failed to allocate %llu bytes", (unsigned long long)size);
+        vkDestroyBuffer(kDevice, block.buffer, NULL);
+        return nullptr;
+    }
+    VK_CHECK_RESULT(vkBindBufferMemory(kDevice, block.buffer, block.memory, 0));
+
+    // a memory object may only be mapped once, the ranges of the block share this mapping
+    VkMemoryPropertyFlags flags = memoryProperties.memoryTypes[memoryTypes[usage]].propertyFlags;
+    block.coherent = (flags & VK_MEMORY_PROPERTY_HOST_COHERENT_BIT) != 0;
+    if ((flags & VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT) && (usage != kMemoryUsageDevice || mapDevice))
+    {
+        VK_CHECK_RESULT(vkMapMemory(kDevice, block.memory, 0, VK_WHOLE_SIZE, 0, (void **)&block.ptr));
+    }
+
+    block.freeRanges[0] = size;
+    blocks.push_back(block);
+    NN_GPU_DEBUG("VkBlockAllocator: new %sblock of %llu bytes for usage %d, %zu blocks",
+                 dedicated ? "dedicated " : "", (unsigned long long)size, usage, blocks.size());
+    return &blocks.back();
+}
+
+void VkBlockAllocator::destroyBlock(VkMemoryBlock& block)
+{
+    if (block.ptr != nullptr && !block.imported)
+    {
+        vkUnmapMemory(kDevice, block.memory);
+    }
+    vkDestroyBuffer(kDevice, block.buffer, NULL);
+    vkFreeMemory(kDevice, block.memory, NULL);
+}
+
+bool VkBlockAllocator::allocateFrom(VkMemoryBlock& block, VkDeviceSize size, VkSubAllocation& alloc)
+{
+    // the smallest free range it fits in
+    auto best = block.freeRanges.end();
+    for (auto it = block.freeRanges.begin(); it != block.freeRanges.end(); ++it)
+    {
+        if (it->second >= size && (best == block.freeRanges.end() || it->second < best->second))
+        {
+            best = it;
+        }
+    }
+    if (best == block.freeRanges.end())
+    {
+        return false;
+    }
+
+    VkDeviceSize offset = best->first;
+    VkDeviceSize left = best->second - size;
+    block.freeRanges.erase(best);
+    if (left > 0)
+    {
+        block.freeRanges[offset + size] = left;
+    }
+
+    block.used += size;
+    alloc.block = &block;
+    alloc.offset = offset;
+    alloc.size = size;
+    return true;
+}
+
+bool VkBlockAllocator::allocate(VkDeviceSize size, VkMemoryUsage usage, VkSubAllocation& alloc)
+{
+    size = ALIGN(std::max<VkDeviceSize>(size, 1), alignment);
+
+    std::lock_guard<std::mutex> lock(mtx);
+    if (size > blockSize / 2)
+    {
+        VkMemoryBlock* block = createBlock(size, usage, true);
+        return block != nullptr && allocateFrom(*block, size, alloc);
+    }
+
+    for (auto& block : blocks)
+    {
+        if (block.usage == usage && !block.dedicated && allocateFrom(block, size, alloc))
+        {
+            return true;
+        }
+    }
+
+    VkMemoryBlock* block = createBlock(blockSize, usage, false);
+    return block != nullptr && allocateFrom(*block, size, alloc);
+}
+
+bool VkBlockAllocator::import(uint8_t* ptr, VkDeviceSize size, VkSubAllocation& alloc)
+{
+    if (getMemoryHostPointerProperties == nullptr || kImportAlignment == 0 || size == 0)
+    {
+        return false;
+    }
+
+    // the pools are mmapped, the whole pages around them belong to the process
+    uintptr_t begin = reinterpret_cast<uintptr_t>(ptr) / kImportAlignment * kImportAlignment;
+    uintptr_t end = ALIGN(reinterpret_cast<uintptr_t>(ptr) + size, kImportAlignment);
+    if (kImportAlignment > (VkDeviceSize)getpagesize())
+    {
+        return false;
+    }
+
+    // anonymous shared memory is a host allocation, a mapped file is foreign memory
+    const VkExternalMemoryHandleTypeFlagBits handleTypes[] = {
+        VK_EXTERNAL_MEMORY_HANDLE_TYPE_HOST_ALLOCATION_BIT_EXT,
+        VK_EXTERNAL_MEMORY_HANDLE_TYPE_HOST_MAPPED_FOREIGN_MEMORY_BIT_EXT,
+    };
+    VkExternalMemoryHandleTypeFlagBits handleType = handleTypes[0];
+    VkMemoryHostPointerPropertiesEXT hostProps = {};
+    hostProps.sType = VK_STRUCTURE_TYPE_MEMORY_HOST_POINTER_PROPERTIES_EXT;
+    bool supported = false;
+    for (auto type : handleTypes)
+    {
+        if (getMemoryHostPointerProperties(kDevice, type, reinterpret_cast<void*>(begin), &hostProps) == VK_SUCCESS &&
+            hostProps.memoryTypeBits != 0)
+        {
+            handleType = type;
+            supported = true;
+            break;
+        }
+    }
+    if (!supported)
+    {
+        return false;
+    }
+
+    VkMemoryBlock block = {};
+    block.size = end - begin;
+    block.usage = kMemoryUsageHost;
+    block.dedicated = true;
+    block.imported = true;
+
+    VkExternalMemoryBufferCreateInfoKHR externalInfo = {};
+    externalInfo.sType = VK_STRUCTURE_TYPE_EXTERNAL_MEMORY_BUFFER_CREATE_INFO_KHR;
+    externalInfo.handleTypes = handleType;
+
+    VkBufferCreateInfo bufferCreateInfo = {};
+    bufferCreateInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+    bufferCreateInfo.pNext = &externalInfo;
+    bufferCreateInfo.size = block.size;
+    bufferCreateInfo.usage = VK_BUFFER_USAGE_STORAGE_BUFFER_BIT |
+                             VK_BUFFER_USAGE_TRANSFER_SRC_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT;
+    bufferCreateInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+    if (vkCreateBuffer(kDevice, &bufferCreateInfo, NULL, &block.buffer) != VK_SUCCESS)
+    {
+        return false;
+    }
+
+    VkMemoryRequirements memoryRequirements;
+    vkGetBufferMemoryRequirements(kDevice, block.buffer, &memoryRequirements);
+    uint32_t typeBits = memoryRequirements.memoryTypeBits & hostProps.memoryTypeBits;
+    uint32_t typeIndex = findMemoryType(typeBits, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT,
+                                        VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+    if (typeIndex == (uint32_t)-1 || memoryRequirements.size > block.size)
+    {
+        vkDestroyBuffer(kDevice, block.buffer, NULL);
+        return false;
+    }
+
+    VkImportMemoryHostPointerInfoEXT importInfo = {};
+    importInfo.sType = VK_STRUCTURE_TYPE_IMPORT_MEMORY_HOST_POINTER_INFO_EXT;
+    importInfo.handleType = handleType;
+    importInfo.pHostPointer = reinterpret_cast<void*>(begin);
+
+    VkMemoryAllocateInfo allocateInfo = {};
+    allocateInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+    allocateInfo.pNext = &importInfo;
+    allocateInfo.allocationSize = block.size;
+    allocateInfo.memoryTypeIndex = typeIndex;
+    if (vkAllocateMemory(kDevice, &allocateInfo, NULL, &block.memory) != VK_SUCCESS)
+    {
+        vkDestroyBuffer(kDevice, block.buffer, NULL);
+        return false;
+    }
+    VK_CHECK_RESULT(vkBindBufferMemory(kDevice, block.buffer, block.memory, 0));
+
+    block.ptr = reinterpret_cast<uint8_t*>(begin);
+    block.coherent = (memoryProperties.memoryTypes[typeIndex].propertyFlags &
+                      VK_MEMORY_PROPERTY_HOST_COHERENT_BIT) != 0;
+    block.used = size;
+
+    std::lock_guard<std::mutex> lock(mtx);
+    blocks.push_back(block);
+    alloc.block = &blocks.back();
+    alloc.offset = reinterpret_cast<uintptr_t>(ptr) - begin;
+    alloc.size = size;
+    NN_GPU_DEBUG("VkBlockAllocator: imported %llu bytes of host memory", (unsigned long long)size);
+    return true;
+}
+
+void VkBlockAllocator::free(VkSubAllocation& alloc)
+{
+    if (alloc.block == nullptr)
+    {
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(mtx);
+    VkMemoryBlock& block = *alloc.block;
+    VkDeviceSize offset = alloc.offset;
+    VkDeviceSize size = alloc.size;
+    block.used -= size;
+    alloc = VkSubAllocation();
+
+    // merge with the free neighbours
+    auto next = block.freeRanges.lower_bound(offset);
+    if (next != block.freeRanges.end() && offset + size == next->first)
+    {
+        size += next->second;
+        next = block.freeRanges.erase(next);
+    }
+    if (next != block.freeRanges.begin())
+    {
+        auto prev = std::prev(next);
+        if (prev->first + prev->second == offset)
+        {
+            offset = prev->first;
+            size += prev->second;
+            block.freeRanges.erase(prev);
+        }
+    }
+    block.freeRanges[offset] = size;
+
+    if (block.used > 0)
+    {
+        return;
+    }
+
+    // keep one empty block of each usage around, the next request allocates the same sizes again
+    bool keep = !block.dedicated;
+    for (auto& other : blocks)
+    {
+        if (&other != &block && other.usage == block.usage && !other.dedicated && other.used == 0)
+        {
+            keep = false;
+            break;
+        }
+    }
+    if (keep)
+    {
+        return;
+    }
+
+    for (auto it = blocks.begin(); it != blocks.end(); ++it)
+    {
+        if (&*it == &block)
+        {
+            destroyBlock(block);
+            blocks.erase(it);
+            break;
+        }
+    }
+}
+
+static VkMappedMemoryRange getMappedRange(const VkSubAllocation& alloc, VkDeviceSize offset, VkDeviceSize size)
+{
+    // ranges start at a multiple of nonCoherentAtomSize, it divides the alignment
+    VkDeviceSize atom = std::max<VkDeviceSize>(kDeviceProps.limits.nonCoherentAtomSize, 1);
+    VkDeviceSize begin = (alloc.offset + offset) / atom * atom;
+    VkDeviceSize end = ALIGN(alloc.offset + offset + size, atom);
+
+    VkMappedMemoryRange range = {};
+    range.sType = VK_STRUCTURE_TYPE_MAPPED_MEMORY_RANGE;
+    range.memory = alloc.block->memory;
+    range.offset = begin;
+    range.size = end < alloc.block->size ? end - begin : VK_WHOLE_SIZE;
+    return range;
+}
+
+void VkBlockAllocator::flush(const VkSubAllocation& alloc, VkDeviceSize offset, VkDeviceSize size)
+{
+    if (alloc.block == nullptr || alloc.block->coherent || alloc.block->ptr == nullptr)
+    {
+        return;
+    }
+    VkMappedMemoryRange range = getMappedRange(alloc, offset, size);
+    VK_CHECK_RESULT(vkFlushMappedMemoryRanges(kDevice, 1, &range));
+}
+
+void VkBlockAllocator::invalidate(const VkSubAllocation& alloc, VkDeviceSize offset, VkDeviceSize size)
+{
+    if (alloc.block == nullptr || alloc.block->coherent || alloc.block->ptr == nullptr)
+    {
+        return;
+    }
+    VkMappedMemoryRange range = getMappedRange(alloc, offset, size);
+    VK_CHECK_RESULT(vkInvalidateMappedMemoryRanges(kDevice, 1, &range));
+}
+
+bool VkBlockAllocator::copy(VkBuffer src, VkDeviceSize src_offset, VkBuffer dst, VkDeviceSize dst_offset,
+                            VkDeviceSize size)
+{
+    NN_GPU_CALL();
+    std::lock_guard<std::mutex> lock(copyMtx);
+
+    VkCommandBuffer cmd_buffer;
+    VkCommandBufferAllocateInfo info = {};
+    info.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+    info.commandPool = copyPool;
+    info.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+    info.commandBufferCount = 1;
+    if (vkAllocateCommandBuffers(kDevice, &info, &cmd_buffer) != VK_SUCCESS)
+    {
+        LOGE("VkBlockAllocator: failed to allocate a command buffer for copy");
+        return false;
+    }
+
+    VkCommandBufferBeginInfo beginInfo = {};
+    beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+    beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+    VK_CHECK_RESULT(vkBeginCommandBuffer(cmd_buffer, &beginInfo));
+
+    VkBufferCopy region = {};
+    region.srcOffset = src_offset;
+    region.dstOffset = dst_offset;
+    region.size = size;
+    vkCmdCopyBuffer(cmd_buffer, src, dst, 1, &region);
+
+    // for the host reading a staging buffer back and the shaders reading an upload
+    VkMemoryBarrier barrier = {};
+    barrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+    barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+    barrier.dstAccessMask = VK_ACCESS_HOST_READ_BIT | VK_ACCESS_SHADER_READ_BIT;
+    vkCmdPipelineBarrier(cmd_buffer,
+                         VK_PIPELINE_STAGE_TRANSFER_BIT,
+                         VK_PIPELINE_STAGE_HOST_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                         0, 1, &barrier, 0, NULL, 0, NULL);
+    VK_CHECK_RESULT(vkEndCommandBuffer(cmd_buffer));
+
+    VkFence fence;
+    VkFenceCreateInfo fence_create_info = {};
+    fence_create_info.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
+    VK_CHECK_RESULT(vkCreateFence(kDevice, &fence_create_info, NULL, &fence));
+
+    VkSubmitInfo submit_info = {};
+    submit_info.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+    submit_info.commandBufferCount = 1;
+    submit_info.pCommandBuffers = &cmd_buffer;
+
+    VkResult res;
+    {
+        std::lock_guard<std::mutex> queueLock(kQueueMutex);
+        res = vkQueueSubmit(kQueue, 1, &submit_info, fence);
+    }
+    if (res == VK_SUCCESS)
+    {
+        res = vkWaitForFences(kDevice, 1, &fence, VK_TRUE, 100000000000);
+    }
+    vkDestroyFence(kDevice, fence, NULL);
+    vkFreeCommandBuffers(kDevice, copyPool, 1, &cmd_buffer);
+
+    if (res != VK_SUCCESS)
+    {
+        LOGE("VkBlockAllocator: copy of %llu bytes failed, result = %d", (unsigned long long)size, res);
+        return false;
+    }
+    return true;
+}
+
+NAME_SPACE_STOP
@@ -0,0 +1,120 @@
+/*
+ * Copyright @2017 Intel Corporation
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library. If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef ANDROID_HARDWARE_NEURALNETWORKS_V1_2_VK_BLOCK_ALLOCATOR_H
+#define ANDROID_HARDWARE_NEURALNETWORKS_V1_2_VK_BLOCK_ALLOCATOR_H
+
+#include <list>
+#include <map>
+#include <mutex>
+#include "vk_common.h"
+
+NAME_SPACE_BEGIN
+
+// what the memory of a buffer is used for, selects its memory type
+enum VkMemoryUsage
+{
+    kMemoryUsageHost = 0,   // written by the host and the shaders, HOST_VISIBLE | HOST_COHERENT
+    kMemoryUsageDevice,     // intermediates, constants and inputs, DEVICE_LOCAL
+    kMemoryUsageUpload,     // staging of the data written by the host
+    kMemoryUsageReadback,   // outputs and staging of the data read by the host, HOST_CACHED
+    kMemoryUsageNum,
+};
+
+// one VkDeviceMemory with a VkBuffer over all of it, mapped as long as it lives
+// if the memory is host visible
+struct VkMemoryBlock
+{
+    VkBuffer buffer;
+    VkDeviceMemory memory;
+    uint8_t* ptr;           // null when the host has to go through a staging buffer
+    VkDeviceSize size;
+    VkDeviceSize used;
+    VkMemoryUsage usage;
+    bool coherent;
+    bool dedicated;
+    bool imported;          // ptr is the host memory it was imported from, not a mapping
+    // offset -> size of the ranges not handed out, neighbours are merged
+    std::map<VkDeviceSize, VkDeviceSize> freeRanges;
+};
+
+// a range of one block, bound to the shaders as (block->buffer, offset, size)
+struct VkSubAllocation
+{
+    VkSubAllocation() : block(nullptr), offset(0), size(0) {}
+
+    VkMemoryBlock* block;
+    VkDeviceSize offset;
+    VkDeviceSize size;
+};
+
+// Process wide sub-allocator of the memory of the operands.
+// Ranges are served from large blocks (nn.gpgpu.vk_block_size in MB) and
+// recycled when they are freed, so a request does not allocate device memory
+// and the service stays far below maxMemoryAllocationCount. A range larger
+// than half a block gets a block of its own. Ranges are aligned to
+// minStorageBufferOffsetAlignment, so they can be bound at their offset.
+//
+// Each usage has blocks of its own memory type, picked by nn.gpgpu.vk_mem_policy:
+//   host   every usage in HOST_VISIBLE | HOST_COHERENT memory, as on integrated GPUs
+//   auto   by usage, device memory which is host visible too (unified memory)
+//          is mapped and written directly, the default
+//   device by usage and device memory is never mapped, so the staging copies
+//          also run on a software ICD whose memory is all host visible
+class VkBlockAllocator
+{
+public:
+    static void init();
+    static void deinit();
+    static bool allocate(VkDeviceSize size, VkMemoryUsage usage, VkSubAllocation& alloc);
+    static void free(VkSubAllocation& alloc);
+    // a block of its own over [ptr, ptr + size) of host memory, the range
+    // is widened to kImportAlignment, false if the memory cannot be imported
+    static bool import(uint8_t* ptr, VkDeviceSize size, VkSubAllocation& alloc);
+
+    // make host writes visible to the device and device writes visible to the host,
+    // nothing to do for coherent memory
+    static void flush(const VkSubAllocation& alloc, VkDeviceSize offset, VkDeviceSize size);
+    static void invalidate(const VkSubAllocation& alloc, VkDeviceSize offset, VkDeviceSize size);
+
+    // copies between two buffers in a command buffer of its own and waits for it,
+    // for the data not uploaded or read back within the submission of a request
+    static bool copy(VkBuffer src, VkDeviceSize src_offset, VkBuffer dst, VkDeviceSize dst_offset,
+                     VkDeviceSize size);
+
+private:
+    static VkMemoryBlock* createBlock(VkDeviceSize size, VkMemoryUsage usage, bool dedicated);
+    static void destroyBlock(VkMemoryBlock& block);
+    static bool allocateFrom(VkMemoryBlock& block, VkDeviceSize size, VkSubAllocation& alloc);
+
+    static std::list<VkMemoryBlock> blocks;
+    static std::mutex mtx;
+    static VkDeviceSize blockSize;
+    static VkDeviceSize alignment;
+    static uint32_t memoryTypes[kMemoryUsageNum];
+    static bool mapDevice;
+    static PFN_vkGetMemoryHostPointerPropertiesEXT getMemoryHostPointerProperties;
+
+    // for copy, a command pool must not be used on two threads at once
+    static VkCommandPool copyPool;
+    static std::mutex copyMtx;
+};
+
+NAME_SPACE_STOP
+
+#endif
@@ -15,78 +15,100 @@
  * License along with this library. If not, see <http://www.gnu.org/licenses/>.
  *
  */
+#include <algorithm>
+#include <vector>
 #include "vk_common.h"
 #include "vk_buffer.h"
 #include "vk_wrapper.h"
 
 NAME_SPACE_BEGIN
 
-static uint32_t findMemoryType(uint32_t memoryTypeBits, VkMemoryPropertyFlags properties)
-{
-    VkPhysicalDeviceMemoryProperties memoryProperties;
-
-    vkGetPhysicalDeviceMemoryProperties(kPhysicalDevice, &memoryProperties);
-
-    for (uint32_t i = 0; i < memoryProperties.memoryTypeCount; ++i) {
-        if ((memoryTypeBits & (1 << i)) &&
-                ((memoryProperties.memoryTypes[i].propertyFlags & properties) == properties))
-            return i;
-    }
-    return -1;
-}
-
 bool Buffer::init(const uint8_t* data)
 {
-    if (buffer != VK_NULL_HANDLE)
+    if (alloc.block != nullptr)
     {
         LOGW("Buffer object already inited\n");
         return false;
     }
 
-    VkBufferCreateInfo bufferCreateInfo = {};
-    bufferCreateInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
-    bufferCreateInfo.size = length;
-    bufferCreateInfo.usage = VK_BUFFER_USAGE_STORAGE_BUFFER_BIT;
-    bufferCreateInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
-    VK_CHECK_RESULT(vkCreateBuffer(device, &bufferCreateInfo, NULL, &buffer));
-
-    VkMemoryRequirements memoryRequirements;
-    vkGetBufferMemoryRequirements(device, buffer, &memoryRequirements);
-
-    VkMemoryAllocateInfo allocateInfo = {};
-    allocateInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
-    allocateInfo.allocationSize = memoryRequirements.size;
-    allocateInfo.memoryTypeIndex = findMemoryType(memoryRequirements.memoryTypeBits,
-                                                  VK_MEMORY_PROPERTY_HOST_COHERENT_BIT |
-                                                  VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT);
-    VK_CHECK_RESULT(vkAllocateMemory(device, &allocateInfo, NULL, &memory));
+    if (!VkBlockAllocator::allocate(length, usage, alloc))
+    {
+        LOGE("Buffer: failed to allocate %zu bytes", length);
+        return false;
+    }
 
     if (data)
     {
-        uint8_t* dst;
-        VK_CHECK_RESULT(vkMapMemory(device, memory, 0, length, 0, (void **)&dst));
         NN_GPU_DEBUG("call %s, userptr data is %f, size_in_bytes is %zu",
             __func__, 
             *(reinterpret_cast<const float *>(data)),
             length);
-        memcpy(dst, data, length);
-        vkUnmapMemory(device, memory);
+        return write(data, 0, length);
     }
-    VK_CHECK_RESULT(vkBindBufferMemory(device, buffer, memory, 0));
     return true;
 }
 
+bool Buffer::write(const void* data, const size_t offset, const size_t size)
+{
+    ASSERT(alloc.block != nullptr && offset + size <= length);
+
+    if (isMappable())
+    {
+        memcpy(map() + offset, data, size);
+        VkBlockAllocator::flush(alloc, offset, size);
+        unMap();
+        return true;
+    }
+
+    Buffer staging(size, reinterpret_cast<const uint8_t*>(data), kMemoryUsageUpload);
+    return VkBlockAllocator::copy(staging.getVkBuffer(), staging.getOffset(),
+                                  getVkBuffer(), getOffset() + offset, size);
+}
+
+bool Buffer::read(void* data, const size_t offset, const size_t size)
+{
+    ASSERT(alloc.block != nullptr && offset + size <= length);
+
+    if (isMappable())
+    {
+        VkBlockAllocator::invalidate(alloc, offset, size);
+        memcpy(data, map() + offset, size);
+        unMap();
+        return true;
+    }
+
+    Buffer staging(size, nullptr, kMemoryUsageReadback);
+    if (!VkBlockAllocator::copy(getVkBuffer(), getOffset() + offset,
+                                staging.getVkBuffer(), staging.getOffset(), size))
+    {
+        return false;
+    }
+    return staging.read(data, 0, size);
+}
+
+const uint8_t* Buffer::mapForRead(const size_t offset, const size_t size)
+{
+    ASSERT(alloc.block != nullptr && offset + size <= length);
+
+    if (!isMappable())
+    {
+        return nullptr;
+    }
+    VkBlockAllocator::invalidate(alloc, offset, size);
+    return map() + offset;
+}
+
 void Buffer::dump()
 {
-    if (memory != VK_NULL_HANDLE) {
-        uint8_t* data;
+    if (alloc.block != nullptr) {
+        std::vector<uint8_t> data(std::max<size_t>(length, 16 * sizeof(float)));
+        read(data.data(), 0, length);
 
-        VK_CHECK_RESULT(vkMapMemory(device, memory, 0, length, 0, (void **)&data));
         NN_GPU_DEBUG("call %s, userptr data is %f, size_in_bytes is %zu",
             __func__, 
-            *(reinterpret_cast<const float *>(data)),
+            *(reinterpret_cast<const float *>(data.data())),
             length);
-        const float* fp = reinterpret_cast<const float *>(data);
+        const float* fp = reinterpret_cast<const float *>(data.data());
         // only dump the first 16 float numberbs
         for (size_t i = 0; i < 15; ++i)
         {
@@ -94,7 +116,6 @@ void Buffer::dump()
                 fp[0], fp[1], fp[2], fp[3], fp[4], fp[5], fp[6], fp[7], fp[8], fp[9], fp[10], fp[11], fp[12],
                 fp[13], fp[14], fp[15]);
         }
-        vkUnmapMemory(device, memory);
     }
 }
 
@@ -114,13 +135,12 @@ void Buffer::dumpToFile(const char* fileName, const int channels)
         return;
     }
 
-    if (memory != VK_NULL_HANDLE)
+    if (alloc.block != nullptr)
     {
-        uint8_t* data;
-
-        VK_CHECK_RESULT(vkMapMemory(device, memory, 0, length, 0, (void **)&data));
+        std::vector<uint8_t> data(length);
+        read(data.data(), 0, length);
 
-        const float* fp = reinterpret_cast<const float *>(data);
+        const float* fp = reinterpret_cast<const float *>(data.data());
         int cur_c = 1;
         const size_t f_len = length / 4;
 
@@ -134,83 +154,77 @@ void Buffer::dumpToFile(const char* fileName, const int channels)
             }
             cur_c++;
         }
-        vkUnmapMemory(device, memory);
     }
 
     fclose(file_ptr);
 }
 
-Buffer::Buffer(size_t size_in_bytes, const uint8_t* data)
+Buffer::Buffer(size_t size_in_bytes, const uint8_t* data, VkMemoryUsage usage)
 {
-    device = kDevice;
-    buffer = VK_NULL_HANDLE;
-    memory = VK_NULL_HANDLE;
     length = size_in_bytes;
+    this->usage = usage;
     init(data);
 }
 
-Buffer::~Buffer()
+Buffer::Buffer() : length(0), usage(kMemoryUsageHost)
 {
-    vkFreeMemory(device, memory, NULL);
-    vkDestroyBuffer(device, buffer, NULL);
 }
 
-uint8_t* Buffer::map()
+Buffer* Buffer::import(uint8_t* ptr, size_t size_in_bytes)
 {
-    void *p;
-    ASSERT(memory != VK_NULL_HANDLE);
+    Buffer* buffer = new Buffer();
+    if (!VkBlockAllocator::import(ptr, size_in_bytes, buffer->alloc))
+    {
+        delete buffer;
+        return nullptr;
+    }
+    buffer->length = size_in_bytes;
+    // the host has written the data already
+    buffer->flush();
+    return buffer;
+}
 
-    VK_CHECK_RESULT(vkMapMemory(device, memory,
-                                0, length, 0, (void **)&p));
+Buffer::~Buffer()
+{
+    VkBlockAllocator::free(alloc);
+}
 
-    return (uint8_t*)p;
+uint8_t* Buffer::map()
+{
+    ASSERT(isMappable());
+    return alloc.block->ptr + alloc.offset;
 }
 
 void Buffer::unMap()
 {
-    vkUnmapMemory(device, memory);
 }
 
-void Buffer::resetForTune()
+void Buffer::resetForTune(const size_t offset, const size_t size)
 {
-    if (memory != VK_NULL_HANDLE)
-    {
-        uint8_t* data;
-        VK_CHECK_RESULT(vkMapMemory(device, memory, 0, length, 0, (void **)&data));
-
-        const size_t buf_size = length / 4;
-        float* fp = reinterpret_cast<float *>(data);
+    ASSERT(offset + size <= length);
 
+    if (alloc.block != nullptr)
+    {
         // reset output
-        for (size_t i = 0; i < buf_size; ++i)
-        {
-            fp[i] = 7.28f;
-        }
-
-        vkUnmapMemory(device, memory);
+        std::vector<float> fp(size / 4, 7.28f);
+        write(fp.data(), offset, fp.size() * sizeof(float));
     }
 }
 
-void Buffer::copyToBuffer(float* to_buf, const size_t buf_size)
+void Buffer::copyToBuffer(float* to_buf, const size_t buf_size, const size_t offset)
 {
     ASSERT(to_buf != nullptr && buf_size > 0);
 
-    if (memory != VK_NULL_HANDLE)
+    if (alloc.block != nullptr)
     {
-        uint8_t* data;
-        VK_CHECK_RESULT(vkMapMemory(device, memory, 0, length, 0, (void **)&data));
-
-        float* fp = reinterpret_cast<float*>(data);
-        if (buf_size <= length)
+        if (offset + buf_size <= length)
         {
-            memcpy(to_buf, fp, buf_size);
+            read(to_buf, offset, buf_size);
         }
         else
         {
             LOG(ERROR) << "copyToBuffer: buf_size is greater than vk buffer size";
         }
-
-        vkUnmapMemory(device, memory);
     }
 }
 
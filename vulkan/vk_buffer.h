@@ -20,29 +20,44 @@
 #define ANDROID_HARDWARE_NEURALNETWORKS_V1_2_VK_BUFFER_H
 
 #include <vulkan/vulkan.h>
+#include "vk_block_allocator.h"
 
 NAME_SPACE_BEGIN
 
 class Buffer
 {
 public:
-    Buffer(size_t size_in_bytes, const uint8_t* data);
+    Buffer(size_t size_in_bytes, const uint8_t* data, VkMemoryUsage usage = kMemoryUsageHost);
     ~Buffer();
+    // wraps host memory without a copy, nullptr if it cannot be imported
+    static Buffer* import(uint8_t* ptr, size_t size_in_bytes);
     void dump();
     void dumpToFile(const char* fileName = "img_data", const int channels = 0);
-    VkBuffer getVkBuffer() { return buffer; }
+    // the buffer of the whole block, the data starts at getOffset
+    VkBuffer getVkBuffer() { return alloc.block ? alloc.block->buffer : VK_NULL_HANDLE; }
+    VkDeviceSize getOffset() const { return alloc.offset; }
+    // false for device memory the host cannot map, read and write stage through a copy then
+    bool isMappable() const { return alloc.block != nullptr && alloc.block->ptr != nullptr; }
+    // makes what the host wrote into a mapped buffer visible to the device
+    void flush() { VkBlockAllocator::flush(alloc, 0, length); }
+    // the block stays mapped, unMap does nothing
     uint8_t* map();
     void unMap();
-    void resetForTune();
-    void copyToBuffer(float* to_buf, const size_t buf_size);
+    // host access to [offset, offset + size) whatever the memory type is
+    bool write(const void* data, const size_t offset, const size_t size);
+    bool read(void* data, const size_t offset, const size_t size);
+    // the mapping of the range ready to be read by the host, nullptr if the buffer is not mappable
+    const uint8_t* mapForRead(const size_t offset, const size_t size);
+    // only touch the range of one operand, the buffer may be the arena of the temporaries
+    void resetForTune(const size_t offset, const size_t size);
+    void copyToBuffer(float* to_buf, const size_t buf_size, const size_t offset = 0);
 
 private:
     Buffer();
     bool init(const uint8_t* data);
     size_t length;
-    VkDevice device;
-    VkBuffer buffer;
-    VkDeviceMemory memory;
+    VkMemoryUsage usage;
+    VkSubAllocation alloc;
 };
 
 NAME_SPACE_STOP
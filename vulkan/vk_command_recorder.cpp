@@ -0,0 +1,261 @@
+/*
+ * Copyright @2017 Intel Corporation
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library. If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "vk_common.h"
+#include "vk_wrapper.h"
+#include "vk_command_recorder.h"
+
+NAME_SPACE_BEGIN
+
+VkCommandRecorder::VkCommandRecorder(VkCommandPool pool):
+    cmd_pool(pool), query_pool(VK_NULL_HANDLE), timing(false), device_time(0),
+    recording(false), dispatch_num(0), generation(0)
+{
+    NN_GPU_CALL();
+    device = kDevice;
+
+    VkCommandBufferAllocateInfo info = {};
+    info.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+    info.commandPool = cmd_pool;
+    info.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+    info.commandBufferCount = 1;
+    VK_CHECK_RESULT(vkAllocateCommandBuffers(device, &info, &cmd_buffer));
+
+    VkFenceCreateInfo fence_create_info = {};
+    fence_create_info.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
+    fence_create_info.flags = 0;
+    VK_CHECK_RESULT(vkCreateFence(device, &fence_create_info, NULL, &fence));
+}
+
+VkCommandRecorder::~VkCommandRecorder()
+{
+    NN_GPU_CALL();
+    if (recording)
+    {
+        submit();
+    }
+    vkDestroyFence(device, fence, NULL);
+    if (query_pool != VK_NULL_HANDLE)
+    {
+        vkDestroyQueryPool(device, query_pool, NULL);
+    }
+    vkFreeCommandBuffers(device, cmd_pool, 1, &cmd_buffer);
+}
+
+void VkCommandRecorder::setTiming(bool enable)
+{
+    NN_GPU_CALL();
+    ASSERT(!recording);
+
+    timing = enable && kTimestampValidBits > 0;
+    device_time = 0;
+    if (timing && query_pool == VK_NULL_HANDLE)
+    {
+        VkQueryPoolCreateInfo info = {};
+        info.sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO;
+        info.queryType = VK_QUERY_TYPE_TIMESTAMP;
+        info.queryCount = 2;
+        if (vkCreateQueryPool(device, &info, NULL, &query_pool) != VK_SUCCESS)
+        {
+            LOGW("failed to create the timestamp query pool");
+            query_pool = VK_NULL_HANDLE;
+            timing = false;
+        }
+    }
+}
+
+void VkCommandRecorder::begin()
+{
+    NN_GPU_ENTRY();
+    ASSERT(!recording);
+
+    VkCommandBufferBeginInfo beginInfo = {};
+    beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+    beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+    VK_CHECK_RESULT(vkBeginCommandBuffer(cmd_buffer, &beginInfo));
+    if (timing)
+    {
+        vkCmdResetQueryPool(cmd_buffer, query_pool, 0, 2);
+        vkCmdWriteTimestamp(cmd_buffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, query_pool, 0);
+    }
+
+    recording = true;
+    dispatch_num = 0;
+    NN_GPU_EXIT();
+}
+
+void VkCommandRecorder::dispatch(VkPipeline pipeline, VkPipelineLayout pipeline_layout,
+                                 VkDescriptorSet descriptor_set,
+                                 void* push_constants, size_t push_constants_size,
+                                 uint32_t group_x, uint32_t group_y, uint32_t group_z)
+{
+    NN_GPU_ENTRY();
+    ASSERT(recording);
+
+    // the previous dispatch may produce the input of this one, or read
+    // an intermediate buffer which is reused as the output of this one
+    if (dispatch_num > 0)
+    {
+        VkMemoryBarrier barrier = {};
+        barrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+        barrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+        barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT;
+        vkCmdPipelineBarrier(cmd_buffer,
+                             VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                             VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                             0, 1, &barrier, 0, NULL, 0, NULL);
+    }
+
+    if (push_constants)
+        vkCmdPushConstants(cmd_buffer, pipeline_layout,
+                           VK_SHADER_STAGE_COMPUTE_BIT, 0,
+                           push_constants_size, push_constants);
+    vkCmdBindPipeline(cmd_buffer, VK_PIPELINE_BIND_POINT_COMPUTE, pipeline);
+    vkCmdBindDescriptorSets(cmd_buffer, VK_PIPELINE_BIND_POINT_COMPUTE,
+                            pipeline_layout, 0, 1, &descriptor_set, 0, NULL);
+    vkCmdDispatch(cmd_buffer, group_x, group_y, group_z);
+
+    ++dispatch_num;
+    NN_GPU_EXIT();
+}
+
+void VkCommandRecorder::copy(VkBuffer src, VkDeviceSize src_offset, VkBuffer dst, VkDeviceSize dst_offset,
+                             VkDeviceSize size)
+{
+    NN_GPU_ENTRY();
+    ASSERT(recording);
+
+    // the destination range may have been read or written by a previous dispatch
+    if (dispatch_num > 0)
+    {
+        VkMemoryBarrier barrier = {};
+        barrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+        barrier.srcAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT;
+        barrier.dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+        vkCmdPipelineBarrier(cmd_buffer,
+                             VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                             VK_PIPELINE_STAGE_TRANSFER_BIT,
+                             0, 1, &barrier, 0, NULL, 0, NULL);
+    }
+
+    VkBufferCopy region = {};
+    region.srcOffset = src_offset;
+    region.dstOffset = dst_offset;
+    region.size = size;
+    vkCmdCopyBuffer(cmd_buffer, src, dst, 1, &region);
+
+    VkMemoryBarrier barrier = {};
+    barrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+    barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+    barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT;
+    vkCmdPipelineBarrier(cmd_buffer,
+                         VK_PIPELINE_STAGE_TRANSFER_BIT,
+                         VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                         0, 1, &barrier, 0, NULL, 0, NULL);
+
+    // counted as a dispatch, so the command buffer is submitted
+    ++dispatch_num;
+    NN_GPU_EXIT();
+}
+
+bool VkCommandRecorder::submit()
+{
+    NN_GPU_ENTRY();
+    if (!recording)
+    {
+        return true;
+    }
+
+    bool ret = true;
+    if (dispatch_num > 0)
+    {
+        // make the results visible to the host before the fence is signaled
+        VkMemoryBarrier barrier = {};
+        barrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+        barrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+        barrier.dstAccessMask = VK_ACCESS_HOST_READ_BIT;
+        vkCmdPipelineBarrier(cmd_buffer,
+                             VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                             VK_PIPELINE_STAGE_HOST_BIT,
+                             0, 1, &barrier, 0, NULL, 0, NULL);
+    }
+    if (timing)
+    {
+        vkCmdWriteTimestamp(cmd_buffer, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, query_pool, 1);
+    }
+    VK_CHECK_RESULT(vkEndCommandBuffer(cmd_buffer));
+
+    if (dispatch_num > 0)
+    {
+        VkSubmitInfo submit_info = {};
+        submit_info.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+        submit_info.commandBufferCount = 1;
+        submit_info.pCommandBuffers = &cmd_buffer;
+
+        VkResult res;
+        {
+            std::lock_guard<std::mutex> lock(kQueueMutex);
+            res = vkQueueSubmit(kQueue, 1, &submit_info, fence);
+        }
+        if (res == VK_SUCCESS)
+        {
+            res = vkWaitForFences(device, 1, &fence, VK_TRUE, 100000000000);
+            vkResetFences(device, 1, &fence);
+        }
+        if (res == VK_SUCCESS && timing)
+        {
+            uint64_t ts[2] = {0, 0};
+            if (vkGetQueryPoolResults(device, query_pool, 0, 2, sizeof(ts), ts, sizeof(uint64_t),
+                                      VK_QUERY_RESULT_64_BIT | VK_QUERY_RESULT_WAIT_BIT) == VK_SUCCESS)
+            {
+                // timestamps only have timestampValidBits, the difference wraps around there
+                uint64_t mask = kTimestampValidBits < 64 ? (1ull << kTimestampValidBits) - 1 : ~0ull;
+                uint64_t ticks = (ts[1] - ts[0]) & mask;
+                device_time += static_cast<uint64_t>(ticks * (double)kDeviceProps.limits.timestampPeriod);
+            }
+            else
+            {
+                timing = false;
+            }
+        }
+        if (res != VK_SUCCESS)
+        {
+            LOGE("failed to execute the model command buffer, result = %d", res);
+            ret = false;
+        }
+        NN_GPU_DEBUG("submitted %u dispatches in one command buffer", dispatch_num);
+    }
+
+    recording = false;
+    dispatch_num = 0;
+    ++generation;
+    NN_GPU_EXIT();
+    return ret;
+}
+
+void VkCommandRecorder::flush()
+{
+    NN_GPU_CALL();
+    if (recording)
+    {
+        submit();
+        begin();
+    }
+}
+
+NAME_SPACE_STOP
@@ -0,0 +1,71 @@
+/*
+ * Copyright @2017 Intel Corporation
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library. If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef ANDROID_HARDWARE_NEURALNETWORKS_V1_2_VK_COMMAND_RECORDER_H
+#define ANDROID_HARDWARE_NEURALNETWORKS_V1_2_VK_COMMAND_RECORDER_H
+
+#include "vk_common.h"
+
+NAME_SPACE_BEGIN
+
+// Records the dispatches of all operations of one request into a single
+// command buffer, dispatches are serialized with pipeline barriers and the
+// whole buffer is submitted once and waited on with a single fence.
+class VkCommandRecorder
+{
+public:
+    VkCommandRecorder(VkCommandPool pool);
+    ~VkCommandRecorder();
+
+    void begin();
+    void dispatch(VkPipeline pipeline, VkPipelineLayout pipeline_layout, VkDescriptorSet descriptor_set,
+                  void* push_constants, size_t push_constants_size,
+                  uint32_t group_x, uint32_t group_y, uint32_t group_z);
+    // uploads src to dst ahead of the dispatches recorded after it
+    void copy(VkBuffer src, VkDeviceSize src_offset, VkBuffer dst, VkDeviceSize dst_offset, VkDeviceSize size);
+    bool submit();
+    void flush();
+    bool isRecording() const { return recording; }
+
+    // when timing, every submit is bracketed with timestamps and the GPU time
+    // is summed up, enabling it (again) restarts the sum, called before begin
+    void setTiming(bool enable);
+    bool isTiming() const { return timing; }
+    // nanoseconds
+    uint64_t getDeviceTime() const { return device_time; }
+
+    uint32_t getGeneration() const { return generation; }
+    // whether dispatches recorded in generation gen are not executed yet
+    bool isPending(uint32_t gen) const { return recording && gen == generation; }
+
+private:
+    VkDevice device;
+    VkCommandPool cmd_pool;
+    VkCommandBuffer cmd_buffer;
+    VkFence fence;
+    VkQueryPool query_pool;
+    bool timing;
+    uint64_t device_time;
+    bool recording;
+    uint32_t dispatch_num;
+    uint32_t generation;
+};
+
+NAME_SPACE_STOP
+
+#endif
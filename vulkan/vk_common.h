@@ -19,6 +19,7 @@
 #ifndef ANDROID_HARDWARE_NEURALNETWORKS_V1_2_VK_COMMON_H
 #define ANDROID_HARDWARE_NEURALNETWORKS_V1_2_VK_COMMON_H
 
+#include <mutex>
 #include <vulkan/vulkan.h>
 #include "../hal_types.h"
 #include "gpu_executor.h"
@@ -29,7 +30,14 @@ extern VkPhysicalDevice kPhysicalDevice;
 extern VkPhysicalDeviceProperties kDeviceProps;
 extern VkDevice kDevice;
 extern VkQueue kQueue;
-extern VkCommandPool kCmdPool;
+extern uint32_t kQueueFamilyIndex;
+// 0 when the compute queue cannot write timestamps
+extern uint32_t kTimestampValidBits;
+// kQueue is shared by the execution contexts of all models, submits must be serialized
+extern std::mutex kQueueMutex;
+// host memory can be imported (VK_EXT_external_memory_host), with this alignment of address and size
+extern bool kExternalMemoryHost;
+extern VkDeviceSize kImportAlignment;
 
 /* todo: change to conv, padding top/left is 1/2 padding_size, is it right? */
 inline void calculateExplicitPadding(int32_t in_size, int32_t stride,
@@ -16,10 +16,15 @@
  *
  */
 
+#include <algorithm>
 #include "vk_cs_executor.h"
 #include "vk_wrapper.h"
 #include "vk_op_base.h"
 #include "vk_cpu_timer.h"
+#include "vk_pipeline_cache.h"
+#include "vk_block_allocator.h"
+#include "compilation_cache.h"
+#include <cutils/properties.h>
 
 NAME_SPACE_BEGIN
 
@@ -33,11 +38,102 @@ VkPhysicalDevice kPhysicalDevice;
 VkPhysicalDeviceProperties kDeviceProps;
 VkDevice kDevice;
 VkQueue kQueue;
-VkCommandPool kCmdPool;
+std::mutex kQueueMutex;
 //VkDebugReportCallbackEXT kDebugReportCallback;
 uint32_t kQueueFamilyIndex;
+uint32_t kTimestampValidBits;
+bool kExternalMemoryHost = false;
+VkDeviceSize kImportAlignment = 0;
 //std::vector<const char *> kEnabledLayers;
 
+static bool hasExtension(const std::vector<VkExtensionProperties>& exts, const char* name)
+{
+    for (auto& ext : exts)
+    {
+        if (strcmp(ext.extensionName, name) == 0)
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+static std::vector<VkExtensionProperties> getInstanceExtensions()
+{
+    uint32_t count = 0;
+    vkEnumerateInstanceExtensionProperties(nullptr, &count, nullptr);
+    std::vector<VkExtensionProperties> exts(count);
+    if (count > 0)
+    {
+        vkEnumerateInstanceExtensionProperties(nullptr, &count, exts.data());
+    }
+    exts.resize(count);
+    return exts;
+}
+
+static std::vector<VkExtensionProperties> getDeviceExtensions()
+{
+    uint32_t count = 0;
+    vkEnumerateDeviceExtensionProperties(kPhysicalDevice, nullptr, &count, nullptr);
+    std::vector<VkExtensionProperties> exts(count);
+    if (count > 0)
+    {
+        vkEnumerateDeviceExtensionProperties(kPhysicalDevice, nullptr, &count, exts.data());
+    }
+    exts.resize(count);
+    return exts;
+}
+
+// the request pools are imported with VK_EXT_external_memory_host on Vulkan 1.0,
+// its dependencies are enabled with it, nn.gpgpu.vk_import=0 keeps copying them
+static void addExternalMemoryHostExtensions(const std::vector<VkExtensionProperties>& instanceExts,
+                                            std::vector<const char*>& instanceExt)
+{
+    char prop[PROPERTY_VALUE_MAX];
+    property_get("nn.gpgpu.vk_import", prop, "1");
+    if (prop[0] == '0' ||
+        !hasExtension(instanceExts, VK_KHR_GET_PHYSICAL_DEVICE_PROPERTIES_2_EXTENSION_NAME) ||
+        !hasExtension(instanceExts, VK_KHR_EXTERNAL_MEMORY_CAPABILITIES_EXTENSION_NAME))
+    {
+        return;
+    }
+    instanceExt.push_back(VK_KHR_GET_PHYSICAL_DEVICE_PROPERTIES_2_EXTENSION_NAME);
+    instanceExt.push_back(VK_KHR_EXTERNAL_MEMORY_CAPABILITIES_EXTENSION_NAME);
+    kExternalMemoryHost = true;
+}
+
+static void initExternalMemoryHost(std::vector<const char*>& deviceExt)
+{
+    if (!kExternalMemoryHost)
+    {
+        return;
+    }
+
+    std::vector<VkExtensionProperties> deviceExts = getDeviceExtensions();
+    auto getProperties2 = reinterpret_cast<PFN_vkGetPhysicalDeviceProperties2KHR>(
+        vkGetInstanceProcAddr(kInstance, "vkGetPhysicalDeviceProperties2KHR"));
+    if (!hasExtension(deviceExts, VK_KHR_EXTERNAL_MEMORY_EXTENSION_NAME) ||
+        !hasExtension(deviceExts, VK_EXT_EXTERNAL_MEMORY_HOST_EXTENSION_NAME) ||
+        getProperties2 == nullptr)
+    {
+        kExternalMemoryHost = false;
+        return;
+    }
+
+    VkPhysicalDeviceExternalMemoryHostPropertiesEXT hostProps = {};
+    hostProps.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_EXTERNAL_MEMORY_HOST_PROPERTIES_EXT;
+    VkPhysicalDeviceProperties2KHR props = {};
+    props.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PROPERTIES_2_KHR;
+    props.pNext = &hostProps;
+    getProperties2(kPhysicalDevice, &props);
+
+    kImportAlignment = hostProps.minImportedHostPointerAlignment;
+    deviceExt.push_back(VK_KHR_EXTERNAL_MEMORY_EXTENSION_NAME);
+    deviceExt.push_back(VK_EXT_EXTERNAL_MEMORY_HOST_EXTENSION_NAME);
+    NN_GPU_DEBUG("host memory is imported, minImportedHostPointerAlignment is %llu",
+                 (unsigned long long)kImportAlignment);
+}
+
 static uint32_t getComputeQueueFamilyIndex()
 {
     uint32_t queueFamilyCount;
@@ -56,6 +152,7 @@ static uint32_t getComputeQueueFamilyIndex()
 
         if (props.queueCount > 0 && (props.queueFlags & VK_QUEUE_COMPUTE_BIT))
         {
+            kTimestampValidBits = props.timestampValidBits;
             break;
         }
     }
@@ -99,6 +196,7 @@ bool VkCsExecutor::initPerProcess()
     instanceExt.push_back("VK_KHR_android_surface");
     deviceExt.push_back("VK_KHR_swapchain");
 #endif
+    addExternalMemoryHostExtensions(getInstanceExtensions(), instanceExt);
 
     // Create the Vulkan instance
     VkInstanceCreateInfo instanceCreateInfo{
@@ -151,6 +249,7 @@ bool VkCsExecutor::initPerProcess()
         kDeviceProps.limits.maxComputeWorkGroupCount[2]); 
 
     kQueueFamilyIndex = getComputeQueueFamilyIndex();
+    initExternalMemoryHost(deviceExt);
 	
     // Create a logical device from GPU we picked
     float priorities[] = { 1.0f };
@@ -182,14 +281,9 @@ bool VkCsExecutor::initPerProcess()
     // Get a handle to the only member of the queue family.
     vkGetDeviceQueue(kDevice, kQueueFamilyIndex, 0, &kQueue);
 
-    // create command pool
-    VkCommandPoolCreateInfo commandPoolCreateInfo = {};
-    commandPoolCreateInfo.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
-    commandPoolCreateInfo.flags = VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT;
-    // the queue family of this command pool. All command buffers allocated from this command pool,
-    // must be submitted to queues of this family ONLY.
-    commandPoolCreateInfo.queueFamilyIndex = kQueueFamilyIndex;
-    VK_CHECK_RESULT(vkCreateCommandPool(kDevice, &commandPoolCreateInfo, NULL, &kCmdPool));
+    // pipelines are still created without the cache if it is not available
+    VkPipelineCacheFile::init();
+    VkBlockAllocator::init();
 
     initialized = true;
 
@@ -202,14 +296,16 @@ void VkCsExecutor::deinitPerProcess()
 {
     NN_GPU_CALL();
 
-    vkDestroyCommandPool(kDevice, kCmdPool, NULL);
+    VkPipelineCacheFile::deinit();
+    VkBlockAllocator::deinit();
 	vkDestroyDevice(kDevice, nullptr);
 	vkDestroyInstance(kInstance, nullptr);
 	initialized = false;
 }
 
 VkCsExecutor::VkCsExecutor(const Model& model) :
-                        GpuExecutor(model)
+                        GpuExecutor(model), cmdPool(VK_NULL_HANDLE), prepareOnly(false), opCache(nullptr),
+                        asyncTune(false)
 {
 
 }
@@ -223,13 +319,187 @@ bool VkCsExecutor::initPerModel()
 {
     NN_GPU_CALL();
 
+    // command buffers of one pool must not be recorded on two threads at once,
+    // so each execution context (executor) allocates from a pool of its own
+    VkCommandPoolCreateInfo commandPoolCreateInfo = {};
+    commandPoolCreateInfo.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+    commandPoolCreateInfo.flags = VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT;
+    // the queue family of this command pool. All command buffers allocated from this command pool,
+    // must be submitted to queues of this family ONLY.
+    commandPoolCreateInfo.queueFamilyIndex = kQueueFamilyIndex;
+    VK_CHECK_RESULT(vkCreateCommandPool(kDevice, &commandPoolCreateInfo, NULL, &cmdPool));
+
     memMgr.initFromModel(model);
     initOperands();
     initOperationTimers();
+    // filled by loadCache when the model comes from the compilation cache
+    opCaches.resize(model.operations.size());
+    char async[PROPERTY_VALUE_MAX] = "0";
+    property_get("nn.gpgpu.async_tune", async, "0");
+    asyncTune = (async[0] == '1');
+    prepareOperations();
+    for (auto& cache : opCaches)
+    {
+        std::vector<uint8_t>().swap(cache.filter);
+    }
+
+    // the service is rarely shut down cleanly, keep the new pipelines on disk now
+    VkPipelineCacheFile::store();
+
+    // by default all dispatches of a request go to one command buffer, the per
+    // operation submission is kept for debugging and for the operation timers
+    char prop[PROPERTY_VALUE_MAX] = "0";
+    char timer[PROPERTY_VALUE_MAX] = "0";
+    property_get("nn.gpgpu.sync_per_op", prop, "0");
+    property_get("nn.gpgpu.timer", timer, "0");
+    if (prop[0] != '1' && timer[0] != '1')
+    {
+        recorder = std::make_shared<VkCommandRecorder>(cmdPool);
+    }
+    NN_GPU_DEBUG("submit %s", recorder ? "the whole model at once" : "per operation");
+
+    for (auto& op : opBases)
+    {
+        op->setRecorder(recorder);
+    }
+    memMgr.setRecorder(recorder.get());
+
+    return true;
+}
+
+void VkCsExecutor::prepareOperations()
+{
+    NN_GPU_CALL();
+
+    // create the descriptor sets, shader modules and pipelines of every
+    // operation once, the runs of the requests then only bind and dispatch
+    prepareOnly = true;
+
+    const size_t count = model.operations.size();
+    opBases.resize(count);
+    for (size_t i = 0; i < count; ++i)
+    {
+        const Operation& operation = model.operations[i];
+        opBases[i] = std::make_shared<VkOpBase>(cmdPool);
+
+        if (!canPrepare(operation))
+        {
+            NN_GPU_DEBUG("operation %zu is prepared on its first run", i);
+            continue;
+        }
+
+        opBase = opBases[i];
+        opCache = &opCaches[i];
+
+        bool ret = true;
+        switch (operation.type)
+        {
+
+#define SETUP_OP(op)                \
+        case OperationType::op:     \
+            ret = do##op(operation);\
+            break;
+#include "vk_setup_op.hxx"
+#undef SETUP_OP
+
+        default:
+            break;
+        }
+
+        if (!ret)
+        {
+            NN_GPU_DEBUG("failed to prepare operation %zu, retry on its first run", i);
+        }
+    }
+
+    opBase.reset();
+    opCache = nullptr;
+    prepareOnly = false;
+}
+
+#define VK_PLAN_MAGIC 0x4e4c504b    // "KPLN"
+#define VK_PLAN_VERSION 2
+
+bool VkCsExecutor::saveCache(std::vector<uint8_t>& plan, std::vector<uint8_t>& data)
+{
+    NN_GPU_CALL();
+
+    CacheWriter writer(plan);
+    writer.write<uint32_t>(VK_PLAN_MAGIC);
+    writer.write<uint32_t>(VK_PLAN_VERSION);
+    // tuned configs only hold for the device and driver they were tuned on
+    writer.write(kDeviceProps.vendorID);
+    writer.write(kDeviceProps.deviceID);
+    writer.write(kDeviceProps.driverVersion);
+    writer.write<uint32_t>(opCaches.size());
+
+    for (size_t i = 0; i < opCaches.size(); ++i)
+    {
+        uint64_t filter_offset = data.size();
+        uint64_t filter_size = 0;
+
+        // the filter a CONV_2D runs on when it is not the operand of the model,
+        // the chn4 one of a 3 channel conv, the packed or the Winograd one, see convolve
+        if (opBases[i]->filter_index >= 0)
+        {
+            VkOperand& filter = opBases[i]->tmp_operands[opBases[i]->filter_index];
+            filter_size = filter.size();
+            data.resize(filter_offset + filter_size);
+            filter.copyToBuffer(reinterpret_cast<float*>(data.data() + filter_offset), filter_size);
+        }
+
+        // a heuristic config waiting for runIdle is not a compiled plan
+        bool pending = std::find(pendingTunes.begin(), pendingTunes.end(), i) != pendingTunes.end();
+        writer.write(pending ? VkOpCache().shader_type : opCaches[i].shader_type);
+        writer.write(pending ? ShaderConfig() : opCaches[i].config);
+        writer.write(filter_offset);
+        writer.write(filter_size);
+    }
+    memMgr.savePlan(writer);
 
     return true;
 }
 
+bool VkCsExecutor::loadCache(const std::vector<uint8_t>& plan, const std::vector<uint8_t>& data)
+{
+    NN_GPU_CALL();
+
+    CacheReader reader(plan);
+    uint32_t magic = 0, version = 0, vendor_id = 0, device_id = 0, driver_version = 0, count = 0;
+    if (!reader.read(magic) || !reader.read(version) ||
+        !reader.read(vendor_id) || !reader.read(device_id) || !reader.read(driver_version) ||
+        !reader.read(count) ||
+        magic != VK_PLAN_MAGIC || version != VK_PLAN_VERSION ||
+        vendor_id != kDeviceProps.vendorID || device_id != kDeviceProps.deviceID ||
+        driver_version != kDeviceProps.driverVersion ||
+        count != model.operations.size())
+    {
+        NN_GPU_DEBUG("vulkan plan is from another device, driver or version");
+        return false;
+    }
+
+    opCaches.resize(count);
+    for (auto& cache : opCaches)
+    {
+        uint64_t filter_offset = 0, filter_size = 0;
+        if (!reader.read(cache.shader_type) || !reader.read(cache.config) ||
+            !reader.read(filter_offset) || !reader.read(filter_size) ||
+            filter_offset > data.size() || filter_size > data.size() - filter_offset)
+        {
+            opCaches.clear();
+            return false;
+        }
+        cache.filter.assign(data.begin() + filter_offset, data.begin() + filter_offset + filter_size);
+    }
+
+    if (!memMgr.loadPlan(reader, model) || !reader.empty())
+    {
+        opCaches.clear();
+        return false;
+    }
+    return true;
+}
+
 void VkCsExecutor::initOperationTimers()
 {
     operationTimers.resize(model.operations.size());
@@ -272,7 +542,22 @@ void VkCsExecutor::deinitPerModel()
 
     showOperationTimers();
 
+    opBase.reset();
+    opBases.clear();
+    opCaches.clear();
+    // the operations are gone, runIdle must not tune them
+    pendingTunes.clear();
+    memMgr.setRecorder(nullptr);
+    recorder.reset();
     memMgr.clean();
+    if (cmdPool != VK_NULL_HANDLE)
+    {
+        vkDestroyCommandPool(kDevice, cmdPool, NULL);
+        cmdPool = VK_NULL_HANDLE;
+    }
+
+    // pipelines created on the first runs, e.g. for tuned convolutions
+    VkPipelineCacheFile::store();
 }
 
 bool VkCsExecutor::initPerExecThread()
@@ -346,8 +631,6 @@ bool VkCsExecutor::run(const Operation& operation, OperationCpuTimer* timer)
 
     bool ret = true;
 
-	opBase.reset(new VkOpBase());
-
     switch (operation.type)
     {
 
@@ -378,25 +661,74 @@ bool VkCsExecutor::run(const Operation& operation, OperationCpuTimer* timer)
     return ret;
 }
 
-bool VkCsExecutor::run(const Request& request)
+bool VkCsExecutor::run(const Request& request, MeasureTiming measure, uint64_t& timeOnDevice)
 {
     restoreOperands();
     memMgr.resetFromRequest(request);
     setArgOperands(request);
+
+    // the device time is only measured around the model command buffer,
+    // not when every dispatch is submitted on its own
+    timeOnDevice = UINT64_MAX;
+    if (recorder)
+    {
+        recorder->setTiming(measure == MeasureTiming::YES);
+        recorder->begin();
+    }
+
+    bool ret = true;
     for (size_t i = 0; i < model.operations.size(); ++i)
     {
         const Operation& operation = model.operations[i];
         NN_GPU_DEBUG("run loop on Operation %d", operation.type);
         OperationCpuTimer* timer = &operationTimers[i];
+        opBase = opBases[i];
+        opCache = &opCaches[i];
         if (!run(operation, timer))
         {
-            return false;
+            ret = false;
+            break;
         }
     }
+
+    if (recorder)
+    {
+        ret = recorder->submit() && ret;
+        if (recorder->isTiming())
+        {
+            timeOnDevice = recorder->getDeviceTime() / 1000;
+        }
+    }
+
+    if (!ret)
+    {
+        return false;
+    }
     memMgr.sync();
     return true;
 }
 
+bool VkCsExecutor::runIdle()
+{
+    if (pendingTunes.empty())
+    {
+        return false;
+    }
+
+    // one operation at a time, the next request waits for its tuning at most
+    size_t index = pendingTunes.front();
+    pendingTunes.erase(pendingTunes.begin());
+    if (!retuneOperation(index))
+    {
+        LOGW("failed to tune operation %zu, keep its heuristic config", index);
+    }
+    else
+    {
+        VkPipelineCacheFile::store();
+    }
+    return !pendingTunes.empty();
+}
+
 void VkCsExecutor::getCapabilities(V1_0::Capabilities &cap)
 {
     NN_GPU_CALL();
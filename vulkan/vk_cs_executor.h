@@ -19,6 +19,7 @@
 #ifndef ANDROID_HARDWARE_NEURALNETWORKS_V1_2_VK_CS_EXECUTOR_H
 #define ANDROID_HARDWARE_NEURALNETWORKS_V1_2_VK_CS_EXECUTOR_H
 
+#include <functional>
 #include "gpu_executor.h"
 #include "vk_operand.h"
 #include "vk_memory_manager.h"
@@ -53,6 +54,17 @@ public:
     int block_depth;
 };
 
+// compiled plan of one operation, kept in the compilation cache
+struct VkOpCache
+{
+public:
+    VkOpCache(): shader_type(-1) {};
+
+    int shader_type;                // conv shader type, -1 until it is selected
+    ShaderConfig config;
+    std::vector<uint8_t> filter;    // cached chn4, packed or Winograd filter, only kept until it is uploaded
+};
+
 struct VkConvSpecializedConst {
 public:
     VkConvSpecializedConst():
@@ -106,17 +118,37 @@ public:
 
     bool initPerModel() override;
     bool initPerExecThread() override;
-    bool run(const Request& request) override;
+    bool run(const Request& request, MeasureTiming measure, uint64_t& timeOnDevice) override;
+    bool runIdle() override;
+    void invalidatePool(const hidl_memory& pool) override { memMgr.invalidatePool(pool); }
     void deinitPerExecThread() override;
     void deinitPerModel() override;
+    bool saveCache(std::vector<uint8_t>& plan, std::vector<uint8_t>& data) override;
+    bool loadCache(const std::vector<uint8_t>& plan, const std::vector<uint8_t>& data) override;
     std::string getOpName(const Operation& operation);
 
 private:
+    // everything below is the state of one execution context, a prepared model runs
+    // concurrent requests on executors of its own, which share the compiled plan only
+    VkCommandPool cmdPool;
     //cannot be a global memMgr per process since the gl objects belong to one context (_ctx)
     VkMemoryManager memMgr;
     std::vector<VkOperand> operands;
     std::vector<OperationCpuTimer> operationTimers;
     std::shared_ptr<VkOpBase> opBase;
+    // one op object per operation, pipelines and descriptor sets live as long as the model
+    std::vector<std::shared_ptr<VkOpBase>> opBases;
+    // set while initPerModel builds the op objects, nothing is bound or dispatched then
+    bool prepareOnly;
+    // compiled plan of each operation and the one of the current operation
+    std::vector<VkOpCache> opCaches;
+    VkOpCache* opCache;
+    // null when every dispatch is submitted and waited on its own (nn.gpgpu.sync_per_op)
+    std::shared_ptr<VkCommandRecorder> recorder;
+    // with nn.gpgpu.async_tune a conv not tuned yet runs with a heuristic config,
+    // the operations listed here are tuned by runIdle between the requests
+    bool asyncTune;
+    std::vector<size_t> pendingTunes;
 
     void initOperands();
     void restoreOperands();
@@ -126,6 +158,8 @@ private:
     void showOperationTimers();
     void deinitOperationResources();
 
+    void prepareOperations();
+
     bool run(const Operation& operation, OperationCpuTimer* timer);
 
     bool doEleWise(const Operation& operation, const int type);
@@ -134,20 +168,53 @@ private:
     bool doPool(const Operation& operation, ShaderConfig& config, const int type);
 
     // for convolve tuning
-    void tune(VkConvSpecializedConst& param, ShaderConfig& conf,
+    // the conv shader type is passed along, type selects the shader to run
+    // and tune/prepareShaderConfig/tryShaderConfig return the selected one in it
+    // false when no candidate verified, conf is a heuristic one then
+    bool tune(VkConvSpecializedConst& param, int& type, ShaderConfig& conf, long& tuned_us,
               VkOperand& in, VkOperand& filter, VkOperand& bias, VkOperand& out);
-    bool tuning_convolve(VkConvSpecializedConst& param,
+    bool createTuningPipeline(VkConvSpecializedConst& param, const int type, const ShaderConfig& conf,
+                              VkOperand& in, VkOperand& filter, VkOperand& bias, VkOperand& out);
+    void dispatchTuningConvolve(VkConvSpecializedConst& param, const int type);
+    bool tuning_convolve(VkConvSpecializedConst& param, const int type,
                          const ShaderConfig& conf,
                          VkOperand& in, VkOperand& filter, VkOperand& bias, VkOperand& out);
-    bool tryShaderConfig(VkConvSpecializedConst& param,
-                         ShaderConfig& best, const std::vector<ShaderConfig>& configs,
+    bool timeRuns(const std::function<bool()>& run, long& elapsed_us);
+    bool timeConvolve(VkConvSpecializedConst& param, const int type, const ShaderConfig& conf,
+                      VkOperand& in, VkOperand& filter, VkOperand& bias, VkOperand& out,
+                      long& elapsed_us);
+    bool tryShaderConfig(VkConvSpecializedConst& param, const std::vector<int>& types,
+                         const std::vector<ShaderConfig>& configs, int& type, ShaderConfig& best, long& best_us,
                          VkOperand& in, VkOperand& filter, VkOperand& bias, VkOperand& out);
-    void prepareShaderConfig(VkConvSpecializedConst& convParam, ShaderConfig& conf,
+    // times the candidates the cost model ranks first, the others only if none of them verifies
+    bool tryRankedShaderConfig(VkConvSpecializedConst& param, const std::vector<int>& types,
+                               const std::vector<ShaderConfig>& configs, int& type, ShaderConfig& best,
+                               long& best_us, VkOperand& in, VkOperand& filter, VkOperand& bias, VkOperand& out);
+    // false when a heuristic config was selected and the operation is left to runIdle
+    bool prepareShaderConfig(VkConvSpecializedConst& convParam, int& type, ShaderConfig& conf,
                              VkOperand& in, VkOperand& filter, VkOperand& bias, VkOperand& out);
-    bool verifyShader(VkConvSpecializedConst& param, ShaderConfig& conf,
+    // times GEMM_4_4_CHN3 on the 3 channel input against the 4 channel config behind
+    // the conversion of the input, keeps the faster one under the 3 channel signature
+    // and in opCache, true when it is GEMM_4_4_CHN3
+    bool prepareChn3Config(VkConvSpecializedConst& param,
+                           VkOperand& in, VkOperand& filter, VkOperand& bias, VkOperand& out);
+    // selects GEMM_4_8_PACKED for a GEMM_4_8_GENERIC config and adds the packed filter to tmp_operands
+    void preparePackedFilter(const VkConvSpecializedConst& param, const bool converted, VkOperand& filter);
+    // selects WINOGRAD for a 3x3 stride 1 conv when it is faster than the tuned config,
+    // false when the operation is left to runIdle
+    bool prepareWinograd(VkConvSpecializedConst& param, VkOperand& in, VkOperand& filter,
+                         VkOperand& bias, VkOperand& out, const bool tune);
+    bool tuneWinograd(VkConvSpecializedConst& param, VkOpBase& input, VkOpBase& output,
+                      ShaderConfig& conf, VkOperand& in, VkOperand& filter, VkOperand& bias,
+                      VkOperand& out, VkOperand& u, VkOperand& v, VkOperand& m);
+    std::shared_ptr<VkOpBase> createWinogradTransform(VkConvSpecializedConst param, const int type);
+    void dispatchWinograd(VkOpBase& input, VkOpBase& output);
+    bool retuneOperation(size_t index);
+    bool verifyShader(VkConvSpecializedConst& param, const int type, ShaderConfig& conf,
                       VkOperand& in, VkOperand& filter, VkOperand& bias, VkOperand& out);
     bool verifyResult(VkConvSpecializedConst& param,
-                      float* in_buffer, float* filter_buffer, float* bias_buffer, float* result_buffer);
+                      float* in_buffer, float* filter_buffer, float* bias_buffer, float* result_buffer,
+                      float tolerance = 0.1f);
 
 #define SETUP_OP(op) bool do##op(const Operation& operation);
 #include "vk_setup_op.hxx"
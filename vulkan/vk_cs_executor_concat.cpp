@@ -49,9 +49,6 @@ bool VkCsExecutor::doCONCATENATION(const Operation& operation)
 {
     NN_GPU_ENTRY();
 
-#define BUFFER_NUM 2
-    opBase->initVulkanThing(BUFFER_NUM);
-
     ASSERT(operation.type == OperationType::CONCATENATION);
     const hidl_vec<uint32_t>& ins  = operation.inputs;
     const hidl_vec<uint32_t>& outs = operation.outputs;
@@ -61,6 +58,11 @@ bool VkCsExecutor::doCONCATENATION(const Operation& operation)
     }
 
     int32_t numInputTensors = ins.size() - 1;
+
+    // the inputs are copied one by one, each dispatch gets its own descriptor set
+#define BUFFER_NUM 2
+    opBase->initVulkanThing(BUFFER_NUM, numInputTensors);
+
     int32_t axis            = operands[ins[numInputTensors]].getScalarData<int32_t>();
     VkOperand& firstInput   = operands[ins[0]];
     uint32_t numDims        = firstInput.getNumberOfDimensions();
@@ -124,6 +126,12 @@ bool VkCsExecutor::doCONCATENATION(const Operation& operation)
         opBase->createPipeline(sizeof(ConcatParam));
     }
 
+    if (prepareOnly)
+    {
+        NN_GPU_EXIT();
+        return true;
+    }
+
     NN_GPU_DEBUG("VkCsExecutor::doCONCATENATION: param out_concat_axis is %d, concat_size is %d",
         param.out_concat_axis, param.concat_size);
 
@@ -133,6 +141,7 @@ bool VkCsExecutor::doCONCATENATION(const Operation& operation)
     {
         NN_GPU_DEBUG("VkCsExecutor::doCONCATENATION: bind operands");
 
+        opBase->descriptor_set = opBase->descriptor_sets[i];
         opBase->bindOperand(operands[ins[i]], 0, opBase->descriptor_set);
         opBase->bindOperand(output, 1, opBase->descriptor_set);
 
@@ -17,10 +17,13 @@
  */
 
 #include <math.h>
+#include <algorithm>
 #include <cutils/properties.h>
 #include "gpu_executor.h"
+#include "conv_cost_model.h"
 #include "vk_common.h"
 #include "vk_cs_executor.h"
+#include "vk_tuning_db.h"
 #include "shader/spv_shader.h"
 
 NAME_SPACE_BEGIN
@@ -38,6 +41,10 @@ NAME_SPACE_BEGIN
 #define SPEC_CONST_NUM 21
 #define ITEMS_PER_WI 16
 
+// the output rows below which, and the K from which, split-K is tuned
+#define SPLIT_K_MAX_M 64
+#define SPLIT_K_MIN_K 512
+
 #include <sys/time.h>
 
 #define TIMER_START(start)        \
@@ -61,7 +68,20 @@ enum ConvShaderType
     CONV_SHADER_TYPE_GEMM_4_4_CHN3       = 4,
     CONV_SHADER_TYPE_GEMM_4_8_GENERIC    = 5,
     CONV_SHADER_TYPE_CHN3_TO_CHN4        = 6,
-    CONV_SHADER_TYPE_NUM                 = 7
+    // GEMM_4_8_GENERIC on a filter packed when the model is prepared, tuned as
+    // GEMM_4_8_GENERIC and only selected by preparePackedFilter
+    CONV_SHADER_TYPE_GEMM_4_8_PACKED     = 7,
+    // Winograd F(4x4, 3x3) for 3x3 stride 1 convs, the 36 GEMMs of the transformed
+    // tiles, the input and output transforms run as sub ops and are never selected,
+    // see prepareWinograd
+    CONV_SHADER_TYPE_WINOGRAD            = 8,
+    CONV_SHADER_TYPE_WINOGRAD_INPUT      = 9,
+    CONV_SHADER_TYPE_WINOGRAD_OUTPUT     = 10,
+    // one output element a work group, K split across its invocations
+    CONV_SHADER_TYPE_GEMM_SPLIT_K        = 11,
+    // gemm 4x4 on the im2col and filter tiles shared by the work group
+    CONV_SHADER_TYPE_GEMM_IMPLICIT       = 12,
+    CONV_SHADER_TYPE_NUM                 = 13
 };
 
 enum FusedActivationFunctionType { kNone, kRelu, kRelu1, kRelu6 };
@@ -74,14 +94,26 @@ public:
 
 using ShaderConfigPair = std::pair<std::string, std::string>;
 using ShaderConfigMap  = std::map<std::string, std::string>;
-using TuningTimeMap    = std::map<long, int>;
 
+// a tuning candidate, the median of its runs and its work groups
+struct TimedConfig
+{
+    long elapsed_us;
+    long groups;
+    size_t index;
+};
+
+#define TUNE_WARMUP_RUNS 1
+#define TUNE_RUNS 5
+// candidates within this percentage of the fastest are ranked by their work groups
+#define TUNE_NOISE_PERCENT 3
+
+// mtx guards the map, the signature locks and is_initialized, a signature lock
+// is held while its conv is tuned so the convs of other signatures go on
 static std::mutex mtx;
 static ShaderConfigMap shaderConfigMap;
+static std::map<std::string, std::shared_ptr<std::mutex>> signatureLocks;
 static bool is_initialized = false;
-static int tmpBoSize = 0;
-static int shader_type = CONV_SHADER_TYPE_BASIC;
-static bool converted_to_chn4 = false;
 
 static const char* defaultConfig[] =
 {
@@ -344,6 +376,82 @@ static void configToString(const ShaderConfig& conf, std::string& str)
     str = ss.str();
 }
 
+static std::string genShaderConfigString(const int type, const ShaderConfig& conf)
+{
+    std::stringstream ss;
+    ss << "type" << type << "_"
+       << "lsz" << conf.local_size_x << "_" << conf.local_size_y << "_" << conf.local_size_z << "_"
+       << "block" << conf.block_width << "_" << conf.block_height << "_" << conf.block_depth;
+    return ss.str();
+}
+
+// the SPIR-V of the conv shader of a type, for convolve and tuning_convolve
+static bool getConvShader(const int type, const uint32_t*& spv, size_t& size)
+{
+    switch (type)
+    {
+    case CONV_SHADER_TYPE_BASIC:
+        spv  = conv_spv;
+        size = sizeof(conv_spv);
+        break;
+    case CONV_SHADER_TYPE_GEMM1:
+        spv  = conv_gemm1_spv;
+        size = sizeof(conv_gemm1_spv);
+        break;
+    case CONV_SHADER_TYPE_GEMM_4_4_NO_IMG2COL:
+        spv  = conv_gemmShader4_4_no_img2col_spv;
+        size = sizeof(conv_gemmShader4_4_no_img2col_spv);
+        break;
+    case CONV_SHADER_TYPE_GEMM_4_4_GENERIC:
+        spv  = conv_gemmShader4_4_spv;
+        size = sizeof(conv_gemmShader4_4_spv);
+        break;
+    case CONV_SHADER_TYPE_GEMM_4_4_CHN3:
+        spv  = conv_gemmShader4_4_chn3_spv;
+        size = sizeof(conv_gemmShader4_4_chn3_spv);
+        break;
+    case CONV_SHADER_TYPE_GEMM_4_8_GENERIC:
+        spv  = conv_gemmShader4_8_spv;
+        size = sizeof(conv_gemmShader4_8_spv);
+        break;
+    case CONV_SHADER_TYPE_GEMM_4_8_PACKED:
+        spv  = conv_gemmShader4_8_packed_spv;
+        size = sizeof(conv_gemmShader4_8_packed_spv);
+        break;
+    case CONV_SHADER_TYPE_GEMM_IMPLICIT:
+        spv  = conv_gemm_implicit_spv;
+        size = sizeof(conv_gemm_implicit_spv);
+        break;
+    case CONV_SHADER_TYPE_GEMM_SPLIT_K:
+        spv  = conv_gemm_split_k_spv;
+        size = sizeof(conv_gemm_split_k_spv);
+        break;
+    case CONV_SHADER_TYPE_WINOGRAD:
+        spv  = conv_winograd_gemm_spv;
+        size = sizeof(conv_winograd_gemm_spv);
+        break;
+    case CONV_SHADER_TYPE_WINOGRAD_INPUT:
+        spv  = conv_winograd_input_spv;
+        size = sizeof(conv_winograd_input_spv);
+        break;
+    case CONV_SHADER_TYPE_WINOGRAD_OUTPUT:
+        spv  = conv_winograd_output_spv;
+        size = sizeof(conv_winograd_output_spv);
+        break;
+    case CONV_SHADER_TYPE_CHN3_TO_CHN4:
+    default:
+        NOT_REACH_HERE;
+        return false;
+    }
+    return true;
+}
+
+// the 4x4 output tiles of Winograd F(4x4, 3x3) of all batches
+static inline int winogradTiles(const VkConvSpecializedConst& param)
+{
+    return param.batch * ((param.out_h + 3) / 4) * ((param.out_w + 3) / 4);
+}
+
 static bool computeGroupCount(int& gx, int& gy, int& gz, const int type,
                               const VkConvSpecializedConst& param, const ShaderConfig& conf)
 {
@@ -374,14 +482,16 @@ static bool computeGroupCount(int& gx, int& gy, int& gz, const int type,
         gz = param.batch;
         break;
     }
-    case CONV_SHADER_TYPE_GEMM_4_4_GENERIC: {
+    case CONV_SHADER_TYPE_GEMM_4_4_GENERIC:
+    case CONV_SHADER_TYPE_GEMM_IMPLICIT: {
         ASSERT(conf.block_width == 4 && conf.block_height == 4 && conf.block_depth == 1 && conf.local_size_z == 1);
         gx = alignSize(param.n / 4, conf.local_size_x) / conf.local_size_x;
         gy = alignSize(alignSize(param.m, 4) / 4, conf.local_size_y) / conf.local_size_y;
         gz = param.batch;
         break;
     }
-    case CONV_SHADER_TYPE_GEMM_4_8_GENERIC: {
+    case CONV_SHADER_TYPE_GEMM_4_8_GENERIC:
+    case CONV_SHADER_TYPE_GEMM_4_8_PACKED: {
         ASSERT(conf.block_width == 8 && conf.block_height == 4 && conf.block_depth == 1 && conf.local_size_z == 1);
         gx = alignSize(param.n / conf.block_width, conf.local_size_x) / conf.local_size_x;
         gy = alignSize(alignSize(param.m, 4) / 4, conf.local_size_y) / conf.local_size_y;
@@ -396,6 +506,33 @@ static bool computeGroupCount(int& gx, int& gy, int& gz, const int type,
         gz = param.batch;
         break;
     }
+    case CONV_SHADER_TYPE_GEMM_SPLIT_K: {
+        ASSERT(conf.local_size_y == 1 && conf.local_size_z == 1);
+        gx = param.n;
+        gy = param.m;
+        gz = param.batch;
+        break;
+    }
+    case CONV_SHADER_TYPE_WINOGRAD: {
+        // 4 tiles by 4 output channels an invocation, one GEMM of the 36 in z
+        ASSERT(conf.block_width == 4 && conf.block_height == 4 && conf.block_depth == 1 && conf.local_size_z == 1);
+        gx = alignSize(param.n / 4, conf.local_size_x) / conf.local_size_x;
+        gy = alignSize(alignSize(winogradTiles(param), 4) / 4, conf.local_size_y) / conf.local_size_y;
+        gz = 36;
+        break;
+    }
+    case CONV_SHADER_TYPE_WINOGRAD_INPUT: {
+        gx = alignSize(param.channels, conf.local_size_x) / conf.local_size_x;
+        gy = alignSize(winogradTiles(param), conf.local_size_y) / conf.local_size_y;
+        gz = 1;
+        break;
+    }
+    case CONV_SHADER_TYPE_WINOGRAD_OUTPUT: {
+        gx = alignSize(param.n / 4, conf.local_size_x) / conf.local_size_x;
+        gy = alignSize(winogradTiles(param), conf.local_size_y) / conf.local_size_y;
+        gz = 1;
+        break;
+    }
     default:
         NOT_REACH_HERE;
         break;
@@ -420,10 +557,6 @@ static std::vector<ShaderConfig> genShaderConfigCandidates(VkConvSpecializedCons
     int group_x, group_y, group_z;
     std::vector<ShaderConfig> candidates;
 
-    // int M = param.out_h * param.out_w;
-    // int N = param.n;
-    int K = param.filter_h * param.filter_w;
-
     ShaderConfig conf;
 
     if (type == CONV_SHADER_TYPE_GEMM_4_8_GENERIC)
@@ -440,7 +573,6 @@ static std::vector<ShaderConfig> genShaderConfigCandidates(VkConvSpecializedCons
         conf.block_width  = 8;
         conf.block_height = 4;
         conf.block_depth  = 1;
-        shader_type       = CONV_SHADER_TYPE_GEMM_4_8_GENERIC;
 
         for (int ly = 1; ly < 8; ++ly)
         {
@@ -464,9 +596,136 @@ static std::vector<ShaderConfig> genShaderConfigCandidates(VkConvSpecializedCons
             }
         }
     }
+    else if (type == CONV_SHADER_TYPE_GEMM_4_4_GENERIC || type == CONV_SHADER_TYPE_GEMM_4_4_NO_IMG2COL)
+    {
+        if (param.channels % 4 != 0 || param.n % 4 != 0)
+        {
+            return candidates;
+        }
+        if (type == CONV_SHADER_TYPE_GEMM_4_4_NO_IMG2COL && needImg2Col(param))
+        {
+            return candidates;
+        }
+
+        param.local_sz_z  = 1;
+        conf.local_size_z = 1;
+        conf.block_width  = 4;
+        conf.block_height = 4;
+        conf.block_depth  = 1;
+
+        for (int lx = 1; lx <= 256; lx *= 4)
+        {
+            for (int ly = 1; ly <= 256; ly *= 4)
+            {
+                conf.local_size_x = lx;
+                conf.local_size_y = ly;
+
+                param.local_sz_x = lx;
+                param.local_sz_y = ly;
+
+                if (computeGroupCount(group_x, group_y, group_z, type, param, conf))
+                {
+                    candidates.push_back(conf);
+                }
+            }
+        }
+    }
+    else if (type == CONV_SHADER_TYPE_GEMM_IMPLICIT)
+    {
+        if (param.channels % 4 != 0 || param.n % 4 != 0)
+        {
+            return candidates;
+        }
+
+        param.local_sz_z  = 1;
+        conf.local_size_z = 1;
+        conf.block_width  = 4;
+        conf.block_height = 4;
+        conf.block_depth  = 1;
+
+        // a work group loads 4 * ly im2col rows and 4 * lx filter rows into
+        // shared memory, smaller ones share too little to pay for the barriers
+        for (int lx = 4; lx <= 16; lx *= 2)
+        {
+            for (int ly = 4; ly <= 16; ly *= 2)
+            {
+                conf.local_size_x = lx;
+                conf.local_size_y = ly;
+
+                param.local_sz_x = lx;
+                param.local_sz_y = ly;
+
+                if (computeGroupCount(group_x, group_y, group_z, CONV_SHADER_TYPE_GEMM_IMPLICIT, param, conf))
+                {
+                    candidates.push_back(conf);
+                }
+            }
+        }
+    }
+    else if (type == CONV_SHADER_TYPE_GEMM_SPLIT_K)
+    {
+        // only worth it when there are too few output rows to keep the GPU busy
+        // and a long K to split, e.g. a 1x1 classifier over 2048 channels
+        if (param.channels % 4 != 0 || param.m > SPLIT_K_MAX_M || param.k < SPLIT_K_MIN_K)
+        {
+            return candidates;
+        }
+
+        param.local_sz_y  = 1;
+        param.local_sz_z  = 1;
+        conf.local_size_y = 1;
+        conf.local_size_z = 1;
+        conf.block_width  = 1;
+        conf.block_height = 1;
+        conf.block_depth  = 1;
+
+        // a power of 2 for the reduction in shared memory
+        for (int lx = 32; lx <= 256 && lx <= param.k / 4; lx *= 2)
+        {
+            conf.local_size_x = lx;
+            param.local_sz_x  = lx;
+
+            if (computeGroupCount(group_x, group_y, group_z, CONV_SHADER_TYPE_GEMM_SPLIT_K, param, conf))
+            {
+                candidates.push_back(conf);
+            }
+        }
+    }
+    else if (type == CONV_SHADER_TYPE_GEMM_4_4_CHN3)
+    {
+        // reads the 3 channel input and filter as they are, so no tail of output rows
+        if (param.channels != 3 || param.m % 4 != 0 || param.n % 4 != 0)
+        {
+            return candidates;
+        }
+
+        param.local_sz_z  = 1;
+        conf.local_size_z = 1;
+        conf.block_width  = 4;
+        conf.block_height = 4;
+        conf.block_depth  = 1;
+
+        for (int lx = 1; lx <= 256; lx *= 4)
+        {
+            for (int ly = 1; ly <= 256; ly *= 4)
+            {
+                conf.local_size_x = lx;
+                conf.local_size_y = ly;
+
+                param.local_sz_x = lx;
+                param.local_sz_y = ly;
+
+                if (computeGroupCount(group_x, group_y, group_z, CONV_SHADER_TYPE_GEMM_4_4_CHN3, param, conf))
+                {
+                    candidates.push_back(conf);
+                }
+            }
+        }
+    }
     else if (type == CONV_SHADER_TYPE_GEMM1)
     {
-        if (needImg2Col(param) || K % 4 != 0)
+        // K is channels * filter_h * filter_w, 1x1 convs read it as vec4s
+        if (needImg2Col(param) || param.k % 4 != 0)
         {
             return candidates;
         }
@@ -475,7 +734,6 @@ static std::vector<ShaderConfig> genShaderConfigCandidates(VkConvSpecializedCons
         conf.block_width  = 1;
         conf.block_height = 1;
         conf.block_depth  = 1;
-        shader_type       = CONV_SHADER_TYPE_GEMM1;
 
         for (int lx = 1; lx <= 256; lx *= 4)
         {
@@ -496,8 +754,6 @@ static std::vector<ShaderConfig> genShaderConfigCandidates(VkConvSpecializedCons
     }
     else if (type == CONV_SHADER_TYPE_BASIC)
     {
-        shader_type = CONV_SHADER_TYPE_BASIC;
-
         conf.block_width  = 1;
         conf.block_height = 1;
         conf.block_depth  = 1;
@@ -532,6 +788,43 @@ static std::vector<ShaderConfig> genShaderConfigCandidates(VkConvSpecializedCons
     return candidates;
 }
 
+// what a candidate dispatches, for the cost model. A work group reads the K long
+// rows of its block of output rows and filter columns, the invocations sharing
+// one hit the cache (or shared memory for GEMM_IMPLICIT)
+static ConvWorkload describeWorkload(const int type, VkConvSpecializedConst param, const ShaderConfig& conf)
+{
+    param.local_sz_x = conf.local_size_x;
+    param.local_sz_y = conf.local_size_y;
+    param.local_sz_z = conf.local_size_z;
+
+    ConvWorkload workload = {};
+    int gx, gy, gz;
+    if (!computeGroupCount(gx, gy, gz, type, param, conf))
+    {
+        return workload;
+    }
+
+    const double K       = param.k;
+    const double outputs = conf.block_width * conf.block_height * conf.block_depth;
+    const double rows    = conf.local_size_y * conf.block_height * conf.local_size_z * conf.block_depth;
+    const double cols    = conf.local_size_x * conf.block_width;
+
+    workload.groups      = (long)gx * gy * gz;
+    workload.invocations = conf.local_size_x * conf.local_size_y * conf.local_size_z;
+
+    if (type == CONV_SHADER_TYPE_GEMM_SPLIT_K)
+    {
+        // one output a work group, its invocations take vec4 steps of K in turn
+        workload.flops = 2.0 * alignSize(param.k, 4 * conf.local_size_x) * workload.groups;
+        workload.bytes = sizeof(float) * workload.groups * (2 * K + 1);
+        return workload;
+    }
+
+    workload.flops       = 2.0 * K * outputs * workload.invocations * workload.groups;
+    workload.bytes       = sizeof(float) * workload.groups * (K * (rows + cols) + outputs * workload.invocations);
+    return workload;
+}
+
 static void setSpecInfo(VkSpecializationMapEntry* entry,
                         VkSpecializationInfo& spec_info,
                         const VkConvSpecializedConst& spec_const,
@@ -712,18 +1005,9 @@ static void convCpuBhwc(float* in_buffer, float* bias_buffer, float* filter_buff
     return;
 }
 
-static bool fake_loadConfig()
-{
-    return false;
-}
-
-static void fake_storeConfig()
-{
-    return;
-}
-
 bool VkCsExecutor::verifyResult(VkConvSpecializedConst& param,
-                                float* in_buffer, float* filter_buffer, float* bias_buffer, float* result_buffer)
+                                float* in_buffer, float* filter_buffer, float* bias_buffer, float* result_buffer,
+                                float tolerance)
 {
     int batch      = param.batch;
     int in_c       = param.channels;
@@ -762,8 +1046,9 @@ bool VkCsExecutor::verifyResult(VkConvSpecializedConst& param,
                 {
                     int offset = b * (out_c * out_h * out_w) + h * (out_w * out_c) + w * out_c + c;
 
-                    if ((fabs(p_out[offset] - benchmark[offset]) > 0.1 * fabs(benchmark[offset])) ||
-                        !((fabs(benchmark[offset]) < 1.e-3) && (fabs(p_out[offset] - benchmark[offset]) < 1.e-4)))
+                    // wrong by more than the relative tolerance, unless both are about zero
+                    if (fabs(p_out[offset] - benchmark[offset]) > tolerance * fabs(benchmark[offset]) &&
+                        !(fabs(benchmark[offset]) < 1.e-3 && fabs(p_out[offset] - benchmark[offset]) < 1.e-4))
                     {
                         NN_GPU_DEBUG("CONV_2D: convolution verification failed at (%d, %d, %d, %d), actual: %f, expected: %f\n",
                                 b, h, w, c, p_out[offset], benchmark[offset]);
@@ -780,7 +1065,7 @@ bool VkCsExecutor::verifyResult(VkConvSpecializedConst& param,
     return true;
 }
 
-bool VkCsExecutor::verifyShader(VkConvSpecializedConst& param, ShaderConfig& conf,
+bool VkCsExecutor::verifyShader(VkConvSpecializedConst& param, const int type, ShaderConfig& conf,
                                 VkOperand& in, VkOperand& filter, VkOperand& bias, VkOperand& out)
 {
     std::string conf_str;
@@ -790,13 +1075,13 @@ bool VkCsExecutor::verifyShader(VkConvSpecializedConst& param, ShaderConfig& con
 
     bool ret = false;
 
-    if (!tuning_convolve(param, conf, in, filter, bias, out))
+    if (!tuning_convolve(param, type, conf, in, filter, bias, out))
     {
         LOG(ERROR) << "VkCsExecutor::verifyShader tuning_convolve failed.";
         return ret;
     }
 
-    const int input_size  = param.batch * param.in_h * param.out_w * param.channels;
+    const int input_size  = param.batch * param.in_h * param.in_w * param.channels;
     const int output_size = param.batch * param.out_h * param.out_w * param.n;
     const int filter_size = param.n * param.filter_h * param.filter_w * param.channels;
     const int bias_size   = param.n;
@@ -821,51 +1106,36 @@ bool VkCsExecutor::verifyShader(VkConvSpecializedConst& param, ShaderConfig& con
     return ret;
 }
 
-bool VkCsExecutor::tuning_convolve(VkConvSpecializedConst& param, const ShaderConfig& conf,
-                                   VkOperand& in, VkOperand& filter, VkOperand& bias, VkOperand& out)
+// the pipeline of a candidate, its operands bound and its group count set,
+// timeConvolve dispatches it for every run
+bool VkCsExecutor::createTuningPipeline(VkConvSpecializedConst& param, const int type, const ShaderConfig& conf,
+                                        VkOperand& in, VkOperand& filter, VkOperand& bias, VkOperand& out)
 {
     VkSpecializationInfo spec_info;
     VkSpecializationMapEntry entry[SPEC_CONST_NUM];
     setSpecInfo(entry, spec_info, param, SPEC_CONST_NUM);
 
-    switch (shader_type)
+    const uint32_t* spv;
+    size_t spv_size;
+    if (!getConvShader(type, spv, spv_size))
     {
-    case CONV_SHADER_TYPE_GEMM_4_8_GENERIC: {
-        opBase->createShaderModule(conv_gemmShader4_8_spv, sizeof(conv_gemmShader4_8_spv));
-        opBase->createPipeline(sizeof(PushConst), &spec_info);
-        break;
-    }
-    case CONV_SHADER_TYPE_GEMM1: {
-        opBase->createShaderModule(conv_gemm1_spv, sizeof(conv_gemm1_spv));
-        opBase->createPipeline(sizeof(PushConst), &spec_info);
-        break;
-    }
-    case CONV_SHADER_TYPE_BASIC: {
-        // todo: shaders of gemm_4_4, gemm_no_mig2col and gemm_4_4_chn3 are not added yet
-        opBase->createShaderModule(conv_spv, sizeof(conv_spv));
-        opBase->createPipeline(sizeof(PushConst), &spec_info);
-        break;
-    }
-    case CONV_SHADER_TYPE_CHN3_TO_CHN4:
-    case CONV_SHADER_TYPE_GEMM_4_4_NO_IMG2COL:
-    case CONV_SHADER_TYPE_GEMM_4_4_GENERIC:
-    case CONV_SHADER_TYPE_GEMM_4_4_CHN3:
-    default: {
-        NOT_REACH_HERE;
-    }
+        return false;
     }
+    opBase->resetPipeline();
+    opBase->createShaderModule(spv, spv_size);
+    opBase->createPipeline(sizeof(PushConst), &spec_info);
 
     opBase->bindOperand(in, 0, opBase->descriptor_set);
     opBase->bindOperand(filter, 1, opBase->descriptor_set);
     opBase->bindOperand(bias, 2, opBase->descriptor_set);
     opBase->bindOperand(out, 3, opBase->descriptor_set);
 
-    if (!computeGroupCount(opBase->group_x, opBase->group_y, opBase->group_z, shader_type, param, conf))
-    {
-        return false;
-    }
+    return computeGroupCount(opBase->group_x, opBase->group_y, opBase->group_z, type, param, conf);
+}
 
-    if (shader_type == CONV_SHADER_TYPE_BASIC)
+void VkCsExecutor::dispatchTuningConvolve(VkConvSpecializedConst& param, const int type)
+{
+    if (type == CONV_SHADER_TYPE_BASIC)
     {
         int partition_num = (int)ceil(1.0 * param.n / opBase->group_y);
         for (int b = 0; b < param.batch; b++)
@@ -882,25 +1152,109 @@ bool VkCsExecutor::tuning_convolve(VkConvSpecializedConst& param, const ShaderCo
         opBase->recordCommandBuffer((void*)&param, sizeof(PushConst));
         opBase->runCommandBuffer();
     }
+}
+
+bool VkCsExecutor::tuning_convolve(VkConvSpecializedConst& param, const int type, const ShaderConfig& conf,
+                                   VkOperand& in, VkOperand& filter, VkOperand& bias, VkOperand& out)
+{
+    if (!createTuningPipeline(param, type, conf, in, filter, bias, out))
+    {
+        return false;
+    }
+    dispatchTuningConvolve(param, type);
+    return true;
+}
+
+// the median time of TUNE_RUNS calls of run after TUNE_WARMUP_RUNS, each call
+// is recorded into a command buffer of its own bracketed with timestamps, so the
+// time is the one of the dispatches on the GPU without the submission and the
+// fence wait, those are in the wall time taken when there are no timestamps
+bool VkCsExecutor::timeRuns(const std::function<bool()>& run, long& elapsed_us)
+{
+    std::shared_ptr<VkCommandRecorder> timer;
+    if (kTimestampValidBits > 0)
+    {
+        timer = std::make_shared<VkCommandRecorder>(opBase->cmd_pool);
+    }
+
+    std::vector<long> samples;
+    for (int i = 0; i < TUNE_WARMUP_RUNS + TUNE_RUNS; ++i)
+    {
+        bool ret;
+        long t;
+        if (timer)
+        {
+            timer->setTiming(true);
+            timer->begin();
+            opBase->setRecorder(timer);
+            ret = run();
+            opBase->setRecorder(nullptr);
+            ret = timer->submit() && ret;
+            if (ret && !timer->isTiming())
+            {
+                // the query results were not available, time the submits from now on
+                timer.reset();
+                continue;
+            }
+            t = timer->getDeviceTime() / 1000;
+        }
+        else
+        {
+            TIMER_START(conv_time);
+            ret = run();
+            t = TIMER_STOP(conv_time);
+        }
+
+        if (!ret)
+        {
+            return false;
+        }
+        if (i >= TUNE_WARMUP_RUNS)
+        {
+            samples.push_back(t);
+        }
+    }
 
+    if (samples.empty())
+    {
+        return false;
+    }
+    std::sort(samples.begin(), samples.end());
+    elapsed_us = samples[samples.size() / 2];
+    NN_GPU_DEBUG("CONV_2D: %s: %s median %ld us, min %ld us", __func__,
+                 timer ? "GPU time" : "wall time", elapsed_us, samples[0]);
     return true;
 }
 
-bool VkCsExecutor::tryShaderConfig(VkConvSpecializedConst& param,
-                                   ShaderConfig& best,
+bool VkCsExecutor::timeConvolve(VkConvSpecializedConst& param, const int type, const ShaderConfig& conf,
+                                VkOperand& in, VkOperand& filter, VkOperand& bias, VkOperand& out,
+                                long& elapsed_us)
+{
+    // the pipeline is built once, the runs only record and submit its dispatches
+    if (!createTuningPipeline(param, type, conf, in, filter, bias, out))
+    {
+        return false;
+    }
+    return timeRuns([&]() { dispatchTuningConvolve(param, type); return true; }, elapsed_us);
+}
+
+// candidate i is configs[i] of the shader types[i], type and best are set to the
+// fastest candidate that verifies
+bool VkCsExecutor::tryShaderConfig(VkConvSpecializedConst& param, const std::vector<int>& types,
                                    const std::vector<ShaderConfig>& configs,
+                                   int& type, ShaderConfig& best, long& best_us,
                                    VkOperand& in, VkOperand& filter, VkOperand& bias, VkOperand& out)
 {
-    NN_GPU_PERF("CONV_2D: %s: try shader type: %d\n", __func__, shader_type);
+    ASSERT(types.size() == configs.size());
 
     bool ret = false;
     ShaderConfig conf;
     std::string conf_str;
-    TuningTimeMap time_map;
+    std::vector<TimedConfig> timed;
 
     for (size_t i = 0; i < configs.size(); i ++)
     {
-        long elapsed_us, t;
+        long elapsed_us;
 
         param.local_sz_x   = configs[i].local_size_x;
         param.local_sz_y   = configs[i].local_size_y;
@@ -914,86 +1268,199 @@ bool VkCsExecutor::tryShaderConfig(VkConvSpecializedConst& param,
         conf.block_height  = configs[i].block_height;
         conf.block_depth   = configs[i].block_depth;
 
-        // warm up
-        ret = tuning_convolve(param, conf, in, filter, bias, out);
-        if (ret == false)
-        {
-            continue;
-        }
-
-        TIMER_START(conv_time);
-        ret = tuning_convolve(param, conf, in, filter, bias, out);
-        t = TIMER_STOP(conv_time);
-
-        if (ret)
+        if (timeConvolve(param, types[i], conf, in, filter, bias, out, elapsed_us))
         {
-            elapsed_us = t;
-
             configToString(configs[i], conf_str);
-            NN_GPU_PERF("CONV_2D: %s: tune: %8.3f ms, %s\n", __func__, 1.0 * elapsed_us / 1000, conf_str.c_str());
+            NN_GPU_PERF("CONV_2D: %s: tune: %8.3f ms, shader type %d, %s\n", __func__, 1.0 * elapsed_us / 1000,
+                        types[i], conf_str.c_str());
 
-            std::pair<long, int> entry(elapsed_us, i);
-            time_map.insert(entry);
-        }
-        else
-        {
-            elapsed_us = std::numeric_limits<long>::max();
+            int gx, gy, gz;
+            computeGroupCount(gx, gy, gz, types[i], param, conf);
+            TimedConfig entry = { elapsed_us, (long)gx * gy * gz, i };
+            timed.push_back(entry);
         }
     }
 
-    for (TuningTimeMap::iterator it = time_map.begin(); it != time_map.end(); ++it)
+    // fastest first, but the candidates within the noise of the fastest are
+    // taken in the order of their work groups, fewer first
+    std::stable_sort(timed.begin(), timed.end(),
+                     [](const TimedConfig& a, const TimedConfig& b) { return a.elapsed_us < b.elapsed_us; });
+    if (!timed.empty())
     {
-        ShaderConfig candidate = configs[it->second];
+        const long limit = timed[0].elapsed_us + timed[0].elapsed_us * TUNE_NOISE_PERCENT / 100;
+        auto noisy = std::find_if(timed.begin(), timed.end(),
+                                  [limit](const TimedConfig& c) { return c.elapsed_us > limit; });
+        std::stable_sort(timed.begin(), noisy,
+                         [](const TimedConfig& a, const TimedConfig& b) { return a.groups < b.groups; });
+    }
+
+    for (auto it = timed.begin(); it != timed.end(); ++it)
+    {
+        ShaderConfig candidate = configs[it->index];
 
         param.local_sz_x   = candidate.local_size_x;
         param.local_sz_y   = candidate.local_size_y;
         param.local_sz_z   = candidate.local_size_z;
 
-        conf.block_width   = candidate.block_width;
-        conf.block_height  = candidate.block_height;
-        conf.block_depth   = candidate.block_depth;
-
         configToString(candidate, conf_str);
         out.resetForTune();
 
-        if (verifyShader(param, candidate, in, filter, bias, out))
+        if (verifyShader(param, types[it->index], candidate, in, filter, bias, out))
         {
+            // the fastest one that is right
+            type = types[it->index];
             best = candidate;
+            best_us = it->elapsed_us;
             ret = true;
+            break;
         }
     }
 
     return ret;
 }
 
-void VkCsExecutor::tune(VkConvSpecializedConst& param, ShaderConfig& conf,
-                        VkOperand& in, VkOperand& filter, VkOperand& bias, VkOperand& out)
+bool VkCsExecutor::tryRankedShaderConfig(VkConvSpecializedConst& param, const std::vector<int>& types,
+                                         const std::vector<ShaderConfig>& configs,
+                                         int& type, ShaderConfig& best, long& best_us,
+                                         VkOperand& in, VkOperand& filter, VkOperand& bias, VkOperand& out)
 {
-    bool succeed = false;
-    std::vector<ShaderConfig> configs;
-
-    if (!succeed)
+    const int max_invocations = kDeviceProps.limits.maxComputeWorkGroupInvocations;
+    std::vector<double> costs;
+    for (size_t i = 0; i < configs.size(); ++i)
     {
-        configs = genShaderConfigCandidates(param, CONV_SHADER_TYPE_GEMM_4_8_GENERIC);
-        succeed = tryShaderConfig(param, conf, configs, in, filter, bias, out);
+        costs.push_back(ConvCostModel::estimate(describeWorkload(types[i], param, configs[i]), max_invocations));
     }
 
-    if (!succeed)
-    {
-        configs = genShaderConfigCandidates(param, CONV_SHADER_TYPE_GEMM1);
-        succeed = tryShaderConfig(param, conf, configs, in, filter, bias, out);
-    }
+    std::vector<size_t> kept, rest;
+    ConvCostModel::prune(costs, types, kept, rest);
 
-    if (!succeed)
+    std::vector<int> ranked_types;
+    std::vector<ShaderConfig> ranked;
+    for (size_t i : kept)
     {
-        std::string sig = genConvSignature(param);
-        NN_GPU_PERF("CONV_2D: %s: %s fallback to basic shader, THIS MAY HAVE POOR PERFORMANCE !\n", __func__, sig.c_str());
-        configs = genShaderConfigCandidates(param, CONV_SHADER_TYPE_BASIC);
-        succeed = tryShaderConfig(param, conf, configs, in, filter, bias, out);
+        ranked_types.push_back(types[i]);
+        ranked.push_back(configs[i]);
     }
-
-    ASSERT(succeed);
-    return;
+    bool ret = tryShaderConfig(param, ranked_types, ranked, type, best, best_us, in, filter, bias, out);
+    if (ret)
+    {
+        // with nn.gpgpu.tune_top_k=0 all are timed, this is how well the model ranks them
+        const std::string best_str = genShaderConfigString(type, best);
+        for (size_t i = 0; i < ranked.size(); ++i)
+        {
+            if (genShaderConfigString(ranked_types[i], ranked[i]) == best_str)
+            {
+                NN_GPU_PERF("CONV_2D: %s: cost model ranked the tuned config %zu of %zu timed, %zu skipped\n",
+                            __func__, i + 1, ranked.size(), rest.size());
+                break;
+            }
+        }
+        return true;
+    }
+
+    if (!rest.empty())
+    {
+        NN_GPU_PERF("CONV_2D: %s: no top ranked config verified, time the others\n", __func__);
+        ranked_types.clear();
+        ranked.clear();
+        for (size_t i : rest)
+        {
+            ranked_types.push_back(types[i]);
+            ranked.push_back(configs[i]);
+        }
+        ret = tryShaderConfig(param, ranked_types, ranked, type, best, best_us, in, filter, bias, out);
+    }
+    return ret;
+}
+
+// the shader types tune tries, the ones of a pass are timed against each other
+// and a pass is only tried when none of the earlier ones verified
+static const std::vector<std::vector<ConvShaderType>> tunePasses =
+{
+    {CONV_SHADER_TYPE_GEMM_4_8_GENERIC, CONV_SHADER_TYPE_GEMM_4_4_CHN3,
+     CONV_SHADER_TYPE_GEMM_IMPLICIT, CONV_SHADER_TYPE_GEMM_SPLIT_K},
+    {CONV_SHADER_TYPE_GEMM_4_4_GENERIC, CONV_SHADER_TYPE_GEMM_4_4_NO_IMG2COL},
+    {CONV_SHADER_TYPE_GEMM1},
+    {CONV_SHADER_TYPE_BASIC},
+};
+
+// the config a conv runs with until it is tuned: of the candidates of the first
+// pass of tune that has any, the one the cost model ranks first
+static bool heuristicConfig(const VkConvSpecializedConst& param, int& type, ShaderConfig& conf)
+{
+    for (const std::vector<ConvShaderType>& pass : tunePasses)
+    {
+        double best = std::numeric_limits<double>::max();
+        for (ConvShaderType t : pass)
+        {
+            VkConvSpecializedConst p = param;
+            std::vector<ShaderConfig> configs = genShaderConfigCandidates(p, t);
+            for (const ShaderConfig& c : configs)
+            {
+                double cost = ConvCostModel::estimate(describeWorkload(t, param, c),
+                                                      kDeviceProps.limits.maxComputeWorkGroupInvocations);
+                if (cost < best)
+                {
+                    best = cost;
+                    type = t;
+                    conf = c;
+                }
+            }
+        }
+        if (best < std::numeric_limits<double>::max())
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool VkCsExecutor::tune(VkConvSpecializedConst& param, int& type, ShaderConfig& conf, long& tuned_us,
+                        VkOperand& in, VkOperand& filter, VkOperand& bias, VkOperand& out)
+{
+    bool succeed = false;
+
+    for (const std::vector<ConvShaderType>& pass : tunePasses)
+    {
+        std::vector<int> types;
+        std::vector<ShaderConfig> configs;
+        for (ConvShaderType t : pass)
+        {
+            std::vector<ShaderConfig> c = genShaderConfigCandidates(param, t);
+            types.insert(types.end(), c.size(), t);
+            configs.insert(configs.end(), c.begin(), c.end());
+        }
+        if (configs.empty())
+        {
+            continue;
+        }
+
+        if (pass[0] == CONV_SHADER_TYPE_BASIC)
+        {
+            std::string sig = genConvSignature(param);
+            NN_GPU_PERF("CONV_2D: %s: %s fallback to basic shader, THIS MAY HAVE POOR PERFORMANCE !\n",
+                        __func__, sig.c_str());
+        }
+        succeed = tryRankedShaderConfig(param, types, configs, type, conf, tuned_us, in, filter, bias, out);
+        if (succeed)
+        {
+            break;
+        }
+    }
+
+    if (!succeed)
+    {
+        // a driver bug or a shape none of the shaders handles, do not take the service down
+        std::string sig = genConvSignature(param);
+        LOGE("CONV_2D: %s: no config of %s verified, use the heuristic one", __func__, sig.c_str());
+        if (!heuristicConfig(param, type, conf))
+        {
+            type = CONV_SHADER_TYPE_BASIC;
+            conf = ShaderConfig(1, 1, 1, 1, 1, 1);
+        }
+        tuned_us = std::numeric_limits<long>::max();
+    }
+    return succeed;
 }
 
 static bool chn3ToChn4(VkConvSpecializedConst& param, ShaderConfig& config)
@@ -1039,75 +1506,712 @@ static void prepareConfig(const Operation& operation, ShaderConfig& config)
     (void)(config);
 }
 
-static void string2Config(const char* confString, ShaderConfig &conf)
+static bool string2Config(const char* confString, int& type, ShaderConfig &conf)
 {
-    sscanf(confString, "type%d_lsz%d_%d_%d_block%d_%d_%d",
-           &shader_type, &conf.local_size_x,  &conf.local_size_y, &conf.local_size_z,
-           &conf.block_width, &conf.block_height, &conf.block_depth);
+    if (sscanf(confString, "type%d_lsz%d_%d_%d_block%d_%d_%d",
+               &type, &conf.local_size_x,  &conf.local_size_y, &conf.local_size_z,
+               &conf.block_width, &conf.block_height, &conf.block_depth) != 7)
+    {
+        LOGW("CONV_2D: string2Config: invalid config %s", confString);
+        return false;
+    }
 
     NN_GPU_DEBUG("CONV_2D: string2Config shader type is %d, local_size_x %d, local_size_y %d, local_size_z %d, "
                  "block_width %d, block_height %d, block_depth %d",
-                 shader_type, conf.local_size_x, conf.local_size_y,
+                 type, conf.local_size_x, conf.local_size_y,
                  conf.local_size_z, conf.block_width, conf.block_height, conf.block_depth);
+    return true;
 }
 
-void VkCsExecutor::prepareShaderConfig(VkConvSpecializedConst& param, ShaderConfig& conf,
+// a config read from the tuning db must be one tuning would pick for the signature
+// on this device, the file may be edited, truncated or written by another version
+static bool isValidTunedConfig(const VkConvSpecializedConst& param, const int type, const ShaderConfig& conf)
+{
+    switch (type)
+    {
+    case CONV_SHADER_TYPE_BASIC:
+    case CONV_SHADER_TYPE_GEMM1:
+    case CONV_SHADER_TYPE_GEMM_4_4_NO_IMG2COL:
+    case CONV_SHADER_TYPE_GEMM_4_4_GENERIC:
+    case CONV_SHADER_TYPE_GEMM_4_4_CHN3:
+    case CONV_SHADER_TYPE_GEMM_4_8_GENERIC:
+    case CONV_SHADER_TYPE_GEMM_SPLIT_K:
+    case CONV_SHADER_TYPE_GEMM_IMPLICIT:
+        break;
+    default:
+        return false;
+    }
+
+    const VkPhysicalDeviceLimits& limits = kDeviceProps.limits;
+    if (conf.local_size_x <= 0 || conf.local_size_y <= 0 || conf.local_size_z <= 0 ||
+        (uint32_t)conf.local_size_x > limits.maxComputeWorkGroupSize[0] ||
+        (uint32_t)conf.local_size_y > limits.maxComputeWorkGroupSize[1] ||
+        (uint32_t)conf.local_size_z > limits.maxComputeWorkGroupSize[2] ||
+        (uint32_t)(conf.local_size_x * conf.local_size_y * conf.local_size_z) > limits.maxComputeWorkGroupInvocations)
+    {
+        return false;
+    }
+
+    // the 3 channel signature also keeps the config of the input converted to 4 channels
+    VkConvSpecializedConst p = param;
+    if (param.channels == 3 && type != CONV_SHADER_TYPE_GEMM_4_4_CHN3)
+    {
+        p.k        = param.k / 3 * 4;
+        p.channels = 4;
+    }
+
+    for (const ShaderConfig& c : genShaderConfigCandidates(p, (ConvShaderType)type))
+    {
+        if (c.local_size_x == conf.local_size_x && c.local_size_y == conf.local_size_y &&
+            c.local_size_z == conf.local_size_z && c.block_width == conf.block_width &&
+            c.block_height == conf.block_height && c.block_depth == conf.block_depth)
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+// the config of a signature from the in-memory map, which starts with the pre-tuned
+// ones, or from the tuning db of earlier runs. an invalid db entry is dropped, so
+// the signature is tuned again
+static bool findShaderConfig(const VkConvSpecializedConst& param, int& type, ShaderConfig& conf)
+{
+    const std::string sig = genConvSignature(param);
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+
+        // load default configs and get vulkan info
+        if (!is_initialized)
+        {
+            NN_GPU_DEBUG("prepareShaderConfig: init shaderConfigMap for vulkan backend shader");
+
+            int configNum = 0;
+            if (sizeof(defaultConfig) > 0)
+            {
+                configNum = sizeof(defaultConfig) / sizeof(defaultConfig[0]) / 2;
+            }
+            for (int i = 0; i < configNum; i++)
+            {
+                ShaderConfigPair entry(defaultConfig[2 * i], defaultConfig[2 * i + 1]);
+                shaderConfigMap.insert(entry);
+                NN_GPU_PERF("CONV_2D: %s: load pre-tuned config: %s, %s\n", __func__, defaultConfig[2 * i], defaultConfig[2 * i + 1]);
+            }
+            NN_GPU_DEBUG("prepareShaderConfig: shaderConfigMap is initialized");
+            is_initialized = true;
+        }
+
+        // search in-memory cache
+        ShaderConfigMap::iterator it = shaderConfigMap.find(sig);
+        if (it != shaderConfigMap.end())
+        {
+            NN_GPU_PERF("CONV_2D: %s: found config %s, %s\n", __func__, sig.c_str(), it->second.c_str());
+            return string2Config(it->second.c_str(), type, conf);
+        }
+    }
+
+    NN_GPU_PERF("CONV_2D: %s: config cannot be found from in-memory cache", __func__);
+
+    // load from the tuning db of earlier runs
+    std::string conf_str;
+    if (VkTuningDb::find(sig, conf_str))
+    {
+        if (!string2Config(conf_str.c_str(), type, conf) || !isValidTunedConfig(param, type, conf))
+        {
+            LOGW("CONV_2D: %s: drop invalid tuned config %s, %s", __func__, sig.c_str(), conf_str.c_str());
+            VkTuningDb::remove(sig);
+            return false;
+        }
+        std::lock_guard<std::mutex> lock(mtx);
+        shaderConfigMap.insert(ShaderConfigPair(sig, conf_str));
+        return true;
+    }
+    return false;
+}
+
+bool VkCsExecutor::prepareShaderConfig(VkConvSpecializedConst& param, int& type, ShaderConfig& conf,
                                        VkOperand& in, VkOperand& filter, VkOperand& bias, VkOperand& out)
 {
     const std::string sig = genConvSignature(param);
+    long tuned_us = std::numeric_limits<long>::max();
+    std::shared_ptr<std::mutex> sigLock;
 
-    bool tuned = false;
-    bool found = false;
+    if (findShaderConfig(param, type, conf))
+    {
+        return true;
+    }
 
-    mtx.lock();
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        std::shared_ptr<std::mutex>& l = signatureLocks[sig];
+        if (!l)
+        {
+            l = std::make_shared<std::mutex>();
+        }
+        sigLock = l;
+    }
 
-    // load default configs and get vulkan info
-    if (!is_initialized)
+    // not in the map, so it is only used by the operation until runIdle tunes it
+    if (asyncTune && heuristicConfig(param, type, conf))
     {
-        NN_GPU_DEBUG("prepareShaderConfig: init shaderConfigMap for vulkan backend shader");
+        NN_GPU_PERF("CONV_2D: %s: %s runs with the heuristic config %s until it is tuned\n",
+                    __func__, sig.c_str(), genShaderConfigString(type, conf).c_str());
+        return false;
+    }
 
-        int configNum = 0;
-        if (sizeof(defaultConfig) > 0)
+    std::lock_guard<std::mutex> tuneLock(*sigLock);
+    {
+        // tuned by another execution context while we waited for it
+        std::lock_guard<std::mutex> lock(mtx);
+        ShaderConfigMap::iterator it = shaderConfigMap.find(sig);
+        if (it != shaderConfigMap.end() && string2Config(it->second.c_str(), type, conf))
         {
-            configNum = sizeof(defaultConfig) / sizeof(defaultConfig[0]) / 2;
+            return true;
         }
-        for (int i = 0; i < configNum; i++)
+    }
+
+    // candidates are timed one by one, so finish the recorded work
+    // (the input may be produced by it) and tune out of the model command buffer
+    std::shared_ptr<VkCommandRecorder> rec = opBase->recorder;
+    if (rec)
+    {
+        rec->flush();
+        opBase->setRecorder(nullptr);
+    }
+    bool tuned = tune(param, type, conf, tuned_us, in, filter, bias, out);
+    opBase->setRecorder(rec);
+    const std::string conf_str = genShaderConfigString(type, conf);
+
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        shaderConfigMap.insert(ShaderConfigPair(sig, conf_str));
+    }
+    // an unverified fallback is not kept for later runs
+    if (tuned)
+    {
+        VkTuningDb::update(sig, conf_str, tuned_us);
+    }
+    return true;
+}
+
+bool VkCsExecutor::prepareChn3Config(VkConvSpecializedConst& param,
+                                     VkOperand& in, VkOperand& filter, VkOperand& bias, VkOperand& out)
+{
+    const std::string sig = genConvSignature(param);
+    VkOperand& chn4_in     = opBase->tmp_operands[0];
+    VkOperand& chn4_filter = opBase->tmp_operands[1];
+    VkOpBase& cvt          = *opBase->sub_ops[0];
+    PushConst push_const;
+
+    VkConvSpecializedConst chn4_param = param;
+    chn4_param.k        = param.k / 3 * 4;
+    chn4_param.channels = 4;
+
+    VkOperand tune_in  = in;
+    VkOperand tune_out = out;
+    if (prepareOnly)
+    {
+        // the model inputs and outputs have no storage yet, tune on scratch buffers
+        Shape in_s  = in.getShape();
+        Shape out_s = out.getShape();
+        tune_in.reset(in_s[kShapeIdxBatch], in_s[kShapeIdxWidth], in_s[kShapeIdxHeight], in_s[kShapeIdxChannel]);
+        tune_out.reset(out_s[kShapeIdxBatch], out_s[kShapeIdxWidth], out_s[kShapeIdxHeight], out_s[kShapeIdxChannel]);
+    }
+
+    std::shared_ptr<VkCommandRecorder> rec = opBase->recorder;
+    if (rec)
+    {
+        rec->flush();
+        opBase->setRecorder(nullptr);
+    }
+
+    // the 4 channel config is tuned and kept under the 4 channel signature as usual,
+    // its time includes the conversion of the input
+    int chn4_type;
+    ShaderConfig chn4_conf;
+    long chn4_us = std::numeric_limits<long>::max();
+    bool chn4_tuned = prepareShaderConfig(chn4_param, chn4_type, chn4_conf, chn4_in, chn4_filter, bias, tune_out);
+    chn4_param.local_sz_x = chn4_conf.local_size_x;
+    chn4_param.local_sz_y = chn4_conf.local_size_y;
+    chn4_param.local_sz_z = chn4_conf.local_size_z;
+    cvt.bindOperand(tune_in, 0, cvt.descriptor_set);
+    cvt.bindOperand(chn4_in, 1, cvt.descriptor_set);
+    if (createTuningPipeline(chn4_param, chn4_type, chn4_conf, chn4_in, chn4_filter, bias, tune_out))
+    {
+        timeRuns([&]() {
+            cvt.setRecorder(opBase->recorder);
+            cvt.recordCommandBuffer((void*)&push_const, sizeof(PushConst));
+            cvt.runCommandBuffer();
+            cvt.setRecorder(nullptr);
+            dispatchTuningConvolve(chn4_param, chn4_type);
+            return true;
+        }, chn4_us);
+    }
+
+    int direct_type = CONV_SHADER_TYPE_GEMM_4_4_CHN3;
+    ShaderConfig direct_conf;
+    long direct_us = std::numeric_limits<long>::max();
+    VkConvSpecializedConst direct_param = param;
+    std::vector<ShaderConfig> configs = genShaderConfigCandidates(direct_param, CONV_SHADER_TYPE_GEMM_4_4_CHN3);
+    std::vector<int> types(configs.size(), CONV_SHADER_TYPE_GEMM_4_4_CHN3);
+    bool direct = !configs.empty() &&
+                  tryRankedShaderConfig(direct_param, types, configs, direct_type, direct_conf, direct_us,
+                                        tune_in, filter, bias, tune_out);
+
+    opBase->setRecorder(rec);
+    if (prepareOnly)
+    {
+        tune_in.release();
+        tune_out.release();
+    }
+
+    NN_GPU_PERF("CONV_2D: %s: %s 3 channel input %ld us, converted to 4 channels %ld us\n",
+                __func__, sig.c_str(), direct_us, chn4_us);
+
+    const bool chn3_direct = direct && direct_us <= chn4_us;
+    opCache->shader_type = chn3_direct ? direct_type : chn4_type;
+    opCache->config      = chn3_direct ? direct_conf : chn4_conf;
+
+    // only GEMM_4_4_CHN3 under the 3 channel signature runs on the input as is,
+    // the 4 channel config is looked up under its own signature
+    const std::string conf_str = genShaderConfigString(opCache->shader_type, opCache->config);
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        shaderConfigMap.insert(ShaderConfigPair(sig, conf_str));
+    }
+    if (chn3_direct || chn4_tuned)
+    {
+        VkTuningDb::update(sig, conf_str, chn3_direct ? direct_us : chn4_us);
+    }
+    return chn3_direct;
+}
+
+// tunes a conv running with a heuristic config and swaps its pipeline for the one
+// of the tuned config. runIdle calls it on the thread of the executor while no
+// request is queued, so no dispatch of the operation is recorded or in flight
+bool VkCsExecutor::retuneOperation(size_t index)
+{
+    const Operation& operation = model.operations[index];
+    ASSERT(operation.type == OperationType::CONV_2D);
+
+    opBase = opBases[index];
+    opCache = &opCaches[index];
+    const int heuristic_type = opCache->shader_type;
+    const ShaderConfig heuristic_conf = opCache->config;
+
+    // convolve selects a config again without a cached one, and tunes on
+    // scratch buffers as when the model is compiled, the request ones are gone
+    prepareOnly = true;
+    asyncTune = false;
+    opCache->shader_type = VkOpCache().shader_type;
+    opBase->resetPipeline();
+
+    bool ret = doCONV_2D(operation);
+    if (!ret)
+    {
+        opCache->shader_type = heuristic_type;
+        opCache->config = heuristic_conf;
+        opBase->resetPipeline();
+        doCONV_2D(operation);
+    }
+    else
+    {
+        NN_GPU_PERF("CONV_2D: %s: operation %zu swapped to shader type %d, %s\n", __func__, index,
+                    opCache->shader_type, genShaderConfigString(opCache->shader_type, opCache->config).c_str());
+    }
+
+    asyncTune = true;
+    prepareOnly = false;
+    opBase.reset();
+    opCache = nullptr;
+    return ret;
+}
+
+static bool isFilterPackingEnabled()
+{
+    char prop[PROPERTY_VALUE_MAX] = "1";
+    property_get("nn.gpgpu.pack_filter", prop, "1");
+    return prop[0] != '0';
+}
+
+// the OHWI filter is a matrix of N rows by K / 4 vec4, the packed GEMM 4x8
+// shader reads its transpose, vec4 i of output channel n at i * N + n, so the
+// 8 rows of a block and the blocks of neighbouring invocations are contiguous
+static void packFilter4_8(const VkConvSpecializedConst& param, const float* src, float* packed)
+{
+    const int N = param.n;
+    const int width0 = param.k / 4;
+
+    for (int n = 0; n < N; ++n)
+    {
+        for (int i = 0; i < width0; ++i)
         {
-            ShaderConfigPair entry(defaultConfig[2 * i], defaultConfig[2 * i + 1]);
-            shaderConfigMap.insert(entry);
-            NN_GPU_PERF("CONV_2D: %s: load pre-tuned config: %s, %s\n", __func__, defaultConfig[2 * i], defaultConfig[2 * i + 1]);
+            memcpy(&packed[(i * N + n) * 4], &src[(n * width0 + i) * 4], 4 * sizeof(float));
         }
-        NN_GPU_DEBUG("prepareShaderConfig: shaderConfigMap is initialized");
-        is_initialized = true;
     }
+}
+
+// the GEMM 4x8 config runs on a packed copy of the constant filter, packed once
+// when the model is prepared or taken from the compilation cache
+void VkCsExecutor::preparePackedFilter(const VkConvSpecializedConst& param, const bool converted, VkOperand& filter)
+{
+    // the chn4 input and filter of a converted 3 channel conv come first
+    const size_t packed_index = converted ? 2 : 0;
+    int& type = opCache->shader_type;
 
-    // search in-memory cache
-    ShaderConfigMap::iterator it = shaderConfigMap.find(sig);
-    if (it != shaderConfigMap.end())
+    if ((type != CONV_SHADER_TYPE_GEMM_4_8_GENERIC && type != CONV_SHADER_TYPE_GEMM_4_8_PACKED) ||
+        !isFilterPackingEnabled())
     {
-        NN_GPU_PERF("CONV_2D: %s: found config %s, %s\n", __func__, sig.c_str(), it->second.c_str());
-        string2Config(it->second.c_str(), conf);
-        mtx.unlock();
+        // nn.gpgpu.pack_filter=0 keeps the filter as is
+        if (type == CONV_SHADER_TYPE_GEMM_4_8_PACKED)
+        {
+            type = CONV_SHADER_TYPE_GEMM_4_8_GENERIC;
+        }
+        opBase->filter_index = converted ? 1 : -1;
         return;
     }
 
-    NN_GPU_PERF("CONV_2D: %s: config cannot be found from in-memory cache", __func__);
+    if (opBase->tmp_operands.size() <= packed_index)
+    {
+        const size_t count = (size_t)param.n * param.k;
+        std::vector<float> packed(count);
+        if (type == CONV_SHADER_TYPE_GEMM_4_8_PACKED && opCache->filter.size() == count * sizeof(float))
+        {
+            // packed when the model was compiled, from the compilation cache
+            memcpy(packed.data(), opCache->filter.data(), count * sizeof(float));
+        }
+        else
+        {
+            std::vector<float> src(count);
+            filter.getVkBuffer();
+            filter.copyToBuffer(src.data(), count * sizeof(float));
+            packFilter4_8(param, src.data(), packed.data());
+        }
 
-    // todo: load from persistent config
-    found = fake_loadConfig();
-    if (!found)
+        // filter may be in tmp_operands, copy it before adding to them
+        VkOperand packed_filter = filter;
+        opBase->rebindVkBuffer(packed_filter, param.n, param.filter_w, param.filter_h, param.channels,
+                               reinterpret_cast<const uint8_t*>(packed.data()));
+        packed_filter.waitForUpload();
+        opBase->tmp_operands.push_back(packed_filter);
+    }
+
+    type = CONV_SHADER_TYPE_GEMM_4_8_PACKED;
+    opBase->filter_index = packed_index;
+}
+
+static bool isWinogradEnabled()
+{
+    char prop[PROPERTY_VALUE_MAX] = "1";
+    property_get("nn.gpgpu.winograd", prop, "1");
+    return prop[0] != '0';
+}
+
+// 3 channel convs run on the chn4 input or as GEMM_4_4_CHN3
+static bool canUseWinograd(const VkConvSpecializedConst& param)
+{
+    return param.channels != 3 && param.filter_h == 3 && param.filter_w == 3 &&
+           param.stride_h == 1 && param.stride_w == 1 &&
+           param.n % 4 == 0;
+}
+
+// U = G g G^T of the 3x3 filter g of each input and output channel, in the
+// layout of the Winograd GEMM shader, U[xi][c][n]
+static void transformFilterWinograd(const VkConvSpecializedConst& param, const float* filter,
+                                    std::vector<float>& u)
+{
+    static const float G[6][3] =
     {
-        tune(param, conf, in, filter, bias, out);
-        tuned = true;
+        {  1.0f / 4,   0.0f,       0.0f     },
+        { -1.0f / 6,  -1.0f / 6,  -1.0f / 6 },
+        { -1.0f / 6,   1.0f / 6,  -1.0f / 6 },
+        {  1.0f / 24,  1.0f / 12,  1.0f / 6 },
+        {  1.0f / 24, -1.0f / 12,  1.0f / 6 },
+        {  0.0f,       0.0f,       1.0f     },
+    };
+    const int C = param.channels;
+    const int N = param.n;
+
+    u.resize(36 * C * N);
+    for (int n = 0; n < N; ++n)
+    {
+        for (int c = 0; c < C; ++c)
+        {
+            // OHWI
+            float g[3][3];
+            for (int ky = 0; ky < 3; ++ky)
+            {
+                for (int kx = 0; kx < 3; ++kx)
+                {
+                    g[ky][kx] = filter[((n * 3 + ky) * 3 + kx) * C + c];
+                }
+            }
+            float gg[6][3];
+            for (int i = 0; i < 6; ++i)
+            {
+                for (int kx = 0; kx < 3; ++kx)
+                {
+                    gg[i][kx] = G[i][0] * g[0][kx] + G[i][1] * g[1][kx] + G[i][2] * g[2][kx];
+                }
+            }
+            for (int i = 0; i < 6; ++i)
+            {
+                for (int j = 0; j < 6; ++j)
+                {
+                    u[((i * 6 + j) * C + c) * N + n] = gg[i][0] * G[j][0] + gg[i][1] * G[j][1] + gg[i][2] * G[j][2];
+                }
+            }
+        }
     }
+}
 
-    // todo: store persistent config
-    if (tuned)
+// the pipeline of the input or the output transform, both run with a fixed config
+std::shared_ptr<VkOpBase> VkCsExecutor::createWinogradTransform(VkConvSpecializedConst param, const int type)
+{
+    const ShaderConfig conf(16, 4, 1, 1, 1, 1);
+    param.local_sz_x = conf.local_size_x;
+    param.local_sz_y = conf.local_size_y;
+    param.local_sz_z = conf.local_size_z;
+
+    std::shared_ptr<VkOpBase> op = std::make_shared<VkOpBase>(opBase->cmd_pool);
+    op->initVulkanThing(4);
+    const uint32_t* spv;
+    size_t spv_size;
+    if (!computeGroupCount(op->group_x, op->group_y, op->group_z, type, param, conf) ||
+        !getConvShader(type, spv, spv_size))
+    {
+        return nullptr;
+    }
+
+    VkSpecializationInfo spec_info;
+    VkSpecializationMapEntry entry[SPEC_CONST_NUM];
+    setSpecInfo(entry, spec_info, param, SPEC_CONST_NUM);
+    op->createShaderModule(spv, spv_size);
+    op->createPipeline(sizeof(PushConst), &spec_info);
+    op->setRecorder(opBase->recorder);
+    return op;
+}
+
+// the input transform, the GEMMs of the pipeline of opBase and the output transform
+void VkCsExecutor::dispatchWinograd(VkOpBase& input, VkOpBase& output)
+{
+    PushConst push_const;
+
+    input.recordCommandBuffer((void*)&push_const, sizeof(PushConst));
+    input.runCommandBuffer();
+    opBase->recordCommandBuffer((void*)&push_const, sizeof(PushConst));
+    opBase->runCommandBuffer();
+    output.recordCommandBuffer((void*)&push_const, sizeof(PushConst));
+    output.runCommandBuffer();
+}
+
+// times the Winograd GEMM configs, with both transforms, against the tuned config
+// of opCache, on scratch buffers when the model is prepared. conf is set to the
+// fastest one only if it beats the tuned config and its result is right
+bool VkCsExecutor::tuneWinograd(VkConvSpecializedConst& param, VkOpBase& input, VkOpBase& output,
+                                ShaderConfig& conf, VkOperand& in, VkOperand& filter, VkOperand& bias,
+                                VkOperand& out, VkOperand& u, VkOperand& v, VkOperand& m)
+{
+    VkOperand tune_in  = in;
+    VkOperand tune_out = out;
+    if (prepareOnly)
+    {
+        // the model inputs and outputs have no storage yet, tune on scratch buffers
+        Shape in_s  = in.getShape();
+        Shape out_s = out.getShape();
+        tune_in.reset(in_s[kShapeIdxBatch], in_s[kShapeIdxWidth], in_s[kShapeIdxHeight], in_s[kShapeIdxChannel]);
+        tune_out.reset(out_s[kShapeIdxBatch], out_s[kShapeIdxWidth], out_s[kShapeIdxHeight], out_s[kShapeIdxChannel]);
+    }
+
+    std::shared_ptr<VkCommandRecorder> rec = opBase->recorder;
+    if (rec)
+    {
+        rec->flush();
+        opBase->setRecorder(nullptr);
+    }
+
+    VkConvSpecializedConst p = param;
+    p.local_sz_x = opCache->config.local_size_x;
+    p.local_sz_y = opCache->config.local_size_y;
+    p.local_sz_z = opCache->config.local_size_z;
+    long best_us = std::numeric_limits<long>::max();
+    timeConvolve(p, opCache->shader_type, opCache->config, tune_in, filter, bias, tune_out, best_us);
+    NN_GPU_PERF("CONV_2D: %s: tuned config %s: %8.3f ms\n", __func__,
+                genShaderConfigString(opCache->shader_type, opCache->config).c_str(), 1.0 * best_us / 1000);
+
+    input.bindOperand(tune_in, 0, input.descriptor_set);
+    input.bindOperand(v, 3, input.descriptor_set);
+    output.bindOperand(m, 0, output.descriptor_set);
+    output.bindOperand(bias, 2, output.descriptor_set);
+    output.bindOperand(tune_out, 3, output.descriptor_set);
+
+    static const int local_sizes[][2] = { {4, 1}, {4, 4}, {16, 1}, {16, 4}, {64, 1} };
+    bool found = false;
+    ShaderConfig best;
+    for (auto& lsz : local_sizes)
+    {
+        ShaderConfig cand(lsz[0], lsz[1], 1, 4, 4, 1);
+        p.local_sz_x = cand.local_size_x;
+        p.local_sz_y = cand.local_size_y;
+        p.local_sz_z = cand.local_size_z;
+
+        long elapsed_us;
+        if (createTuningPipeline(p, CONV_SHADER_TYPE_WINOGRAD, cand, v, u, bias, m) &&
+            timeRuns([&]() {
+                input.setRecorder(opBase->recorder);
+                output.setRecorder(opBase->recorder);
+                dispatchWinograd(input, output);
+                input.setRecorder(nullptr);
+                output.setRecorder(nullptr);
+                return true;
+            }, elapsed_us))
+        {
+            NN_GPU_PERF("CONV_2D: %s: winograd config %s: %8.3f ms\n", __func__,
+                        genShaderConfigString(CONV_SHADER_TYPE_WINOGRAD, cand).c_str(), 1.0 * elapsed_us / 1000);
+            if (elapsed_us < best_us)
+            {
+                best_us = elapsed_us;
+                best = cand;
+                found = true;
+            }
+        }
+    }
+
+    // the transforms round more than the direct sum, so check with a looser tolerance
+    if (found)
+    {
+        p.local_sz_x = best.local_size_x;
+        p.local_sz_y = best.local_size_y;
+        p.local_sz_z = best.local_size_z;
+        tune_out.resetForTune();
+        found = false;
+        if (createTuningPipeline(p, CONV_SHADER_TYPE_WINOGRAD, best, v, u, bias, m))
+        {
+            dispatchWinograd(input, output);
+
+            std::vector<float> in_buf(param.batch * param.in_h * param.in_w * param.channels);
+            std::vector<float> filter_buf(param.n * param.k);
+            std::vector<float> bias_buf(param.n);
+            std::vector<float> out_buf(param.batch * param.out_h * param.out_w * param.n);
+            tune_in.copyToBuffer(in_buf.data(), in_buf.size() * sizeof(float));
+            filter.copyToBuffer(filter_buf.data(), filter_buf.size() * sizeof(float));
+            bias.copyToBuffer(bias_buf.data(), bias_buf.size() * sizeof(float));
+            tune_out.copyToBuffer(out_buf.data(), out_buf.size() * sizeof(float));
+            found = verifyResult(param, in_buf.data(), filter_buf.data(), bias_buf.data(), out_buf.data(), 0.2f);
+        }
+        if (found)
+        {
+            conf = best;
+        }
+    }
+
+    opBase->setRecorder(rec);
+    if (prepareOnly)
+    {
+        tune_in.release();
+        tune_out.release();
+    }
+    return found;
+}
+
+// a 3x3 stride 1 CONV_2D may run as Winograd F(4x4, 3x3): the filter is
+// transformed once when the model is prepared, or taken transformed from the
+// compilation cache, the input and output transforms are the sub ops, and
+// tmp_operands holds the transformed filter, input tiles and GEMM products
+bool VkCsExecutor::prepareWinograd(VkConvSpecializedConst& param, VkOperand& in, VkOperand& filter,
+                                   VkOperand& bias, VkOperand& out, const bool tune)
+{
+    const bool cached = (opCache->shader_type == CONV_SHADER_TYPE_WINOGRAD);
+    if (!cached && (!tune || !canUseWinograd(param) || !isWinogradEnabled()))
+    {
+        return true;
+    }
+    if (!cached && asyncTune)
+    {
+        // timed by runIdle, the tuned config runs until then
+        return false;
+    }
+
+    const int C = param.channels;
+    const int N = param.n;
+    const int tiles = winogradTiles(param);
+    const size_t count = 36 * (size_t)C * N;
+
+    std::vector<float> u;
+    if (cached && opCache->filter.size() == count * sizeof(float))
+    {
+        // transformed when the model was compiled, from the compilation cache
+        u.resize(count);
+        memcpy(u.data(), opCache->filter.data(), count * sizeof(float));
+    }
+    else
     {
-        fake_storeConfig();
+        std::vector<float> src((size_t)param.n * param.k);
+        filter.getVkBuffer();
+        filter.copyToBuffer(src.data(), src.size() * sizeof(float));
+        transformFilterWinograd(param, src.data(), u);
+    }
+
+    VkOperand wino_filter = filter;
+    opBase->rebindVkBuffer(wino_filter, 36, N, 1, C, reinterpret_cast<const uint8_t*>(u.data()));
+    wino_filter.waitForUpload();
+    VkOperand wino_in = out;
+    opBase->rebindVkBuffer(wino_in, 36, tiles, 1, C);
+    VkOperand products = out;
+    opBase->rebindVkBuffer(products, 36, tiles, 1, N);
+
+    ShaderConfig conf = opCache->config;
+    std::shared_ptr<VkOpBase> input  = createWinogradTransform(param, CONV_SHADER_TYPE_WINOGRAD_INPUT);
+    std::shared_ptr<VkOpBase> output = createWinogradTransform(param, CONV_SHADER_TYPE_WINOGRAD_OUTPUT);
+    if (!input || !output ||
+        (!cached && !tuneWinograd(param, *input, *output, conf, in, filter, bias, out, wino_filter, wino_in, products)))
+    {
+        wino_filter.release();
+        wino_in.release();
+        products.release();
+        if (cached)
+        {
+            // runs with the heuristic config until runIdle tunes it
+            LOGE("CONV_2D: %s: the cached winograd config cannot run", __func__);
+            heuristicConfig(param, opCache->shader_type, opCache->config);
+            return false;
+        }
+        return true;
     }
 
-    mtx.unlock();
+    // a packed filter of an earlier config is not used any more
+    for (VkOperand& operand : opBase->tmp_operands)
+    {
+        operand.release();
+    }
+    opBase->tmp_operands.clear();
+    opBase->tmp_operands.push_back(wino_filter);
+    opBase->tmp_operands.push_back(wino_in);
+    opBase->tmp_operands.push_back(products);
+    opBase->filter_index = 0;
+
+    input->setRecorder(opBase->recorder);
+    output->setRecorder(opBase->recorder);
+    opBase->sub_ops.clear();
+    opBase->sub_ops.push_back(input);
+    opBase->sub_ops.push_back(output);
+
+    opCache->shader_type = CONV_SHADER_TYPE_WINOGRAD;
+    opCache->config = conf;
+    return true;
+}
+
+// cached configs select one of the shaders convolve creates a pipeline for
+static bool isValidCachedConfig(const VkOpCache& cache)
+{
+    const ShaderConfig& conf = cache.config;
+    return cache.shader_type >= CONV_SHADER_TYPE_BASIC &&
+           cache.shader_type < CONV_SHADER_TYPE_NUM &&
+           cache.shader_type != CONV_SHADER_TYPE_CHN3_TO_CHN4 &&
+           cache.shader_type != CONV_SHADER_TYPE_WINOGRAD_INPUT &&
+           cache.shader_type != CONV_SHADER_TYPE_WINOGRAD_OUTPUT &&
+           conf.local_size_x > 0 && conf.local_size_y > 0 && conf.local_size_z > 0 &&
+           conf.block_width > 0 && conf.block_height > 0 && conf.block_depth > 0;
 }
 
 bool VkCsExecutor::convolve(const Operation& operation, ShaderConfig& config)
@@ -1144,6 +2248,7 @@ bool VkCsExecutor::convolve(const Operation& operation, ShaderConfig& config)
                                       in_shape[kShapeIdxChannel], in_shape[kShapeIdxBatch], M, K, N, tail_m);
 
     PushConst push_const;
+    bool chn3_tuned = true;
 
     if (opBase->pipeline == VK_NULL_HANDLE)
     {
@@ -1183,11 +2288,27 @@ bool VkCsExecutor::convolve(const Operation& operation, ShaderConfig& config)
                                      padding_mode, &spec_const.pad_h);
         }
 
-        // for chn3_to_chn4 convertion
-        VkOperand chn4_filter = filter;
-        VkOperand chn4_in     = in;
+        // a 3 channel conv with a GEMM_4_4_CHN3 config for its signature runs on
+        // the input and filter as they are, the others convert them to 4 channels.
+        // without a config for its signature both are timed once the chn4 input
+        // and filter are there
+        bool chn3_found = true;
+        if (spec_const.channels == 3 && !isValidCachedConfig(*opCache))
+        {
+            int type;
+            ShaderConfig conf;
+            chn3_found = findShaderConfig(spec_const, type, conf);
+            if (chn3_found && type == CONV_SHADER_TYPE_GEMM_4_4_CHN3)
+            {
+                opCache->shader_type = type;
+                opCache->config = conf;
+            }
+        }
+        bool chn3_direct = (opCache->shader_type == CONV_SHADER_TYPE_GEMM_4_4_CHN3);
 
-        if (spec_const.channels == 3)
+        // for chn3_to_chn4 convertion, the chn4 filter is converted once and
+        // kept with the operation, the input is converted by a sub op every run
+        if (spec_const.channels == 3 && !chn3_direct && opBase->sub_ops.empty())
         {
             uint32_t filter_size    = spec_const.channels * spec_const.filter_w * spec_const.filter_h * spec_const.n;
             uint32_t input_size     = spec_const.channels * spec_const.in_w * spec_const.in_h * spec_const.batch;
@@ -1195,99 +2316,175 @@ bool VkCsExecutor::convolve(const Operation& operation, ShaderConfig& config)
 
             const int new_channel_num = 4;
 
-            opBase->rebindVkBuffer(chn4_filter, spec_const.n, spec_const.filter_w, spec_const.filter_h, new_channel_num);
+            VkOperand chn4_filter = filter;
+            VkOperand chn4_in     = in;
             opBase->rebindVkBuffer(chn4_in, spec_const.batch, spec_const.in_w, spec_const.in_h, new_channel_num);
 
-            // first off, convert filter to 4 channels
-            if (tmpBoSize == 0)
+            const size_t chn4_filter_bytes = filter_size / 3 * new_channel_num * sizeof(float);
+            if (opCache->shader_type != CONV_SHADER_TYPE_GEMM_4_8_PACKED &&
+                opCache->filter.size() == chn4_filter_bytes)
             {
-                total_thread_x = alignSize(filter_size, ITEMS_PER_WI) / ITEMS_PER_WI;
-                chn3ToChn4(spec_const, config);
+                // converted when the model was compiled, from the compilation cache
+                opBase->rebindVkBuffer(chn4_filter, spec_const.n, spec_const.filter_w, spec_const.filter_h,
+                                       new_channel_num, opCache->filter.data());
+            }
+            else
+            {
+                opBase->rebindVkBuffer(chn4_filter, spec_const.n, spec_const.filter_w, spec_const.filter_h,
+                                       new_channel_num);
 
-                int group_x = opBase->computeGroupCountX(total_thread_x, spec_const.local_sz_x, spec_const.local_sz_x);
-                opBase->setGroupSize(group_x, 1, 1);
+                // first off, convert filter to 4 channels
+                VkConvSpecializedConst cvt_const = spec_const;
+                ShaderConfig cvt_config;
+                VkOpBase cvt(opBase->cmd_pool);
 
-                ++tmpBoSize;
+                cvt.initVulkanThing(2);
+                total_thread_x = alignSize(filter_size, ITEMS_PER_WI) / ITEMS_PER_WI;
+                chn3ToChn4(cvt_const, cvt_config);
+
+                cvt.computeGroupCountX(total_thread_x, cvt_const.local_sz_x, cvt_const.local_sz_x);
+                cvt.setGroupSize(cvt.group_x, 1, 1);
 
                 VkSpecializationMapEntry entry[SPEC_CONST_NUM];
                 VkSpecializationInfo spec_info;
-                spec_const.num_items = filter_size;
-
-                setSpecInfo(entry, spec_info, spec_const, SPEC_CONST_NUM);
+                cvt_const.num_items = filter_size;
+                setSpecInfo(entry, spec_info, cvt_const, SPEC_CONST_NUM);
 
-                opBase->createShaderModule(conv_chn3to4_spv, sizeof(conv_chn3to4_spv));
-                opBase->createPipeline(sizeof(PushConst), &spec_info);
+                cvt.createShaderModule(conv_chn3to4_spv, sizeof(conv_chn3to4_spv));
+                cvt.createPipeline(sizeof(PushConst), &spec_info);
 
-                opBase->bindOperand(filter, 0, opBase->descriptor_set);
-                opBase->bindOperand(chn4_filter, 1, opBase->descriptor_set);
+                cvt.bindOperand(filter, 0, cvt.descriptor_set);
+                cvt.bindOperand(chn4_filter, 1, cvt.descriptor_set);
 
-                int partition_num = (int)ceil(1.0 * N / opBase->group_y);
-
-
-                uint32_t num = partition_num * 3;
-                for (uint32_t i = 0; i < num; i++)
-                {
-                    opBase->recordCommandBuffer((void*)&push_const, sizeof(PushConst));
-                    opBase->runCommandBuffer();
-                }
+                // filter is a constant, no recorded work to wait for
+                cvt.recordCommandBuffer((void*)&push_const, sizeof(PushConst));
+                cvt.runCommandBuffer();
                 // chn4_filter.dumpToFile("filter", 4);
             }
 
-            // then, convert input
-            total_thread_x = alignSize(input_size, ITEMS_PER_WI) / ITEMS_PER_WI;
-            chn3ToChn4(spec_const, config);
+            // then, create the pipeline to convert input
+            {
+                VkConvSpecializedConst cvt_const = spec_const;
+                ShaderConfig cvt_config;
+                std::shared_ptr<VkOpBase> cvt = std::make_shared<VkOpBase>(opBase->cmd_pool);
 
-            int group_x = opBase->computeGroupCountX(total_thread_x, spec_const.local_sz_x, spec_const.local_sz_x);
-            opBase->setGroupSize(group_x, 1, 1);
-            --tmpBoSize;
+                cvt->initVulkanThing(2);
+                total_thread_x = alignSize(input_size, ITEMS_PER_WI) / ITEMS_PER_WI;
+                chn3ToChn4(cvt_const, cvt_config);
 
-            VkSpecializationMapEntry entry[SPEC_CONST_NUM];
-            VkSpecializationInfo spec_info;
+                cvt->computeGroupCountX(total_thread_x, cvt_const.local_sz_x, cvt_const.local_sz_x);
+                cvt->setGroupSize(cvt->group_x, 1, 1);
 
-            spec_const.num_items = input_size;
-            setSpecInfo(entry, spec_info, spec_const, SPEC_CONST_NUM);
+                VkSpecializationMapEntry entry[SPEC_CONST_NUM];
+                VkSpecializationInfo spec_info;
+                cvt_const.num_items = input_size;
+                setSpecInfo(entry, spec_info, cvt_const, SPEC_CONST_NUM);
 
-            opBase->createShaderModule(conv_chn3to4_spv, sizeof(conv_chn3to4_spv));
-            opBase->createPipeline(sizeof(PushConst), &spec_info);
+                cvt->createShaderModule(conv_chn3to4_spv, sizeof(conv_chn3to4_spv));
+                cvt->createPipeline(sizeof(PushConst), &spec_info);
+                cvt->setRecorder(opBase->recorder);
 
-            opBase->bindOperand(in, 0, opBase->descriptor_set);
-            opBase->bindOperand(chn4_in, 1, opBase->descriptor_set);
+                opBase->sub_ops.push_back(cvt);
+            }
 
-            int partition_num = (int)ceil(1.0 * N / opBase->group_y);
+            opBase->tmp_operands.push_back(chn4_in);
+            opBase->tmp_operands.push_back(chn4_filter);
+            opBase->filter_index = 1;
+        }
 
-            if (shader_type == CONV_SHADER_TYPE_BASIC)
+        if (!chn3_found)
+        {
+            if (asyncTune)
             {
-                for (uint32_t b = 0; b < filter_shape[kShapeIdxBatch]; b++)
-                {
-                    for (int n = 0; n < partition_num; n++)
-                    {
-                        opBase->recordCommandBuffer((void*)&push_const, sizeof(PushConst));
-                        opBase->runCommandBuffer();
-                    }
-                }
+                // runs converted to 4 channels until runIdle times both
+                chn3_tuned = false;
             }
-            else
+            else if (prepareChn3Config(spec_const, in, filter, bias, out))
             {
-                opBase->recordCommandBuffer((void*)&push_const, sizeof(PushConst));
-                opBase->runCommandBuffer();
+                // nor are the 4 channel input and filter
+                chn3_direct = true;
+                for (VkOperand& operand : opBase->tmp_operands)
+                {
+                    operand.release();
+                }
+                opBase->tmp_operands.clear();
+                opBase->sub_ops.clear();
+                opBase->filter_index = -1;
             }
+        }
 
+        if (spec_const.channels == 3 && !chn3_direct)
+        {
             spec_const.k = spec_const.k / 3 * 4;
             spec_const.channels = 4;
-            converted_to_chn4 = true;
-
-            // chn4_in.dumpToFile("in", 4);
         }
+    }
+
+    // only GEMM_4_4_CHN3 runs on the 3 channel input as is
+    bool converted_to_chn4 = (in_shape[kShapeIdxChannel] == 3 &&
+                              opCache->shader_type != CONV_SHADER_TYPE_GEMM_4_4_CHN3);
+    VkOperand& conv_in     = converted_to_chn4 ? opBase->tmp_operands[0] : in;
+
+    if (converted_to_chn4 && !prepareOnly)
+    {
+        VkOpBase& cvt = *opBase->sub_ops[0];
+        cvt.bindOperand(in, 0, cvt.descriptor_set);
+        cvt.bindOperand(conv_in, 1, cvt.descriptor_set);
+        cvt.recordCommandBuffer((void*)&push_const, sizeof(PushConst));
+        cvt.runCommandBuffer();
+        // conv_in.dumpToFile("in", 4);
+    }
 
-        // prepare shader config
-        if (converted_to_chn4)
+    if (opBase->pipeline == VK_NULL_HANDLE)
+    {
+        bool tuned = true;
+        const bool cached = isValidCachedConfig(*opCache);
+        if (cached)
+        {
+            // selected when the model was compiled, from the compilation cache
+            NN_GPU_DEBUG("VkCsExecutor::doCONV_2D: use cached config of shader type %d", opCache->shader_type);
+        }
+        else if (prepareOnly)
         {
-            prepareShaderConfig(spec_const, config, chn4_in, chn4_filter, bias, out);
+            // the model inputs and outputs have no storage yet, tune on scratch buffers
+            Shape in_s  = conv_in.getShape();
+            Shape out_s = out.getShape();
+            VkOperand tune_in  = conv_in;
+            VkOperand tune_out = out;
+            tune_in.reset(in_s[kShapeIdxBatch], in_s[kShapeIdxWidth], in_s[kShapeIdxHeight], in_s[kShapeIdxChannel]);
+            tune_out.reset(out_s[kShapeIdxBatch], out_s[kShapeIdxWidth], out_s[kShapeIdxHeight], out_s[kShapeIdxChannel]);
+
+            VkOperand& tune_filter = converted_to_chn4 ? opBase->tmp_operands[1] : filter;
+            tuned = prepareShaderConfig(spec_const, opCache->shader_type, config, tune_in, tune_filter, bias, tune_out);
+            opCache->config = config;
+
+            tune_in.release();
+            tune_out.release();
         }
         else
         {
-            prepareShaderConfig(spec_const, config, in, filter, bias, out);
+            VkOperand& tune_filter = converted_to_chn4 ? opBase->tmp_operands[1] : filter;
+            tuned = prepareShaderConfig(spec_const, opCache->shader_type, config, conv_in, tune_filter, bias, out);
+            opCache->config = config;
+        }
+
+        // a tuned config of a non converted conv may be replaced with a faster Winograd one
+        if (!converted_to_chn4 && !prepareWinograd(spec_const, in, filter, bias, out, tuned && !cached))
+        {
+            tuned = false;
+        }
+        if (opCache->shader_type != CONV_SHADER_TYPE_WINOGRAD)
+        {
+            preparePackedFilter(spec_const, converted_to_chn4, converted_to_chn4 ? opBase->tmp_operands[1] : filter);
+        }
+
+        const size_t index = opCache - opCaches.data();
+        if ((!tuned || !chn3_tuned) && std::find(pendingTunes.begin(), pendingTunes.end(), index) == pendingTunes.end())
+        {
+            pendingTunes.push_back(index);
         }
+        opBase->shader_type = opCache->shader_type;
+        config = opCache->config;
 
         spec_const.local_sz_x = config.local_size_x;
         spec_const.local_sz_y = config.local_size_y;
@@ -1297,78 +2494,75 @@ bool VkCsExecutor::convolve(const Operation& operation, ShaderConfig& config)
         VkSpecializationMapEntry entry[SPEC_CONST_NUM];
         setSpecInfo(entry, spec_info, spec_const, SPEC_CONST_NUM);
 
-        switch (shader_type)
+        // drop the pipeline left by tuning
+        const uint32_t* spv;
+        size_t spv_size;
+        if (!getConvShader(opBase->shader_type, spv, spv_size))
         {
-        case CONV_SHADER_TYPE_GEMM_4_8_GENERIC: {
-            opBase->createShaderModule(conv_gemmShader4_8_spv, sizeof(conv_gemmShader4_8_spv));
-            opBase->createPipeline(sizeof(PushConst), &spec_info);
-            break;
-        }
-        case CONV_SHADER_TYPE_GEMM1: {
-            opBase->createShaderModule(conv_gemm1_spv, sizeof(conv_gemm1_spv));
-            opBase->createPipeline(sizeof(PushConst), &spec_info);
-            break;
-        }
-        case CONV_SHADER_TYPE_BASIC:
-        case CONV_SHADER_TYPE_GEMM_4_4_NO_IMG2COL:
-        case CONV_SHADER_TYPE_GEMM_4_4_GENERIC:
-        case CONV_SHADER_TYPE_GEMM_4_4_CHN3: {
-            // todo: shaders of gemm_4_4, gemm_no_mig2col and gemm_4_4_chn3 are not added yet
-            opBase->createShaderModule(conv_spv, sizeof(conv_spv));
-            opBase->createPipeline(sizeof(PushConst), &spec_info);
-            break;
-        }
-        case CONV_SHADER_TYPE_CHN3_TO_CHN4:
-        default:
-            NOT_REACH_HERE;
-            break;
+            return false;
         }
+        opBase->resetPipeline();
+        opBase->createShaderModule(spv, spv_size);
+        opBase->createPipeline(sizeof(PushConst), &spec_info);
 
-        if (spec_const.channels == 4 && converted_to_chn4)
+        // todo: should be moved to opBase
+        if (spec_const.local_sz_x == 0 || spec_const.local_sz_y == 0 || spec_const.local_sz_z == 0)
         {
-            // bind the converted channel 4 operands
-            opBase->bindOperand(chn4_in, 0, opBase->descriptor_set);
-            opBase->bindOperand(chn4_filter, 1, opBase->descriptor_set);
-            converted_to_chn4 = false;
+            NOT_REACH_HERE;
         }
-        else
+        else if (false == computeGroupCount(opBase->group_x, opBase->group_y, opBase->group_z,
+                                            opBase->shader_type, spec_const, config))
         {
-            // bind the original input & filter
-            opBase->bindOperand(in, 0, opBase->descriptor_set);
-            opBase->bindOperand(filter, 1, opBase->descriptor_set);
+            NN_GPU_DEBUG("VkCsExecutor::doCONV_2D: computeGroupCount failed");
+            opBase->resetPipeline();
+            return false;
         }
 
-        // chn3ToChn4 is just for input & filter, no need to convert bias & output
-        opBase->bindOperand(bias, 2, opBase->descriptor_set);
-        opBase->bindOperand(out, 3, opBase->descriptor_set);
+        NN_GPU_DEBUG("VkCsExecutor::doCONV_2D: lsx %d, lsy %d, lsz %d, group_x %d, group_y %d, group_z %d, "
+                     "in_w %d, in_h %d, out_h %d, out_w %d, stride_h %d, stride_w %d, pad_h %d, pad_w %d, "
+                     "filter_h %d, filter_w %d, channels %d, batch %d, m %d, k %d, n %d, activation %d",
+                     spec_const.local_sz_x, spec_const.local_sz_y, spec_const.local_sz_z, opBase->group_x,
+                     opBase->group_y, opBase->group_z, spec_const.in_w, spec_const.in_h, spec_const.out_h,
+                     spec_const.out_w, spec_const.stride_h, spec_const.stride_w, spec_const.pad_h,
+                     spec_const.pad_w, spec_const.filter_h, spec_const.filter_w, spec_const.channels,
+                     spec_const.batch, spec_const.m, spec_const.k, spec_const.n, spec_const.activation);
     }
 
-    // todo: should be moved to opBase
-    if (spec_const.local_sz_x == 0 || spec_const.local_sz_y == 0 || spec_const.local_sz_z == 0)
+    if (prepareOnly)
     {
-        NOT_REACH_HERE;
+        return true;
     }
-    else if (false == computeGroupCount(opBase->group_x, opBase->group_y, opBase->group_z, shader_type, spec_const, config))
+
+    if (opBase->shader_type == CONV_SHADER_TYPE_WINOGRAD)
     {
-        NN_GPU_DEBUG("VkCsExecutor::doCONV_2D: computeGroupCount failed");
-        return false;
+        // the transformed filter, input tiles and GEMM products of prepareWinograd
+        VkOpBase& input  = *opBase->sub_ops[0];
+        VkOpBase& output = *opBase->sub_ops[1];
+        input.bindOperand(in, 0, input.descriptor_set);
+        input.bindOperand(opBase->tmp_operands[1], 3, input.descriptor_set);
+        opBase->bindOperand(opBase->tmp_operands[1], 0, opBase->descriptor_set);
+        opBase->bindOperand(opBase->tmp_operands[0], 1, opBase->descriptor_set);
+        opBase->bindOperand(bias, 2, opBase->descriptor_set);
+        opBase->bindOperand(opBase->tmp_operands[2], 3, opBase->descriptor_set);
+        output.bindOperand(opBase->tmp_operands[2], 0, output.descriptor_set);
+        output.bindOperand(bias, 2, output.descriptor_set);
+        output.bindOperand(out, 3, output.descriptor_set);
+        dispatchWinograd(input, output);
+        return true;
     }
 
-    // todo: duplicated, remove it
-    opBase->setGroupSize(opBase->group_x, opBase->group_y, opBase->group_z);
-
-    NN_GPU_DEBUG("VkCsExecutor::doCONV_2D: lsx %d, lsy %d, lsz %d, group_x %d, group_y %d, group_z %d, "
-                 "in_w %d, in_h %d, out_h %d, out_w %d, stride_h %d, stride_w %d, pad_h %d, pad_w %d, "
-                 "filter_h %d, filter_w %d, channels %d, batch %d, m %d, k %d, n %d, activation %d",
-                 spec_const.local_sz_x, spec_const.local_sz_y, spec_const.local_sz_z, opBase->group_x,
-                 opBase->group_y, opBase->group_z, spec_const.in_w, spec_const.in_h, spec_const.out_h,
-                 spec_const.out_w, spec_const.stride_h, spec_const.stride_w, spec_const.pad_h,
-                 spec_const.pad_w, spec_const.filter_h, spec_const.filter_w, spec_const.channels,
-                 spec_const.batch, spec_const.m, spec_const.k, spec_const.n, spec_const.activation);
+    // chn3ToChn4 is just for input & filter, no need to convert bias & output,
+    // the packed filter may have been added to tmp_operands since conv_in was taken
+    VkOperand& run_in     = converted_to_chn4 ? opBase->tmp_operands[0] : in;
+    VkOperand& run_filter = opBase->filter_index >= 0 ? opBase->tmp_operands[opBase->filter_index] : filter;
+    opBase->bindOperand(run_in, 0, opBase->descriptor_set);
+    opBase->bindOperand(run_filter, 1, opBase->descriptor_set);
+    opBase->bindOperand(bias, 2, opBase->descriptor_set);
+    opBase->bindOperand(out, 3, opBase->descriptor_set);
 
     int partition_num = (int)ceil(1.0 * N / opBase->group_y);
 
-    if (shader_type == CONV_SHADER_TYPE_BASIC)
+    if (opBase->shader_type == CONV_SHADER_TYPE_BASIC)
     {
         for (uint32_t b = 0; b < in_shape[kShapeIdxBatch]; b++)
         {
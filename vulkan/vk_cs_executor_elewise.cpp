@@ -129,6 +129,12 @@ bool VkCsExecutor::doEleWise(const Operation& operation, const int type)
 		opBase->createPipeline(sizeof(PushConst), &spec_info);
 	}
 
+	if (prepareOnly)
+	{
+		NN_GPU_EXIT();
+		return true;
+	}
+
 	opBase->bindOperand(in0, in0_bind, opBase->descriptor_set);
 	opBase->bindOperand(in1, in1_bind, opBase->descriptor_set);
 	opBase->bindOperand(out, 2, opBase->descriptor_set);
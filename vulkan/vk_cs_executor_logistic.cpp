@@ -73,6 +73,12 @@ bool VkCsExecutor::doLOGISTIC(const Operation& operation)
         opBase->createPipeline(sizeof(LogisticParam));
     }
 
+    if (prepareOnly)
+    {
+        NN_GPU_EXIT();
+        return true;
+    }
+
     NN_GPU_DEBUG("VkCsExecutor::doLOGISTIC: bind operands");
     opBase->bindOperand(input, 0, opBase->descriptor_set);
     opBase->bindOperand(output, 1, opBase->descriptor_set);
@@ -102,6 +102,12 @@ bool VkCsExecutor::doLOCAL_RESPONSE_NORMALIZATION(const Operation& operation)
         opBase->group_z = 1;
     }
 
+    if (prepareOnly)
+    {
+        NN_GPU_EXIT();
+        return true;
+    }
+
     NN_GPU_DEBUG("VkCsExecutor::doLOCAL_RESPONSE_NORMALIZATION: bind operands");
     opBase->bindOperand(in, 0, opBase->descriptor_set);
     opBase->bindOperand(out, 1, opBase->descriptor_set);
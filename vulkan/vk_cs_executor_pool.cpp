@@ -89,8 +89,10 @@ bool VkCsExecutor::doPool(const Operation& operation, ShaderConfig& config, cons
 		opBase->createPipeline(sizeof(PoolParam));
 	}
 
-	opBase->bindOperand(in, 0, opBase->descriptor_set);
-	opBase->bindOperand(out, 1, opBase->descriptor_set);
+	if (prepareOnly)
+	{
+		return true;
+	}
 
     PoolParam param;
     param.channels   = in_shape[kShapeIdxChannel];
@@ -152,6 +154,9 @@ bool VkCsExecutor::doPool(const Operation& operation, ShaderConfig& config, cons
         param.channels, param.in_height, param.in_width, param.out_height, param.out_width, param.total, param.stride_w,
         param.stride_h, param.filter_w, param.filter_h, param.mask_or_padded_area);
 
+    opBase->bindOperand(in, 0, opBase->descriptor_set);
+    opBase->bindOperand(out, 1, opBase->descriptor_set);
+
     opBase->recordCommandBuffer((void *)&param, sizeof(PoolParam));
     opBase->runCommandBuffer();
 
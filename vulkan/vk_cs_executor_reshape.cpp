@@ -31,8 +31,12 @@ bool VkCsExecutor::doRESHAPE(const Operation& operation)
 
     ASSERT(operation.type == OperationType::RESHAPE);
 
-#define BUFFER_NUM 2
-    opBase->initVulkanThing(BUFFER_NUM);
+    // no dispatch, the output just shares the storage of the input
+    if (prepareOnly)
+    {
+        NN_GPU_EXIT();
+        return true;
+    }
 
     const hidl_vec<uint32_t>& ins  = operation.inputs;
     const hidl_vec<uint32_t>& outs = operation.outputs;
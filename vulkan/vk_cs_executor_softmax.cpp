@@ -161,6 +161,12 @@ bool VkCsExecutor::doSOFTMAX(const Operation& operation)
         opBase->createPipeline(sizeof(SoftmaxParam));
     }
 
+    if (prepareOnly)
+    {
+        NN_GPU_EXIT();
+        return true;
+    }
+
     NN_GPU_DEBUG("VkCsExecutor::doSOFTMAX: bind operands");
     opBase->bindOperand(input, 0, opBase->descriptor_set);
     opBase->bindOperand(output, 1, opBase->descriptor_set);
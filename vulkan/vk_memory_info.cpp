@@ -16,10 +16,10 @@
  *
  */
 
-#include <sys/mman.h>
 #include "vk_common.h"
 #include "vk_memory_info.h"
 #include "vk_buffer.h"
+#include "vk_command_recorder.h"
 #include "vk_wrapper.h"
 
 NAME_SPACE_BEGIN
@@ -27,6 +27,8 @@ NAME_SPACE_BEGIN
 void VkMemoryInfo::clean()
 {
     userptr = nullptr;
+    buffer.reset();
+    staging.reset();
 }
 
 void VkMemoryInfo::setNotInUsing()
@@ -39,42 +41,52 @@ void VkMemoryInfo::setNotInUsing()
     }
 }
 
-bool VkMemoryInfo::sync(std::string name)
+VkBuffer VkMemoryInfo::getVkBuffer()
 {
-    if (name == "mmap_fd" || name == "ashmem")
+    if (!buffer)
     {
-        if (needSync)
+        if (userptr != nullptr && recorder != nullptr && recorder->isRecording())
         {
-            uint8_t* data;
-            data = buffer->map();
-            for (size_t i = 0; i < length; ++i)
+            buffer.reset(new Buffer(length, nullptr, usage));
+            if (buffer->isMappable())
+            {
+                buffer->write(userptr, 0, length);
+            }
+            else
             {
-                userptr[i] = data[i];
+                staging.reset(new Buffer(length, userptr, kMemoryUsageUpload));
+                recorder->copy(staging->getVkBuffer(), staging->getOffset(),
+                               buffer->getVkBuffer(), buffer->getOffset(), length);
+                uploadGeneration = recorder->getGeneration();
             }
-            buffer->unMap();
-            if (name == "mmap_fd")
-                msync(userptr, length, MS_SYNC);
+        }
+        else
+        {
+            buffer.reset(new Buffer(length, userptr, usage));
         }
     }
-    else
+    return buffer->getVkBuffer();
+}
+
+void VkMemoryInfo::waitForUpload()
+{
+    if (staging && recorder != nullptr && recorder->isPending(uploadGeneration))
     {
-        NOT_IMPLEMENTED;
+        recorder->flush();
     }
-
-    return true;
 }
 
-VkBuffer VkMemoryInfo::getVkBuffer()
+VkDeviceSize VkMemoryInfo::getOffset()
 {
-	if (!buffer)
-		buffer.reset(new Buffer(length, userptr)); 
-	return buffer->getVkBuffer();
+    getVkBuffer();
+    return buffer->getOffset() + offset;
 }
 
 void VkMemoryInfo::dump()
 {
     if (buffer)
     {
+        waitForUpload();
         buffer->dump();
     }
 }
@@ -83,6 +95,7 @@ void VkMemoryInfo::dumpToFile(const char* file_name, const int channels)
 {
     if (buffer)
     {
+        waitForUpload();
         buffer->dumpToFile(file_name, channels);
     }
 }
@@ -91,7 +104,8 @@ void VkMemoryInfo::resetForTune()
 {
     if (buffer)
     {
-        buffer->resetForTune();
+        waitForUpload();
+        buffer->resetForTune(offset, length);
     }
 }
 
@@ -99,7 +113,8 @@ void VkMemoryInfo::copyToBuffer(float* to_buf, const size_t buf_size)
 {
     if (buffer)
     {
-        buffer->copyToBuffer(to_buf, buf_size);
+        waitForUpload();
+        buffer->copyToBuffer(to_buf, buf_size, offset);
     }
 }
 
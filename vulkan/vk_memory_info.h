@@ -25,34 +25,49 @@
 
 NAME_SPACE_BEGIN
 
+class VkCommandRecorder;
+
 class VkMemoryInfo
 {
 public:
     //todo, device is not set
-    VkMemoryInfo(uint8_t* us, size_t le) :
-                userptr(us), length(le), inUsing(true), refCount(1), needSync(false)
+    VkMemoryInfo(uint8_t* us, size_t le, VkMemoryUsage usg = kMemoryUsageHost) :
+                userptr(us), length(le), offset(0), inUsing(true), refCount(1), needSync(false),
+                usage(usg), recorder(nullptr), uploadGeneration(0)
                 {}
     ~VkMemoryInfo() {}
-    bool sync(std::string name);
     void clean();
     void setNeedSync() { needSync = true; }
     void setNotInUsing();
     void incRef() { refCount++; }
     void resetRef() { refCount = 0;}
-    void shareFrom(VkMemoryInfo* from) { buffer = from->buffer; from->incRef();}
+    void shareFrom(VkMemoryInfo* from) { buffer = from->buffer; offset = from->offset; from->incRef();}
+    // bound in place at offset of an imported request pool
+    void importFrom(std::shared_ptr<Buffer> pool, size_t off) { buffer = pool; offset = off; }
     VkBuffer getVkBuffer();
+    // where the data starts in the VkBuffer of getVkBuffer
+    VkDeviceSize getOffset();
     void dump();
     void dumpToFile(const char* file_name, const int channels = 0);
     void resetForTune();
     void copyToBuffer(float* to_buf, const size_t buf_size);
+    // neither the host nor a separate submission may see the buffer before a recorded upload is executed
+    void waitForUpload();
 private:
     uint8_t* userptr;
     size_t length;
+    size_t offset;                  //in the buffer, non zero for the planned temporaries
     bool inUsing;
     uint32_t refCount;
     bool needSync;
+    VkMemoryUsage usage;
+    // the request inputs are uploaded in the command buffer of the request when it is recording
+    VkCommandRecorder* recorder;
+    uint32_t uploadGeneration;
     friend class VkMemoryManager;
+    friend class VkPoolInfo;
     std::shared_ptr<Buffer> buffer;
+    std::shared_ptr<Buffer> staging;
 };
 
 NAME_SPACE_STOP
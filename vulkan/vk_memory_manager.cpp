@@ -19,29 +19,37 @@
 #include <sys/mman.h>
 #include "vk_memory_manager.h"
 #include "vk_common.h"
+#include "host_copy.h"
 
 NAME_SPACE_BEGIN
 
-VkMemoryInfo* VkMemoryManager::createMemoryInfo(std::vector<VkMemoryInfo>& memInfos, uint8_t* userptr, size_t length) const
+VkMemoryInfo* VkMemoryManager::createMemoryInfo(std::vector<VkMemoryInfo>& memInfos, uint8_t* userptr, size_t length,
+                                                VkMemoryUsage usage) const
 {
     size_t count = memInfos.size();
 
     ASSERT(memInfos.capacity() > count);
 
-    VkMemoryInfo info(userptr, length);
+    VkMemoryInfo info(userptr, length, usage);
     memInfos.push_back(info);
 
     return &memInfos[count];
 }
 
-VkMemoryInfo* VkMemoryManager::createRequestMemoryInfo(uint8_t* userptr, size_t length)
+VkMemoryInfo* VkMemoryManager::createRequestMemoryInfo(uint8_t* userptr, size_t length, VkMemoryUsage usage)
 {
-    return createMemoryInfo(requestMemInfos, userptr, length);
+    VkMemoryInfo* info = createMemoryInfo(requestMemInfos, userptr, length, usage);
+    if (usage == kMemoryUsageDevice)
+    {
+        info->recorder = recorder;
+    }
+    return info;
 }
 
+// the constants are uploaded once, the shaders read them from device memory
 VkMemoryInfo* VkMemoryManager::createModelMemoryInfo(uint8_t* userptr, size_t length)
 {
-    return createMemoryInfo(modelMemInfos, userptr, length);
+    return createMemoryInfo(modelMemInfos, userptr, length, kMemoryUsageDevice);
 }
 
 VkMemoryInfo* VkMemoryManager::createIntermediumMemoryInfo(size_t length)
@@ -58,12 +66,54 @@ VkMemoryInfo* VkMemoryManager::createIntermediumMemoryInfo(size_t length)
         }
     }
 
-    return createMemoryInfo(intermediumMemInfos, nullptr, length);
+    return createMemoryInfo(intermediumMemInfos, nullptr, length, kMemoryUsageDevice);
 }
 
 VkMemoryInfo* VkMemoryManager::createIntermediumMemoryInfo(uint8_t* userptr, size_t length)
 {
-    return createMemoryInfo(intermediumMemInfos, userptr, length);
+    return createMemoryInfo(intermediumMemInfos, userptr, length, kMemoryUsageDevice);
+}
+
+VkMemoryInfo* VkMemoryManager::getPlannedMemoryInfo(uint32_t operandIndex, size_t length)
+{
+    if (operandIndex >= plannedMemInfos.size() ||
+        planner.getOffset(operandIndex) == MemoryPlanner::kNotPlanned ||
+        length > planner.getSize(operandIndex))
+    {
+        return nullptr;
+    }
+
+    VkMemoryInfo& info = plannedMemInfos[operandIndex];
+    info.inUsing = true;
+    info.refCount = 1;
+    return &info;
+}
+
+void VkMemoryManager::planIntermediums(const Model& model)
+{
+    if (!MemoryPlanner::isEnabled())
+    {
+        return;
+    }
+
+    planner.plan(model, kDeviceProps.limits.minStorageBufferOffsetAlignment);
+    if (planner.getArenaSize() == 0)
+    {
+        return;
+    }
+
+    arena = std::make_shared<Buffer>(planner.getArenaSize(), nullptr, kMemoryUsageDevice);
+    plannedMemInfos.reserve(model.operands.size());
+    for (size_t i = 0; i < model.operands.size(); i++)
+    {
+        VkMemoryInfo info(nullptr, planner.getSize(i), kMemoryUsageDevice);
+        if (planner.getOffset(i) != MemoryPlanner::kNotPlanned)
+        {
+            info.buffer = arena;
+            info.offset = planner.getOffset(i);
+        }
+        plannedMemInfos.push_back(info);
+    }
 }
 
 bool VkMemoryManager::initFromModel(const Model& model)
@@ -71,7 +121,7 @@ bool VkMemoryManager::initFromModel(const Model& model)
     modelPoolInfos.resize(model.pools.size());
     for (size_t i = 0; i < model.pools.size(); i++)
     {
-        if (!modelPoolInfos[i].set(model.pools[i]))
+        if (!modelPoolInfos[i].set(model.pools[i], poolCache))
         {
             LOGE("Could not map pool");
             return false;
@@ -81,7 +131,12 @@ bool VkMemoryManager::initFromModel(const Model& model)
     // just reserve size of big enough
     modelMemInfos.reserve(model.operands.size());
     requestMemInfos.reserve(model.operands.size());
-    intermediumMemInfos.reserve(model.operands.size());
+    // operations may own temporary operands too, e.g. the chn4 copies, the
+    // packed filter and the Winograd filter, tiles and products of CONV_2D, and a
+    // 3 channel CONV_2D tunes on two pairs of scratch buffers when the model is prepared
+    intermediumMemInfos.reserve(model.operands.size() + 8 * model.operations.size());
+
+    planIntermediums(model);
     return true;
 }
 
@@ -95,7 +150,7 @@ bool VkMemoryManager::resetFromRequest(const Request& request)
     requestPoolInfos.resize(request.pools.size());
     for (size_t i = 0; i < request.pools.size(); i++)
     {
-        if (!requestPoolInfos[i].set(request.pools[i]))
+        if (!requestPoolInfos[i].set(request.pools[i], poolCache))
         {
             LOGE("Could not map pool");
             return false;
@@ -106,6 +161,10 @@ bool VkMemoryManager::resetFromRequest(const Request& request)
     {
         mem.resetRef();
     }
+    for (auto& mem : plannedMemInfos)
+    {
+        mem.resetRef();
+    }
 
     return true;
 }
@@ -114,9 +173,40 @@ bool VkMemoryManager::sync()
 {
     // should we try for modelPoolInfos?
 
+    std::vector<VkMemoryInfo*> outputs;
+    for (size_t i = 0; i < requestPoolInfos.size(); i++)
+    {
+        requestPoolInfos[i].getSyncMemInfos(outputs);
+    }
+
+    // the blocks stay mapped, the outputs are copied straight out of the mappings
+    std::vector<HostCopy> copies;
+    for (auto mem : outputs)
+    {
+        if (!mem->buffer)
+        {
+            continue;
+        }
+        const uint8_t* data = mem->buffer->mapForRead(mem->offset, mem->length);
+        if (data == mem->userptr)
+        {
+            // written in place in the imported pool
+            continue;
+        }
+        else if (data != nullptr)
+        {
+            copies.push_back({mem->userptr, data, mem->length});
+        }
+        else
+        {
+            mem->buffer->read(mem->userptr, mem->offset, mem->length);
+        }
+    }
+    HostCopier::run(copies);
+
     for (size_t i = 0; i < requestPoolInfos.size(); i++)
     {
-        requestPoolInfos[i].sync();
+        requestPoolInfos[i].commit();
     }
     return true;
 }
@@ -133,11 +223,16 @@ void VkMemoryManager::clean()
 {
     cleanPoolInfos(modelPoolInfos);
     cleanPoolInfos(requestPoolInfos);
+    poolCache.clear();
 
     for (auto& mem : intermediumMemInfos)
     {
         mem.clean();
     }
+
+    plannedMemInfos.clear();
+    arena.reset();
+    planner.clear();
 }
 
 NAME_SPACE_STOP
\ No newline at end of file
@@ -22,19 +22,24 @@
 #include "base_executor.h"
 #include "vk_pool_info.h"
 #include "vk_memory_info.h"
+#include "memory_planner.h"
 
 NAME_SPACE_BEGIN
 
 class VkMemoryManager
 {
 public:
-    VkMemoryManager() {}
+    VkMemoryManager() : recorder(nullptr) {}
     ~VkMemoryManager() {}
 
     bool initFromModel(const Model& model);
     bool resetFromRequest(const Request& request);
     bool sync();
     void clean();
+    // drops the cached mapping of a pool the client freed
+    void invalidatePool(const hidl_memory& pool) { poolCache.invalidate(pool); }
+    // the request inputs are uploaded in its command buffer, nullptr when submitting per operation
+    void setRecorder(VkCommandRecorder* rec) { recorder = rec; }
 
     VkPoolInfo* getModelPoolInfo(size_t index)
     {
@@ -48,22 +53,37 @@ public:
         ASSERT(index < requestPoolInfos.size());
         return &requestPoolInfos[index];
     }
-    VkMemoryInfo* createRequestMemoryInfo(uint8_t* userptr, size_t length);
+    VkMemoryInfo* createRequestMemoryInfo(uint8_t* userptr, size_t length, VkMemoryUsage usage);
 
     VkMemoryInfo* createIntermediumMemoryInfo(size_t length);
     VkMemoryInfo* createIntermediumMemoryInfo(uint8_t* userptr, size_t length);
+    // the range of a temporary operand in the arena, nullptr if it is not planned
+    VkMemoryInfo* getPlannedMemoryInfo(uint32_t operandIndex, size_t length);
+    // the plan of the temporaries for the compilation cache, loadPlan is called before initFromModel
+    void savePlan(CacheWriter& writer) const { planner.save(writer); }
+    bool loadPlan(CacheReader& reader, const Model& model) { return planner.load(reader, model); }
 
 private:
     std::vector<VkPoolInfo> modelPoolInfos;
     std::vector<VkMemoryInfo> modelMemInfos;
 
     std::vector<VkPoolInfo> requestPoolInfos;
+    PoolMappingCache poolCache;
     std::vector<VkMemoryInfo> requestMemInfos;
 
     std::vector<VkMemoryInfo> intermediumMemInfos;
 
+    // the temporary operands of the model, placed in one buffer by the planner
+    MemoryPlanner planner;
+    std::shared_ptr<Buffer> arena;
+    std::vector<VkMemoryInfo> plannedMemInfos;
+
+    VkCommandRecorder* recorder;
+
+    void planIntermediums(const Model& model);
     void cleanPoolInfos(std::vector<VkPoolInfo>& poolInfos) const;
-    VkMemoryInfo* createMemoryInfo(std::vector<VkMemoryInfo>& memInfos, uint8_t* userptr, size_t length) const;
+    VkMemoryInfo* createMemoryInfo(std::vector<VkMemoryInfo>& memInfos, uint8_t* userptr, size_t length,
+                                   VkMemoryUsage usage) const;
 };
 
 NAME_SPACE_STOP
@@ -19,15 +19,17 @@
 #include "vk_common.h"
 #include "vk_wrapper.h"
 #include "vk_op_base.h"
+#include "vk_pipeline_cache.h"
 
 NAME_SPACE_BEGIN
 
-VkOpBase::VkOpBase(): group_x(0), group_y(0), group_z(0)
+VkOpBase::VkOpBase(VkCommandPool pool): group_x(0), group_y(0), group_z(0), shader_type(0), filter_index(-1)
 {
     NN_GPU_CALL();
     device = kDevice;
     pipeline = VK_NULL_HANDLE;
     cmd_buffer = VK_NULL_HANDLE;
+    cmd_pool = pool;
     descriptor_pool = VK_NULL_HANDLE;
     descriptor_set = VK_NULL_HANDLE;
     descriptor_set_layout = VK_NULL_HANDLE;
@@ -40,6 +42,10 @@ VkOpBase::~VkOpBase()
     NN_GPU_CALL();
     vkDestroyDescriptorPool(device, descriptor_pool, NULL);
     vkDestroyDescriptorSetLayout(device, descriptor_set_layout, NULL);
+    if (cmd_buffer != VK_NULL_HANDLE)
+    {
+        vkFreeCommandBuffers(device, cmd_pool, 1, &cmd_buffer);
+    }
     resetPipeline();
 }
 
@@ -64,22 +70,37 @@ void VkOpBase::resetPipeline()
     NN_GPU_EXIT();
 }
 
-void VkOpBase::initVulkanThing(int buffer_num)
+void VkOpBase::initVulkanThing(int buffer_num, int set_num)
 {
     NN_GPU_ENTRY();
-    createDescriptorSetLayout(buffer_num);
-    createDescriptorSet(buffer_num);
-    createCommandBuffer();
+    // the op object lives as long as the model, create the descriptors only once
+    if (descriptor_set_layout == VK_NULL_HANDLE)
+    {
+        createDescriptorSetLayout(buffer_num);
+        createDescriptorSet(buffer_num, set_num);
+    }
     NN_GPU_EXIT();
 }
 
 void VkOpBase::bindOperand(VkOperand& operand, int binding, VkDescriptorSet descriptor_set)
 {
     NN_GPU_ENTRY();
+    // the descriptor set must not be updated while a recorded dispatch still uses it
+    std::map<VkDescriptorSet, uint32_t>::iterator it = recorded_sets.find(descriptor_set);
+    if (recorder && it != recorded_sets.end() && recorder->isPending(it->second))
+    {
+        recorder->flush();
+    }
+
     VkDescriptorBufferInfo desc_buffer_info = {};
     desc_buffer_info.buffer = operand.getVkBuffer();
-    desc_buffer_info.offset = 0;
+    desc_buffer_info.offset = operand.getBufferOffset();
     desc_buffer_info.range = operand.size();
+    if (!recorder)
+    {
+        // submitted on its own, e.g. when tuning, after a pending upload of a request input
+        operand.waitForUpload();
+    }
 
     VkWriteDescriptorSet write_descriptor_set = {};
     write_descriptor_set.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
@@ -113,26 +134,30 @@ void VkOpBase::createDescriptorSetLayout(int buffer_num)
     NN_GPU_EXIT();
 }
 
-void VkOpBase::createDescriptorSet(int buffer_num)
+void VkOpBase::createDescriptorSet(int buffer_num, int set_num)
 {
     NN_GPU_ENTRY();
     VkDescriptorPoolSize pool_size = {};
     pool_size.type = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
-    pool_size.descriptorCount = buffer_num;
+    pool_size.descriptorCount = buffer_num * set_num;
 
     VkDescriptorPoolCreateInfo info = {};
     info.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
-    info.maxSets = 1;
+    info.maxSets = set_num;
     info.poolSizeCount = 1;
     info.pPoolSizes = &pool_size;
     VK_CHECK_RESULT(vkCreateDescriptorPool(device, &info, NULL, &descriptor_pool));
 
+    std::vector<VkDescriptorSetLayout> layouts(set_num, descriptor_set_layout);
+    descriptor_sets.resize(set_num);
+
     VkDescriptorSetAllocateInfo allocate_info = {};
     allocate_info.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
     allocate_info.descriptorPool = descriptor_pool;
-    allocate_info.descriptorSetCount = 1;
-    allocate_info.pSetLayouts = &descriptor_set_layout;
-    VK_CHECK_RESULT(vkAllocateDescriptorSets(device, &allocate_info, &descriptor_set));
+    allocate_info.descriptorSetCount = set_num;
+    allocate_info.pSetLayouts = layouts.data();
+    VK_CHECK_RESULT(vkAllocateDescriptorSets(device, &allocate_info, descriptor_sets.data()));
+    descriptor_set = descriptor_sets[0];
     NN_GPU_EXIT();
 }
 
@@ -181,9 +206,10 @@ void VkOpBase::createPipeline(size_t push_constants_size, VkSpecializationInfo*
     pipeline_create_info.sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO;
     pipeline_create_info.stage = stage_create_info;
     pipeline_create_info.layout = pipeline_layout;
-    VK_CHECK_RESULT(vkCreateComputePipelines(device, VK_NULL_HANDLE,
+    VK_CHECK_RESULT(vkCreateComputePipelines(device, VkPipelineCacheFile::get(),
                                              1, &pipeline_create_info,
                                              NULL, &pipeline));
+    VkPipelineCacheFile::notifyPipelineCreated();
     NN_GPU_EXIT();
 }
 
@@ -192,7 +218,7 @@ void VkOpBase::createCommandBuffer()
     NN_GPU_ENTRY();
     VkCommandBufferAllocateInfo info = {};
     info.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
-    info.commandPool = kCmdPool;
+    info.commandPool = cmd_pool;
     info.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
     info.commandBufferCount = 1;
     VK_CHECK_RESULT(vkAllocateCommandBuffers(device, &info, &cmd_buffer));
@@ -202,6 +228,21 @@ void VkOpBase::createCommandBuffer()
 void VkOpBase::recordCommandBuffer(void* push_constants, size_t push_constants_size)
 {
     NN_GPU_ENTRY();
+    if (recorder)
+    {
+        recorder->dispatch(pipeline, pipeline_layout, descriptor_set,
+                           push_constants, push_constants_size,
+                           group_x, group_y, group_z);
+        recorded_sets[descriptor_set] = recorder->getGeneration();
+        NN_GPU_EXIT();
+        return;
+    }
+
+    if (cmd_buffer == VK_NULL_HANDLE)
+    {
+        createCommandBuffer();
+    }
+
     VkCommandBufferBeginInfo beginInfo = {};
     beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
     beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
@@ -223,6 +264,13 @@ void VkOpBase::recordCommandBuffer(void* push_constants, size_t push_constants_s
 void VkOpBase::runCommandBuffer()
 {
     NN_GPU_ENTRY();
+    if (recorder)
+    {
+        // submitted together with the other operations of the request
+        NN_GPU_EXIT();
+        return;
+    }
+
     VkSubmitInfo submit_info = {};
     submit_info.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
     submit_info.commandBufferCount = 1;
@@ -235,6 +283,7 @@ void VkOpBase::runCommandBuffer()
 
     VK_CHECK_RESULT(vkCreateFence(device, &fence_create_info, NULL, &fence));
     {
+        std::lock_guard<std::mutex> lock(kQueueMutex);
         VK_CHECK_RESULT(vkQueueSubmit(kQueue, 1, &submit_info, fence));
     }
     VK_CHECK_RESULT(vkWaitForFences(device, 1, &fence, VK_TRUE, 100000000000));
@@ -301,10 +350,21 @@ void VkOpBase::setGroupSize(const int gx, const int gy, const int gz)
     group_z = gz;
 }
 
-void VkOpBase::rebindVkBuffer(VkOperand& operand, const int b, const int w, const int h, const int c)
+void VkOpBase::rebindVkBuffer(VkOperand& operand, const int b, const int w, const int h, const int c,
+                              const uint8_t* data)
 {
-    operand.reset(b, w, h, c);
+    operand.reset(b, w, h, c, data);
     return;
 }
 
+void VkOpBase::setRecorder(const std::shared_ptr<VkCommandRecorder>& r)
+{
+    recorder = r;
+    recorded_sets.clear();
+    for (auto& op : sub_ops)
+    {
+        op->setRecorder(r);
+    }
+}
+
 NAME_SPACE_STOP
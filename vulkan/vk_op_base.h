@@ -19,23 +19,25 @@
 #ifndef ANDROID_HARDWARE_NEURALNETWORKS_V1_2_VK_OP_BASE_H
 #define ANDROID_HARDWARE_NEURALNETWORKS_V1_2_VK_OP_BASE_H
 
+#include <map>
 #include "vk_common.h"
 #include "vk_operand.h"
+#include "vk_command_recorder.h"
 
 NAME_SPACE_BEGIN
 
 class VkOpBase
 {
 public:
-    VkOpBase();
+    VkOpBase(VkCommandPool pool);
     virtual ~VkOpBase();
 
 protected:
-    void initVulkanThing(int buffer_num);
+    void initVulkanThing(int buffer_num, int set_num = 1);
     void resetPipeline();
     void bindOperand(VkOperand& operand, int binding, VkDescriptorSet descriptor_set);
     void createDescriptorSetLayout(int buffer_num);
-    void createDescriptorSet(int buffer_num);
+    void createDescriptorSet(int buffer_num, int set_num = 1);
     void createShaderModule(const uint32_t* spv, size_t sz);
     void createPipeline(size_t push_constants_size = 0, VkSpecializationInfo* specialization_info = 0);
     void createCommandBuffer();
@@ -43,12 +45,16 @@ protected:
     void runCommandBuffer();
     bool computeGroupCountX(uint32_t totalThreadX, int preferLocalSizeX, int& localSizeX);
     void setGroupSize(const int gx, const int gy, const int gz);
-    void rebindVkBuffer(VkOperand& operand, const int b, const int w, const int h, const int c);
+    void rebindVkBuffer(VkOperand& operand, const int b, const int w, const int h, const int c,
+                        const uint8_t* data = nullptr);
+    void setRecorder(const std::shared_ptr<VkCommandRecorder>& r);
 
     VkPipeline pipeline;
     VkCommandBuffer cmd_buffer;
+    VkCommandPool cmd_pool;
     VkDescriptorPool descriptor_pool;
     VkDescriptorSet descriptor_set;
+    std::vector<VkDescriptorSet> descriptor_sets;
     VkDevice device;
     VkDescriptorSetLayout descriptor_set_layout;
     VkPipelineLayout pipeline_layout;
@@ -57,6 +63,19 @@ protected:
     int group_y;
     int group_z;
     std::string type;
+    // conv shader type chosen when the pipeline is created
+    int shader_type;
+    // helper dispatches and temporary operands owned by the operation,
+    // e.g. the chn3 to chn4 conversion of CONV_2D
+    std::vector<std::shared_ptr<VkOpBase>> sub_ops;
+    std::vector<VkOperand> tmp_operands;
+    // the filter CONV_2D runs on in tmp_operands, the chn4 or the packed one,
+    // -1 when it is the operand of the model
+    int filter_index;
+    // when set, dispatches go to the model command buffer instead of cmd_buffer
+    std::shared_ptr<VkCommandRecorder> recorder;
+    // recorder generation in which each descriptor set is last recorded
+    std::map<VkDescriptorSet, uint32_t> recorded_sets;
     friend class VkCsExecutor;
 
 private:
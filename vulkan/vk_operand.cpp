@@ -23,7 +23,8 @@
 
 NAME_SPACE_BEGIN
 
-void VkOperand::reset(const int batch, const int width, const int height, const int channel)
+void VkOperand::reset(const int batch, const int width, const int height, const int channel,
+                      const uint8_t* data)
 {
     dimensions[kShapeIdxBatch]   = batch;
     dimensions[kShapeIdxHeight]  = height;
@@ -31,15 +32,27 @@ void VkOperand::reset(const int batch, const int width, const int height, const
     dimensions[kShapeIdxChannel] = channel;
 
     length   = getElementCount() * getBasicTypeSize();
-    lifetime = OperandLifeTime::TEMPORARY_VARIABLE;
+    lifetime = data ? OperandLifeTime::CONSTANT_COPY : OperandLifeTime::TEMPORARY_VARIABLE;
     memInfo  = nullptr;
-    valPtr   = nullptr;
+    valPtr   = const_cast<uint8_t*>(data);
+    // not an operand of the model, it has no place in the arena
+    operandIndex = -1;
 
+    // the data is copied into the buffer here
     getVkBuffer();
 
     return;
 }
 
+void VkOperand::release()
+{
+    if (memInfo != nullptr)
+    {
+        memInfo->setNotInUsing();
+        memInfo = nullptr;
+    }
+}
+
 bool VkOperand::setArg(const RequestArgument& from)
 {
     NN_GPU_ENTRY();
@@ -80,9 +93,20 @@ bool VkOperand::setArg(const RequestArgument& from)
             *(reinterpret_cast<float *>(userptr)+6),
             *(reinterpret_cast<float *>(userptr)+7));
 
-        memInfo = memMgr.createRequestMemoryInfo(userptr, length);
+        // inputs live in device memory and are uploaded, outputs are written
+        // by the shaders into cached host memory which is cheap to read back
+        VkMemoryUsage usage = lifetime == OperandLifeTime::MODEL_OUTPUT ? kMemoryUsageReadback
+                                                                       : kMemoryUsageDevice;
+        memInfo = memMgr.createRequestMemoryInfo(userptr, length, usage);
         poolInfo->addMemInfo(memInfo);
 
+        // zero copy when the pool is imported and the operand is at a bindable offset
+        std::shared_ptr<Buffer> pool = poolInfo->getImportedBuffer();
+        if (pool && (pool->getOffset() + offset) % kDeviceProps.limits.minStorageBufferOffsetAlignment == 0)
+        {
+            memInfo->importFrom(pool, offset);
+        }
+
         // only output need sync?
         if (lifetime == OperandLifeTime::MODEL_OUTPUT)
         {
@@ -228,7 +252,11 @@ VkBuffer VkOperand::getVkBuffer()
     {
         if (lifetime == OperandLifeTime::TEMPORARY_VARIABLE)
         {
-            memInfo = memMgr.createIntermediumMemoryInfo(length);
+            memInfo = memMgr.getPlannedMemoryInfo(operandIndex, length);
+            if (memInfo == nullptr)
+            {
+                memInfo = memMgr.createIntermediumMemoryInfo(length);
+            }
         }
         else
         {
@@ -240,6 +268,20 @@ VkBuffer VkOperand::getVkBuffer()
     return memInfo->getVkBuffer();
 }
 
+VkDeviceSize VkOperand::getBufferOffset()
+{
+    getVkBuffer();
+    return memInfo->getOffset();
+}
+
+void VkOperand::waitForUpload()
+{
+    if (memInfo != nullptr)
+    {
+        memInfo->waitForUpload();
+    }
+}
+
 void VkOperand::dump()
 {
     memInfo->dump();
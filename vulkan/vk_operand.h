@@ -41,7 +41,11 @@ public:
     ~VkOperand() {}
 
     bool set(const Operand& from, uint8_t* vp, uint32_t index);
-    void reset(const int batch, const int width, const int height, const int channel);
+    // reshape to a temporary of its own, or to a constant holding data
+    void reset(const int batch, const int width, const int height, const int channel,
+               const uint8_t* data = nullptr);
+    // give the storage back to the memory manager, for scratch operands
+    void release();
     void resetForTune();
     void restore(const Operand& from);
     bool setArg(const RequestArgument& from);
@@ -79,6 +83,9 @@ public:
     }
 
     VkBuffer getVkBuffer();
+    // where the operand starts in the buffer of getVkBuffer
+    VkDeviceSize getBufferOffset();
+    void waitForUpload();
 
     void dump();
     void dumpToFile(const char* file_name = "img_data", const int channels = 0);
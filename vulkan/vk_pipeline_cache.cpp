@@ -0,0 +1,231 @@
+/*
+ * Copyright @2017 Intel Corporation
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library. If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <cutils/properties.h>
+#include "vk_common.h"
+#include "vk_wrapper.h"
+#include "vk_pipeline_cache.h"
+
+NAME_SPACE_BEGIN
+
+#define PIPELINE_CACHE_MAGIC 0x4b564e4e    // "NNVK"
+#define DEFAULT_PIPELINE_CACHE_PATH "/data/vk_pipeline_cache.bin"
+
+// the vulkan cache header does not carry the driver version, keep it in our own header
+struct PipelineCacheFileHeader
+{
+    uint32_t magic;
+    uint32_t vendorID;
+    uint32_t deviceID;
+    uint32_t driverVersion;
+    uint8_t  pipelineCacheUUID[VK_UUID_SIZE];
+    uint32_t dataSize;
+};
+
+// layout of VK_PIPELINE_CACHE_HEADER_VERSION_ONE
+struct VkPipelineCacheHeader
+{
+    uint32_t headerSize;
+    uint32_t headerVersion;
+    uint32_t vendorID;
+    uint32_t deviceID;
+    uint8_t  pipelineCacheUUID[VK_UUID_SIZE];
+};
+
+VkPipelineCache VkPipelineCacheFile::cache = VK_NULL_HANDLE;
+std::string VkPipelineCacheFile::path;
+std::mutex VkPipelineCacheFile::mtx;
+uint32_t VkPipelineCacheFile::newPipelines = 0;
+
+bool VkPipelineCacheFile::validate(const std::vector<uint8_t>& data)
+{
+    if (data.size() < sizeof(PipelineCacheFileHeader) + sizeof(VkPipelineCacheHeader))
+    {
+        return false;
+    }
+
+    const PipelineCacheFileHeader* file_header = reinterpret_cast<const PipelineCacheFileHeader*>(data.data());
+    if (file_header->magic != PIPELINE_CACHE_MAGIC ||
+        file_header->vendorID != kDeviceProps.vendorID ||
+        file_header->deviceID != kDeviceProps.deviceID ||
+        file_header->driverVersion != kDeviceProps.driverVersion ||
+        memcmp(file_header->pipelineCacheUUID, kDeviceProps.pipelineCacheUUID, VK_UUID_SIZE) != 0 ||
+        file_header->dataSize != data.size() - sizeof(PipelineCacheFileHeader))
+    {
+        return false;
+    }
+
+    const VkPipelineCacheHeader* vk_header =
+        reinterpret_cast<const VkPipelineCacheHeader*>(data.data() + sizeof(PipelineCacheFileHeader));
+    if (vk_header->headerSize < sizeof(VkPipelineCacheHeader) ||
+        vk_header->headerVersion != VK_PIPELINE_CACHE_HEADER_VERSION_ONE ||
+        vk_header->vendorID != kDeviceProps.vendorID ||
+        vk_header->deviceID != kDeviceProps.deviceID ||
+        memcmp(vk_header->pipelineCacheUUID, kDeviceProps.pipelineCacheUUID, VK_UUID_SIZE) != 0)
+    {
+        return false;
+    }
+
+    return true;
+}
+
+bool VkPipelineCacheFile::load(std::vector<uint8_t>& data)
+{
+    FILE* file_ptr = fopen(path.c_str(), "rb");
+    if (file_ptr == nullptr)
+    {
+        NN_GPU_DEBUG("pipeline cache file %s does not exist", path.c_str());
+        return false;
+    }
+
+    bool ret = false;
+    if (fseek(file_ptr, 0, SEEK_END) == 0)
+    {
+        long size = ftell(file_ptr);
+        if (size > 0 && fseek(file_ptr, 0, SEEK_SET) == 0)
+        {
+            data.resize(size);
+            ret = (fread(data.data(), 1, size, file_ptr) == (size_t)size);
+        }
+    }
+    fclose(file_ptr);
+
+    if (!ret || !validate(data))
+    {
+        LOGW("pipeline cache file %s is invalid or from another device/driver, ignore it", path.c_str());
+        data.clear();
+        return false;
+    }
+
+    return true;
+}
+
+bool VkPipelineCacheFile::init()
+{
+    NN_GPU_CALL();
+
+    char prop[PROPERTY_VALUE_MAX] = DEFAULT_PIPELINE_CACHE_PATH;
+    property_get("nn.gpgpu.vk_pipeline_cache", prop, DEFAULT_PIPELINE_CACHE_PATH);
+    path = prop;
+
+    std::vector<uint8_t> data;
+    bool loaded = load(data);
+
+    VkPipelineCacheCreateInfo info = {};
+    info.sType = VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO;
+    if (loaded)
+    {
+        info.initialDataSize = data.size() - sizeof(PipelineCacheFileHeader);
+        info.pInitialData = data.data() + sizeof(PipelineCacheFileHeader);
+    }
+
+    VkResult res = vkCreatePipelineCache(kDevice, &info, NULL, &cache);
+    if (res != VK_SUCCESS && loaded)
+    {
+        // the driver refused the data, start from an empty cache
+        info.initialDataSize = 0;
+        info.pInitialData = nullptr;
+        res = vkCreatePipelineCache(kDevice, &info, NULL, &cache);
+    }
+    if (res != VK_SUCCESS)
+    {
+        LOGE("failed to create pipeline cache, result = %d", res);
+        cache = VK_NULL_HANDLE;
+        return false;
+    }
+
+    newPipelines = 0;
+    NN_GPU_DEBUG("pipeline cache %s, %zu bytes loaded", path.c_str(), data.size());
+    return true;
+}
+
+void VkPipelineCacheFile::notifyPipelineCreated()
+{
+    std::lock_guard<std::mutex> lock(mtx);
+    ++newPipelines;
+}
+
+void VkPipelineCacheFile::store()
+{
+    NN_GPU_CALL();
+
+    std::lock_guard<std::mutex> lock(mtx);
+    if (cache == VK_NULL_HANDLE || newPipelines == 0)
+    {
+        return;
+    }
+
+    size_t size = 0;
+    if (vkGetPipelineCacheData(kDevice, cache, &size, nullptr) != VK_SUCCESS || size == 0)
+    {
+        return;
+    }
+
+    std::vector<uint8_t> data(sizeof(PipelineCacheFileHeader) + size);
+    if (vkGetPipelineCacheData(kDevice, cache, &size, data.data() + sizeof(PipelineCacheFileHeader)) != VK_SUCCESS)
+    {
+        return;
+    }
+    data.resize(sizeof(PipelineCacheFileHeader) + size);
+
+    PipelineCacheFileHeader* header = reinterpret_cast<PipelineCacheFileHeader*>(data.data());
+    header->magic = PIPELINE_CACHE_MAGIC;
+    header->vendorID = kDeviceProps.vendorID;
+    header->deviceID = kDeviceProps.deviceID;
+    header->driverVersion = kDeviceProps.driverVersion;
+    memcpy(header->pipelineCacheUUID, kDeviceProps.pipelineCacheUUID, VK_UUID_SIZE);
+    header->dataSize = size;
+
+    // write to a temporary file and rename, so other processes never read a partial file
+    std::string tmp = path + "." + std::to_string(getpid()) + ".tmp";
+    FILE* file_ptr = fopen(tmp.c_str(), "wb");
+    if (file_ptr == nullptr)
+    {
+        LOGW("failed to create pipeline cache file %s", tmp.c_str());
+        return;
+    }
+    bool ret = (fwrite(data.data(), 1, data.size(), file_ptr) == data.size());
+    ret = (fclose(file_ptr) == 0) && ret;
+
+    if (!ret || rename(tmp.c_str(), path.c_str()) != 0)
+    {
+        LOGW("failed to store pipeline cache file %s", path.c_str());
+        remove(tmp.c_str());
+        return;
+    }
+
+    newPipelines = 0;
+    NN_GPU_DEBUG("pipeline cache %s, %zu bytes stored", path.c_str(), data.size());
+}
+
+void VkPipelineCacheFile::deinit()
+{
+    NN_GPU_CALL();
+
+    store();
+    if (cache != VK_NULL_HANDLE)
+    {
+        vkDestroyPipelineCache(kDevice, cache, NULL);
+        cache = VK_NULL_HANDLE;
+    }
+}
+
+NAME_SPACE_STOP
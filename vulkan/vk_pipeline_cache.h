@@ -0,0 +1,52 @@
+/*
+ * Copyright @2017 Intel Corporation
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library. If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef ANDROID_HARDWARE_NEURALNETWORKS_V1_2_VK_PIPELINE_CACHE_H
+#define ANDROID_HARDWARE_NEURALNETWORKS_V1_2_VK_PIPELINE_CACHE_H
+
+#include <mutex>
+#include "vk_common.h"
+
+NAME_SPACE_BEGIN
+
+// Process wide VkPipelineCache backed by a file (nn.gpgpu.vk_pipeline_cache),
+// so the pipelines compiled by an earlier run of the service are reused.
+// The file is only accepted when it was written on the same device and driver.
+class VkPipelineCacheFile
+{
+public:
+    static bool init();
+    static void deinit();
+    // write the cache to the file if pipelines were created since the last store
+    static void store();
+    static void notifyPipelineCreated();
+    static VkPipelineCache get() { return cache; }
+
+private:
+    static bool load(std::vector<uint8_t>& data);
+    static bool validate(const std::vector<uint8_t>& data);
+
+    static VkPipelineCache cache;
+    static std::string path;
+    static std::mutex mtx;
+    static uint32_t newPipelines;
+};
+
+NAME_SPACE_STOP
+
+#endif
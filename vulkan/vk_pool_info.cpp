@@ -25,11 +25,6 @@ NAME_SPACE_BEGIN
 bool VkPoolInfo::clean()
 {
     ASSERT(userptr != nullptr);
-    if (name == "mmap_fd")
-    {
-        munmap(userptr, size);
-    }
-    userptr = nullptr;
 
     for (auto& mem : memInfos)
     {
@@ -37,76 +32,90 @@ bool VkPoolInfo::clean()
     }
     memInfos.clear();
 
+    // unmapped here unless the cache keeps it for the next request
+    mapping.reset();
+    userptr = nullptr;
+
     return true;
 }
 
-bool VkPoolInfo::sync()
+std::shared_ptr<Buffer> VkPoolInfo::getImportedBuffer()
 {
-    if (name == "mmap_fd")
+    // imported once per mapping, the buffer lives as long as the mapping is cached
+    if (!mapping->gpuObjectTried && kExternalMemoryHost)
     {
-        int prot = hidlMemory.handle()->data[1];
-        if (prot & PROT_WRITE)
-        {
-            for (auto& mem : memInfos)
-            {
-                mem->sync(name);
-            }
-        }
+        mapping->gpuObjectTried = true;
+        mapping->gpuObject.reset(Buffer::import(userptr, size));
+        NN_GPU_DEBUG("request pool of %zu bytes is %s", size, mapping->gpuObject ? "imported" : "copied");
     }
-    else if (name == "ashmem")
+    return std::static_pointer_cast<Buffer>(mapping->gpuObject);
+}
+
+void VkPoolInfo::getSyncMemInfos(std::vector<VkMemoryInfo*>& outputs) const
+{
+    if (name == "mmap_fd")
     {
-        for (auto& mem : memInfos)
+        int prot = hidlMemory.handle()->data[1];
+        if (!(prot & PROT_WRITE))
         {
-            mem->sync(name);
+            return;
         }
-        memory->commit();
     }
-    else
+    else if (name != "ashmem")
     {
         NOT_IMPLEMENTED;
+        return;
     }
 
-    return true;
+    for (auto& mem : memInfos)
+    {
+        if (mem->needSync)
+        {
+            outputs.push_back(mem);
+        }
+    }
 }
 
-bool VkPoolInfo::set(const hidl_memory& hidlMemory)
+bool VkPoolInfo::commit()
 {
-    this->hidlMemory = hidlMemory;
-    name = hidlMemory.name();
     if (name == "mmap_fd")
     {
-        size = hidlMemory.size();
-        int fd = hidlMemory.handle()->data[0];
         int prot = hidlMemory.handle()->data[1];
-        size_t offset = getSizeFromInts(hidlMemory.handle()->data[2],
-                                        hidlMemory.handle()->data[3]);
-        userptr = static_cast<uint8_t*>(mmap(nullptr, size, prot, MAP_SHARED, fd, offset));
-        if (userptr == MAP_FAILED)
+        if (prot & PROT_WRITE)
         {
-            LOGE("Can't mmap the file descriptor.");
-            return false;
+            // once for the whole pool instead of once per output
+            msync(userptr, size, MS_SYNC);
         }
-        return true;
     }
     else if (name == "ashmem")
     {
-        memory = mapMemory(hidlMemory);
-        if (memory == nullptr) {
-            LOGE("Can't map shared memory.");
-            return false;
-        }
-        memory->update();
-        userptr = reinterpret_cast<uint8_t*>(static_cast<void*>(memory->getPointer()));
-        if (userptr == nullptr) {
-            LOGE("Can't access shared memory.");
-            return false;
-        }
-        return true;
+        mapping->memory->commit();
     }
     else
     {
         NOT_IMPLEMENTED;
     }
+
+    return true;
+}
+
+bool VkPoolInfo::set(const hidl_memory& hidlMemory, PoolMappingCache& cache)
+{
+    this->hidlMemory = hidlMemory;
+    name = hidlMemory.name();
+    mapping = cache.get(hidlMemory);
+    if (mapping == nullptr)
+    {
+        return false;
+    }
+    userptr = mapping->userptr;
+    size = mapping->size;
+    if (mapping->gpuObject)
+    {
+        // imported by a previous request, the host has written new inputs since
+        std::static_pointer_cast<Buffer>(mapping->gpuObject)->flush();
+    }
+    return true;
 }
 
 NAME_SPACE_STOP
@@ -20,6 +20,7 @@
 #define ANDROID_HARDWARE_NEURALNETWORKS_V1_2_VK_POOL_INFO_H
 
 #include "base_executor.h"
+#include "pool_mapping_cache.h"
 #include "vk_memory_info.h"
 
 NAME_SPACE_BEGIN
@@ -30,14 +31,18 @@ class VkPoolInfo {
 public:
     VkPoolInfo() : userptr(nullptr), size(0) {}
     ~VkPoolInfo() {}
-    bool set(const hidl_memory& hidlMemory);
-    bool sync();
+    bool set(const hidl_memory& hidlMemory, PoolMappingCache& cache);
+    // the outputs to copy back into the pool, commit after they are copied
+    void getSyncMemInfos(std::vector<VkMemoryInfo*>& outputs) const;
+    bool commit();
     bool clean();
     void addMemInfo(VkMemoryInfo* memInfo) { memInfos.push_back(memInfo); }
     uint8_t* getUserptr() { return userptr; }
+    // the whole pool imported as device memory, nullptr when the operands are copied
+    std::shared_ptr<Buffer> getImportedBuffer();
 
 private:
-    sp<IMemory> memory;
+    std::shared_ptr<PoolMapping> mapping;
     hidl_memory hidlMemory;
     std::string name;
     uint8_t* userptr;
@@ -0,0 +1,209 @@
+/*
+ * Copyright @2017 Intel Corporation
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library. If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <sstream>
+#include <cutils/properties.h>
+#include "vk_tuning_db.h"
+
+NAME_SPACE_BEGIN
+
+#define TUNING_DB_MAGIC "nn_gpgpu_vk_tuning_db"
+#define TUNING_DB_VERSION 2
+#define DEFAULT_TUNING_DB_PATH "/data/vk_tuning_db.txt"
+
+// one line an entry: device, signature, config and time separated by tabs
+#define TUNING_DB_SEPARATOR '\t'
+
+VkTuningDb::EntryMap VkTuningDb::entries;
+std::string VkTuningDb::path;
+bool VkTuningDb::loaded = false;
+std::mutex VkTuningDb::mtx;
+
+std::string VkTuningDb::deviceKey(const std::string& signature)
+{
+    std::stringstream ss;
+    ss << kDeviceProps.deviceName << "_driver" << kDeviceProps.driverVersion
+       << TUNING_DB_SEPARATOR << signature;
+    return ss.str();
+}
+
+void VkTuningDb::merge(EntryMap& map, const std::string& key, const Entry& entry)
+{
+    auto it = map.find(key);
+    if (it == map.end() || entry.time_us < it->second.time_us)
+    {
+        map[key] = entry;
+    }
+}
+
+bool VkTuningDb::read(EntryMap& map)
+{
+    FILE* file_ptr = fopen(path.c_str(), "r");
+    if (file_ptr == nullptr)
+    {
+        NN_GPU_DEBUG("tuning db file %s does not exist", path.c_str());
+        return false;
+    }
+
+    std::string content;
+    char buf[4096];
+    size_t n;
+    while ((n = fread(buf, 1, sizeof(buf), file_ptr)) > 0)
+    {
+        content.append(buf, n);
+    }
+    fclose(file_ptr);
+
+    std::istringstream in(content);
+    std::string line;
+    std::stringstream header;
+    header << TUNING_DB_MAGIC << " " << TUNING_DB_VERSION;
+    if (!std::getline(in, line) || line != header.str())
+    {
+        LOGW("tuning db file %s is invalid or of another version, ignore it", path.c_str());
+        return false;
+    }
+
+    while (std::getline(in, line))
+    {
+        // device, signature, config, time
+        size_t p0 = line.find(TUNING_DB_SEPARATOR);
+        size_t p1 = p0 == std::string::npos ? p0 : line.find(TUNING_DB_SEPARATOR, p0 + 1);
+        size_t p2 = p1 == std::string::npos ? p1 : line.find(TUNING_DB_SEPARATOR, p1 + 1);
+        if (p2 == std::string::npos)
+        {
+            // e.g. the last line of a file written by a process that crashed
+            continue;
+        }
+        Entry entry;
+        entry.config = line.substr(p1 + 1, p2 - p1 - 1);
+        entry.time_us = strtol(line.c_str() + p2 + 1, nullptr, 10);
+        merge(map, line.substr(0, p1), entry);
+    }
+    return true;
+}
+
+bool VkTuningDb::write(const EntryMap& map)
+{
+    // write to a temporary file and rename, so other processes never read a partial file
+    std::string tmp = path + "." + std::to_string(getpid()) + ".tmp";
+    FILE* file_ptr = fopen(tmp.c_str(), "w");
+    if (file_ptr == nullptr)
+    {
+        LOGW("failed to create tuning db file %s", tmp.c_str());
+        return false;
+    }
+
+    bool ret = fprintf(file_ptr, "%s %d\n", TUNING_DB_MAGIC, TUNING_DB_VERSION) > 0;
+    for (auto& it : map)
+    {
+        ret = ret && fprintf(file_ptr, "%s%c%s%c%ld\n", it.first.c_str(), TUNING_DB_SEPARATOR,
+                             it.second.config.c_str(), TUNING_DB_SEPARATOR, it.second.time_us) > 0;
+    }
+    ret = (fclose(file_ptr) == 0) && ret;
+
+    if (!ret || rename(tmp.c_str(), path.c_str()) != 0)
+    {
+        LOGW("failed to store tuning db file %s", path.c_str());
+        remove(tmp.c_str());
+        return false;
+    }
+    return true;
+}
+
+// the file is only read when a signature misses the compiled in configs
+void VkTuningDb::load()
+{
+    if (loaded)
+    {
+        return;
+    }
+
+    char prop[PROPERTY_VALUE_MAX] = DEFAULT_TUNING_DB_PATH;
+    property_get("nn.gpgpu.vk_tuning_db", prop, DEFAULT_TUNING_DB_PATH);
+    path = prop;
+
+    read(entries);
+    loaded = true;
+    NN_GPU_DEBUG("tuning db %s, %zu entries loaded", path.c_str(), entries.size());
+}
+
+bool VkTuningDb::find(const std::string& signature, std::string& config)
+{
+    std::lock_guard<std::mutex> lock(mtx);
+    load();
+
+    auto it = entries.find(deviceKey(signature));
+    if (it == entries.end())
+    {
+        return false;
+    }
+    config = it->second.config;
+    NN_GPU_PERF("CONV_2D: %s: %s, %s, tuned %ld us\n", __func__, signature.c_str(), config.c_str(), it->second.time_us);
+    return true;
+}
+
+void VkTuningDb::update(const std::string& signature, const std::string& config, long time_us)
+{
+    std::lock_guard<std::mutex> lock(mtx);
+    load();
+
+    EntryMap stored;
+    read(stored);
+    for (auto& it : stored)
+    {
+        merge(entries, it.first, it.second);
+    }
+
+    Entry entry;
+    entry.config = config;
+    entry.time_us = time_us;
+    merge(entries, deviceKey(signature), entry);
+
+    if (write(entries))
+    {
+        NN_GPU_PERF("CONV_2D: %s: %s, %s, %ld us\n", __func__, signature.c_str(), config.c_str(), time_us);
+    }
+}
+
+void VkTuningDb::remove(const std::string& signature)
+{
+    std::lock_guard<std::mutex> lock(mtx);
+    load();
+
+    // also drop it from the file, update would otherwise merge it back
+    // whenever its time is shorter than the one of the config tuned again
+    const std::string key = deviceKey(signature);
+    EntryMap stored;
+    read(stored);
+    for (auto& it : stored)
+    {
+        merge(entries, it.first, it.second);
+    }
+    entries.erase(key);
+
+    if (write(entries))
+    {
+        NN_GPU_PERF("CONV_2D: %s: %s\n", __func__, signature.c_str());
+    }
+}
+
+NAME_SPACE_STOP
@@ -0,0 +1,66 @@
+/*
+ * Copyright @2017 Intel Corporation
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library. If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef ANDROID_HARDWARE_NEURALNETWORKS_V1_2_VK_TUNING_DB_H
+#define ANDROID_HARDWARE_NEURALNETWORKS_V1_2_VK_TUNING_DB_H
+
+#include <map>
+#include <mutex>
+#include <string>
+#include "vk_common.h"
+
+NAME_SPACE_BEGIN
+
+// Process wide store of the tuned conv configs backed by a text file
+// (nn.gpgpu.vk_tuning_db), so a shape tuned by an earlier run of the service is
+// not tuned again. Entries are keyed by the conv signature, the device name and
+// the driver version, and keep the time measured when they were tuned.
+class VkTuningDb
+{
+public:
+    // the config tuned for the signature on this device and driver
+    static bool find(const std::string& signature, std::string& config);
+    // the entry is only replaced by a faster config, the file is rewritten
+    // with the entries other processes stored since it was loaded
+    static void update(const std::string& signature, const std::string& config, long time_us);
+    // drops an entry the backend cannot run, so the signature is tuned again
+    static void remove(const std::string& signature);
+
+private:
+    struct Entry
+    {
+        std::string config;
+        long time_us;
+    };
+    using EntryMap = std::map<std::string, Entry>;
+
+    static std::string deviceKey(const std::string& signature);
+    static void load();
+    static bool read(EntryMap& map);
+    static bool write(const EntryMap& map);
+    static void merge(EntryMap& map, const std::string& key, const Entry& entry);
+
+    static EntryMap entries;
+    static std::string path;
+    static bool loaded;
+    static std::mutex mtx;
+};
+
+NAME_SPACE_STOP
+
+#endif